@@ -0,0 +1,32 @@
+/** @file    check.h
+ *  @time    2026/10/23 ~ 上午10:00
+ *  @author  Leon
+ *
+ *  @note    test::check and the count of failed checks a test's main returns
+ *
+ */
+
+#pragma once
+
+#include <fmt/core.h>
+#include <string>
+
+namespace test {
+
+inline int failures{0};
+
+// printed with each failure, e.g. the variant being tested; empty for none
+inline std::string context{};
+
+inline void check(bool ok, const char* what) {
+  if (!ok) {
+    ++failures;
+    if (context.empty()) {
+      fmt::print("FAILED: {}\n", what);
+    } else {
+      fmt::print("FAILED [{}]: {}\n", context, what);
+    }
+  }
+}
+
+}  // namespace test
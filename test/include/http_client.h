@@ -0,0 +1,135 @@
+/** @file    http_client.h
+ *  @time    2026/10/18 ~ 下午11:10
+ *  @author  Leon
+ *
+ *  @note    A tiny blocking HTTP/1.1 client over loopback, for the webserver tests
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstdlib>
+#include <strings.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace test {
+
+struct http_response {
+  int status{0};
+  std::string head{};  // status line + headers
+  std::string body{};
+
+  // value of header `name` (case-insensitive), or empty
+  [[nodiscard]] std::string header(std::string_view name) const {
+    std::size_t pos = head.find("\r\n");
+    while (pos != std::string::npos && pos + 2 < head.size()) {
+      auto start = pos + 2;
+      auto end = head.find("\r\n", start);
+      auto line = std::string_view{head}.substr(start, end - start);
+      auto colon = line.find(':');
+      if (colon == name.size() && ::strncasecmp(line.data(), name.data(), name.size()) == 0) {
+        auto value = line.substr(colon + 1);
+        while (!value.empty() && value.front() == ' ') {
+          value.remove_prefix(1);
+        }
+        return std::string{value};
+      }
+      pos = end;
+    }
+    return {};
+  }
+};
+
+class http_client {
+ private:
+  int fd{-1};
+  std::string buffer{};
+
+ public:
+  explicit http_client(std::uint16_t port) {
+    fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      ::close(fd);
+      fd = -1;
+    }
+    int one{1};
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+
+  ~http_client() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+
+  http_client(const http_client&) = delete;
+  http_client& operator=(const http_client&) = delete;
+
+  [[nodiscard]] bool connected() const { return fd >= 0; }
+  [[nodiscard]] int get_fd() const { return fd; }
+
+  bool send_all(std::string_view data) {
+    while (!data.empty()) {
+      auto n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+      if (n <= 0) {
+        return false;
+      }
+      data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+  }
+
+  /*!
+   * Read one response; `with_body` is false for replies to HEAD (Content-Length without a body)
+   * @return false on EOF or error before a full response
+   */
+  bool read_response(http_response& resp, bool with_body = true) {
+    std::size_t end;
+    while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+      if (!fill()) {
+        return false;
+      }
+    }
+    resp.head = buffer.substr(0, end + 2);
+    resp.status = resp.head.size() > 12 ? std::atoi(resp.head.c_str() + 9) : 0;
+    std::size_t length = with_body && resp.status != 304 ? std::strtoul(resp.header("Content-Length").c_str(), nullptr, 10) : 0;
+    while (buffer.size() < end + 4 + length) {
+      if (!fill()) {
+        return false;
+      }
+    }
+    resp.body = buffer.substr(end + 4, length);
+    buffer.erase(0, end + 4 + length);
+    return true;
+  }
+
+  // true if the server closed the connection (after what is buffered)
+  bool closed_by_peer() {
+    char c;
+    return buffer.empty() && ::recv(fd, &c, 1, 0) == 0;
+  }
+
+ private:
+  bool fill() {
+    char chunk[16 * 1024];
+    auto n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) {
+      return false;
+    }
+    buffer.append(chunk, static_cast<std::size_t>(n));
+    return true;
+  }
+};
+
+}  // namespace test
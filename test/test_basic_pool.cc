@@ -0,0 +1,83 @@
+/** @file    test_basic_pool.cc
+ *  @time    2026/10/18 ~ 下午3:10
+ *  @author  Leon
+ *
+ *  @note    The same workload on different policy combinations of tp::basic_pool
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <threadpool/basic_pool.h>
+#include <threadpool/dynamic_pool.h>
+#include <threadpool/steady_pool.h>
+#include <threadpool/atomic_spin_lock.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <vector>
+#include <future>
+#include <complex>
+#include <numeric>
+
+namespace test {
+
+constexpr std::size_t TEST_TASK_NUM = 200000;
+
+float do_math(float a, float b) {
+  return std::cos(std::sin(a)) + std::sin(std::cos(b));
+}
+
+// the hooks of no_stats compile away, so the default pools pay nothing for them
+static_assert(sizeof(tp::basic_pool<tp::shared_queue, std::mutex, tp::sleep_idle, tp::no_stats>) <
+              sizeof(tp::basic_pool<tp::shared_queue, std::mutex, tp::sleep_idle, tp::counting_stats>));
+
+template <typename Pool>
+void run_workload(Pool& pool) {
+  std::vector<std::future<float>> futures;
+  futures.reserve(TEST_TASK_NUM);
+  for (std::size_t i = 0; i < TEST_TASK_NUM; ++i) {
+    futures.emplace_back(pool.submit_task(do_math, 3.14F, 2.71F));
+  }
+  pool.wait_for_tasks();
+}
+
+template <typename Pool>
+void bench(const char* name) {
+  Pool pool{4};
+  auto start = std::chrono::steady_clock::now();
+  run_workload(pool);
+  auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("{:<40} {:>9.2f}ms\n", name, ms);
+}
+
+void test_policy_combinations() {
+  bench<tp::DynamicThreadPool>("shared_queue + mutex + sleep (Dynamic)");
+  bench<tp::SteadyThreadPool>("double_queue + spinlock + spin (Steady)");
+  bench<tp::basic_pool<tp::shared_queue, tp::atomic_spinlock, tp::spin_idle, tp::no_stats>>(
+      "shared_queue + spinlock + spin");
+  bench<tp::basic_pool<tp::double_queue, std::mutex, tp::sleep_idle, tp::no_stats>>("double_queue + mutex + sleep");
+}
+
+void test_counting_stats() {
+  tp::basic_pool<tp::double_queue, tp::atomic_spinlock, tp::spin_idle, tp::counting_stats> pool{4};
+  run_workload(pool);
+
+  auto snapshot = pool.stats_policy().get_snapshot();
+  auto executed = std::accumulate(snapshot.executed.begin(), snapshot.executed.end(), std::uint64_t{0});
+  fmt::print("submitted {}, executed {}\n", snapshot.submitted, executed);
+  for (std::size_t i = 0; i < snapshot.executed.size(); ++i) {
+    fmt::print("worker {}: executed {:>7}, idle rounds {}\n", i, snapshot.executed[i], snapshot.idle[i]);
+  }
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_policy_combinations);
+  test::test_policy_combinations();
+
+  DividingLine(test_counting_stats);
+  test::test_counting_stats();
+}
@@ -0,0 +1,165 @@
+/** @file    test_buffer_pool.cc
+ *  @time    2026/10/19 ~ 下午4:20
+ *  @author  Leon
+ *
+ *  @note    ws::buffer_pool / ws::buffer_cache / ws::arena, and that idle keep-alive connections hold no buffers;
+ *           arena vs heap for per-request header lists
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/arena.h>
+#include <webserver/buffer_pool.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+namespace test {
+
+void test_pool() {
+  check(ws::buffer_pool::class_of(1) == 0 && ws::buffer_pool::class_of(4096) == 0, "class 0");
+  check(ws::buffer_pool::class_of(4097) == 1 && ws::buffer_pool::class_size(1) == 16 * 1024, "class 1");
+  check(ws::buffer_pool::class_of(1024 * 1024) == 4, "largest class");
+  check(ws::buffer_pool::class_of(1024 * 1024 + 1) == ws::buffer_pool::NUM_CLASSES, "oversize");
+
+  ws::buffer_pool pool{};
+  {
+    ws::buffer_cache cache{pool};
+    auto a = cache.acquire(100);
+    check(a && a.capacity == 4096, "acquire rounds up to the class");
+    check(cache.get_bytes_in_use() == 4096, "bytes in use");
+    auto big = cache.acquire(3 * 1024 * 1024);
+    check(big.capacity == 3 * 1024 * 1024, "oversize from the heap");
+    cache.release(big);
+    cache.release(a);
+    check(!a && cache.get_bytes_in_use() == 0, "release empties the buffer");
+
+    // more releases than the local list keeps: the excess goes back to the pool in batches
+    std::vector<ws::pooled_buffer> held;
+    for (int i = 0; i < 100; ++i) {
+      held.push_back(cache.acquire(16 * 1024));
+    }
+    for (auto& b : held) {
+      cache.release(b);
+    }
+    check(pool.get_num_free(1) > 0, "overflow returned to the pool");
+  }
+  check(pool.get_num_free(0) > 0, "cache returns its buffers on destruction");
+}
+
+void test_arena() {
+  ws::buffer_pool pool{};
+  ws::buffer_cache cache{pool};
+  {
+    ws::arena mem{cache};
+    auto* a = mem.allocate(10, 1);
+    auto* b = mem.allocate(64, 64);
+    check(reinterpret_cast<std::uintptr_t>(b) % 64 == 0, "alignment");
+    check(static_cast<char*>(b) >= static_cast<char*>(a) + 10, "no overlap");
+    check(mem.get_allocated() == 4096, "one block");
+    [[maybe_unused]] auto* c = mem.allocate(10000, 8);  // larger than a block
+    check(mem.get_allocated() > 4096, "second block");
+    mem.reset();
+    check(mem.get_allocated() == 0 && cache.get_bytes_in_use() == 0, "reset returns every block");
+
+    std::pmr::vector<ws::header> headers{&mem};
+    for (int i = 0; i < 200; ++i) {
+      headers.push_back({"name", "value"});
+    }
+    check(headers.size() == 200 && headers[199].value == "value", "pmr vector on the arena");
+    headers = std::pmr::vector<ws::header>{&mem};
+    mem.reset();
+  }
+  check(cache.get_bytes_in_use() == 0, "arena destroyed");
+}
+
+void hello(const ws::request& req, ws::response& resp) {
+  resp.body = req.path == "/big" ? std::string(100 * 1024, 'x') : "hello";
+}
+
+void test_idle_connections() {
+  ws::server srv{{"127.0.0.1", 0, 2}, hello};
+  srv.start();
+  std::vector<std::unique_ptr<http_client>> clients;
+  for (int i = 0; i < 50; ++i) {
+    clients.push_back(std::make_unique<http_client>(srv.get_port()));
+  }
+  bool ok{true};
+  for (int round = 0; round < 3; ++round) {
+    for (auto& c : clients) {
+      http_response resp;
+      ok = ok && c->send_all(round == 1 ? "GET /big HTTP/1.1\r\nHost: x\r\n\r\n" : "GET / HTTP/1.1\r\nHost: x\r\n\r\n");
+      ok = ok && c->read_response(resp) && resp.status == 200;
+      ok = ok && resp.body.size() == (round == 1 ? 100 * 1024 : 5);
+    }
+  }
+  check(ok, "keep-alive responses");
+  check(srv.get_num_connections() == 50, "connections open");
+  // the last response has been read, but the reactor may still be finishing its flush
+  for (int i = 0; i < 100 && srv.get_buffer_bytes_in_use() != 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  check(srv.get_buffer_bytes_in_use() == 0, "idle keep-alive connections hold no buffers");
+  fmt::print("50 idle connections, {} buffer bytes in use\n", srv.get_buffer_bytes_in_use());
+  srv.stop();
+}
+
+void bench_headers() {
+  constexpr int ROUNDS = 200000;
+  constexpr int HEADERS = 12;
+  std::size_t sink{0};  // keeps the lists from being optimized away
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; ++i) {
+    std::vector<ws::header> headers;
+    for (int h = 0; h < HEADERS; ++h) {
+      headers.push_back({"name", "value"});
+    }
+    sink += headers.size() + headers.back().name.size();
+  }
+  auto heap = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+
+  ws::buffer_pool pool{};
+  ws::buffer_cache cache{pool};
+  ws::arena mem{cache};
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; ++i) {
+    {
+      std::pmr::vector<ws::header> headers{&mem};
+      for (int h = 0; h < HEADERS; ++h) {
+        headers.push_back({"name", "value"});
+      }
+      sink += headers.size() + headers.back().name.size();
+    }
+    mem.reset();
+  }
+  auto arena = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+  fmt::print("{} headers per request -> std::vector: {:>6.1f} ns, arena + reset: {:>6.1f} ns ({})\n", HEADERS, heap, arena,
+             sink);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_pool);
+  test::test_pool();
+
+  DividingLine(test_arena);
+  test::test_arena();
+
+  DividingLine(test_idle_connections);
+  test::test_idle_connections();
+
+  DividingLine(bench_headers);
+  test::bench_headers();
+  return test::failures;
+}
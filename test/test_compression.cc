@@ -0,0 +1,323 @@
+/** @file    test_compression.cc
+ *  @time    2026/10/20 ~ 上午11:30
+ *  @author  Leon
+ *
+ *  @note    Content coding: negotiation, gzip / brotli round trips, encoded copies of static files and cached responses,
+ *           dynamic bodies encoded on the workers (pipelined, HEAD, close, io_uring); bytes and throughput with it on
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/static_files.h>
+#include <webserver/response_cache.h>
+#include <webserver/compression.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <system_error>
+#include <unistd.h>
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WITH_BROTLI
+#include <brotli/decode.h>
+#endif
+
+namespace test {
+
+using namespace std::chrono_literals;
+namespace fs = std::filesystem;
+
+// the body decoded per its Content-Encoding; "<corrupt>" if it does not decode
+std::string decode(const http_response& resp) {
+  auto coding = resp.header("Content-Encoding");
+  std::string out{};
+  if (coding.empty()) {
+    return resp.body;
+  }
+#ifdef WITH_ZLIB
+  if (coding == "gzip") {
+    z_stream zs{};
+    ::inflateInit2(&zs, 15 + 16);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(resp.body.data()));
+    zs.avail_in = static_cast<uInt>(resp.body.size());
+    int status;
+    do {
+      char chunk[16 * 1024];
+      zs.next_out = reinterpret_cast<Bytef*>(chunk);
+      zs.avail_out = sizeof(chunk);
+      status = ::inflate(&zs, Z_NO_FLUSH);
+      out.append(chunk, sizeof(chunk) - zs.avail_out);
+    } while (status == Z_OK);
+    ::inflateEnd(&zs);
+    return status == Z_STREAM_END ? out : "<corrupt>";
+  }
+#endif
+#ifdef WITH_BROTLI
+  if (coding == "br") {
+    auto* state = ::BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+    auto avail_in = resp.body.size();
+    const auto* next_in = reinterpret_cast<const std::uint8_t*>(resp.body.data());
+    BrotliDecoderResult result;
+    do {
+      std::uint8_t chunk[16 * 1024];
+      std::size_t avail_out = sizeof(chunk);
+      auto* next_out = chunk;
+      result = ::BrotliDecoderDecompressStream(state, &avail_in, &next_in, &avail_out, &next_out, nullptr);
+      out.append(reinterpret_cast<const char*>(chunk), sizeof(chunk) - avail_out);
+    } while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT);
+    ::BrotliDecoderDestroyInstance(state);
+    return result == BROTLI_DECODER_RESULT_SUCCESS ? out : "<corrupt>";
+  }
+#endif
+  return "<corrupt>";
+}
+
+std::string text(std::size_t lines) {
+  std::string s{};
+  for (std::size_t i = 0; i < lines; ++i) {
+    s += fmt::format("<li class=\"item\">item number {} of the list</li>\n", i);
+  }
+  return s;
+}
+
+ws::server_config compressing(std::size_t num_reactors, ws::backend b = ws::backend::libevent) {
+  ws::server_config config{"127.0.0.1", 0, num_reactors};
+  config.compression.enabled = true;
+  config.compression.num_workers = 1;
+  config.backend = b;
+  return config;
+}
+
+// the preferred coding this build can produce, for Accept-Encoding
+std::string best() {
+  return ws::is_available(ws::encoding::br) ? "br" : ws::is_available(ws::encoding::gzip) ? "gzip" : "identity";
+}
+
+void test_negotiate() {
+  bool gzip = ws::is_available(ws::encoding::gzip);
+  bool br = ws::is_available(ws::encoding::br);
+  fmt::print("gzip: {}, br: {}\n", gzip, br);
+  auto expect = [](bool available, ws::encoding e) { return available ? e : ws::encoding::identity; };
+  check(ws::negotiate("gzip, deflate, br") == (br ? ws::encoding::br : expect(gzip, ws::encoding::gzip)), "br first");
+  check(ws::negotiate("gzip;q=0.5, br;q=0.4") == (gzip ? ws::encoding::gzip : expect(br, ws::encoding::br)), "by q-value");
+  check(ws::negotiate("br;q=0, gzip;q=0") == ws::encoding::identity, "q=0 refuses");
+  check(ws::negotiate("*;q=0.1, br;q=0") == expect(gzip, ws::encoding::gzip), "* covers the others");
+  check(ws::negotiate("GZIP") == expect(gzip, ws::encoding::gzip) && ws::negotiate("x-gzip;q=1.0") == ws::negotiate("gzip"),
+        "case and x-gzip");
+  check(ws::negotiate("") == ws::encoding::identity && ws::negotiate("deflate, identity") == ws::encoding::identity,
+        "nothing we produce");
+
+  check(ws::is_compressible("text/html; charset=utf-8") && ws::is_compressible("application/json") &&
+            ws::is_compressible("application/ld+json") && ws::is_compressible("image/svg+xml"),
+        "compressible types");
+  check(!ws::is_compressible("image/png") && !ws::is_compressible("application/octet-stream") && !ws::is_compressible(""),
+        "binary types");
+}
+
+void test_round_trip() {
+  auto original = text(500);
+  for (auto e : {ws::encoding::gzip, ws::encoding::br}) {
+    std::string encoded{};
+    bool ok = ws::compress(original, e, e == ws::encoding::br ? 5 : 6, encoded);
+    check(ok == ws::is_available(e), "compress() if available");
+    if (!ok) {
+      continue;
+    }
+    http_response resp{};
+    resp.head = fmt::format("HTTP/1.1 200 OK\r\nContent-Encoding: {}\r\n", ws::encoding_name(e));
+    resp.body = encoded;
+    check(encoded.size() < original.size() / 4 && decode(resp) == original, "round trip");
+  }
+}
+
+void test_files() {
+  auto root = fs::temp_directory_path() / fmt::format("ws_compression_{}", ::getpid());
+  fs::create_directories(root);
+  auto page = text(400);
+  std::ofstream{root / "page.html", std::ios::binary} << page;
+  std::ofstream{root / "small.txt", std::ios::binary} << "tiny";
+  std::ofstream{root / "blob.png", std::ios::binary} << std::string(4096, 'p');
+  ws::file_cache files{{root.string()}};
+  ws::server srv{compressing(1), ws::static_files{files}};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  auto get = fmt::format("GET /page.html HTTP/1.1\r\nAccept-Encoding: {}\r\n\r\n", best());
+  check(client.send_all(get) && client.read_response(resp) && resp.status == 200 && decode(resp) == page, "first GET");
+  check(resp.header("Vary") == "Accept-Encoding", "Vary on a compressible file");
+  auto etag = resp.header("ETag");
+  for (int i = 0; i < 200 && resp.header("Content-Encoding").empty(); ++i) {  // the original until the copy is ready
+    std::this_thread::sleep_for(5ms);
+    client.send_all(get);
+    client.read_response(resp);
+  }
+  check(resp.header("Content-Encoding") == best() && resp.body.size() < page.size() / 4 && decode(resp) == page,
+        "the encoded copy");
+  check(std::stoul(resp.header("Content-Length")) == resp.body.size(), "its Content-Length");
+  check(etag.rfind("W/", 0) != 0 && resp.header("ETag") == "W/" + etag, "a weak ETag on the copy");
+  check(client.send_all("GET /page.html HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+            resp.header("Content-Encoding").empty() && resp.body == page && resp.header("Vary") == "Accept-Encoding" &&
+            resp.header("ETag") == etag,
+        "identity without Accept-Encoding");
+  check(client.send_all("GET /small.txt HTTP/1.1\r\nAccept-Encoding: gzip, br\r\n\r\n") && client.read_response(resp) &&
+            resp.body == "tiny" && resp.header("Vary").empty(),
+        "a small file as it is");
+  check(client.send_all("GET /blob.png HTTP/1.1\r\nAccept-Encoding: gzip, br\r\n\r\n") && client.read_response(resp) &&
+            resp.body.size() == 4096 && resp.header("Content-Encoding").empty(),
+        "an image as it is");
+  srv.stop();
+  fs::remove_all(root);
+}
+
+void test_dynamic(ws::backend b) {
+  auto large = text(300);
+  ws::handler pages = [&large](const ws::request& req, ws::response& resp) {
+    resp.content_type = "text/html; charset=utf-8";
+    resp.body = req.path == "/large" ? large : fmt::format("small {}", req.target);
+  };
+  ws::server srv{compressing(2, b), pages};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /large HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"
+                        "GET /small HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"
+                        "GET /large HTTP/1.1\r\nAccept-Encoding: br;q=0.9, gzip;q=0.1\r\n\r\n"
+                        "GET /large HTTP/1.1\r\n\r\n"),
+        "pipelined");
+  check(client.read_response(resp) && resp.header("Content-Encoding") == (ws::is_available(ws::encoding::gzip) ? "gzip" : "") &&
+            decode(resp) == large && resp.header("Vary") == "Accept-Encoding",
+        "gzip on a worker");
+  check(client.read_response(resp) && resp.body == "small /small" && resp.header("Content-Encoding").empty(),
+        "a small one behind it, in order");
+  check(client.read_response(resp) && decode(resp) == large, "the negotiated coding");
+  check(client.read_response(resp) && resp.body == large && resp.header("Content-Encoding").empty(),
+        "identity without Accept-Encoding");
+  check(client.send_all("HEAD /large HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n") && client.read_response(resp, false) &&
+            resp.header("Content-Encoding").empty() && std::stoul(resp.header("Content-Length")) == large.size(),
+        "HEAD is not encoded");
+  for (int i = 0; i < 50; ++i) {  // many in flight at once
+    client.send_all(fmt::format("GET /large HTTP/1.1\r\nAccept-Encoding: {}\r\n\r\nGET /s{} HTTP/1.1\r\n\r\n", best(), i));
+  }
+  bool in_order{true};
+  for (int i = 0; i < 50; ++i) {
+    in_order = in_order && client.read_response(resp) && decode(resp) == large;
+    in_order = in_order && client.read_response(resp) && resp.body == fmt::format("small /s{}", i);
+  }
+  check(in_order, "50 pipelined pairs in order");
+  check(client.send_all(fmt::format("GET /large HTTP/1.1\r\nAccept-Encoding: {}\r\nConnection: close\r\n\r\n", best())) &&
+            client.read_response(resp) && decode(resp) == large && resp.header("Connection") == "close",
+        "encoded with Connection: close");
+  check(client.closed_by_peer(), "closed after it");
+
+  // a client gone while its response is on a worker
+  for (int i = 0; i < 20; ++i) {
+    http_client quitter{srv.get_port()};
+    quitter.send_all(fmt::format("GET /large HTTP/1.1\r\nAccept-Encoding: {}\r\n\r\n", best()));
+  }
+  http_client after{srv.get_port()};
+  check(after.send_all("GET /small HTTP/1.1\r\n\r\n") && after.read_response(resp) && resp.body == "small /small",
+        "still serving after abandoned encodings");
+  srv.stop();
+}
+
+void test_cached() {
+  auto page = text(200);
+  ws::response_cache cache{};
+  ws::handler render = [&page](const ws::request&, ws::response& resp) {
+    resp.content_type = "text/html; charset=utf-8";
+    resp.body = page;
+  };
+  ws::server srv{compressing(1), ws::caching_handler{cache, render}};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  auto get = fmt::format("GET /page HTTP/1.1\r\nAccept-Encoding: {}\r\n\r\n", best());
+  check(client.send_all(get) && client.read_response(resp) && resp.body == page, "miss");
+  auto etag = resp.header("ETag");
+  check(resp.header("Vary") == "Accept-Encoding" && etag.rfind("W/", 0) != 0, "Vary and a strong ETag on the original");
+  for (int i = 0; i < 200 && resp.header("Content-Encoding").empty(); ++i) {
+    std::this_thread::sleep_for(5ms);
+    client.send_all(get);
+    client.read_response(resp);
+  }
+  check(resp.header("Content-Encoding") == best() && decode(resp) == page, "the encoded variant from the cache");
+  check(resp.header("ETag") == "W/" + etag, "weak ETag on the variant");
+  check(client.send_all(fmt::format("GET /page HTTP/1.1\r\nAccept-Encoding: {}\r\nIf-None-Match: W/{}\r\n\r\n", best(), etag)) &&
+            client.read_response(resp) && resp.status == 304 && resp.header("Vary") == "Accept-Encoding",
+        "304 for the weak tag");
+  check(client.send_all("GET /page HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == page &&
+            resp.header("ETag") == etag,
+        "the original for identity");
+}
+
+// pipelined GETs of a rendered page, encoded per response or not
+void bench_compression(bool enabled) {
+  auto page = text(150);  // ~7 KB of markup
+  ws::handler render = [&page](const ws::request&, ws::response& resp) {
+    resp.content_type = "text/html; charset=utf-8";
+    resp.body = page;
+  };
+  auto config = compressing(1);
+  config.compression.enabled = enabled;
+  ws::server srv{config, render};
+  srv.start();
+  std::string batch{};
+  for (int i = 0; i < 16; ++i) {
+    batch += "GET /list HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip\r\n\r\n";
+  }
+  http_client client{srv.get_port()};
+  http_response resp;
+  std::size_t n{0};
+  std::size_t bytes{0};
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < 500ms && client.send_all(batch)) {
+    for (int i = 0; i < 16 && client.read_response(resp); ++i) {
+      ++n;
+      bytes += resp.head.size() + 2 + resp.body.size();
+    }
+  }
+  auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("{:<12} {:>10.0f} req/s, {:>6} bytes per response\n", enabled ? "gzip:" : "identity:",
+             static_cast<double>(n) / secs, n == 0 ? 0 : bytes / n);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_negotiate);
+  test::test_negotiate();
+
+  DividingLine(test_round_trip);
+  test::test_round_trip();
+
+  if (ws::is_available(ws::encoding::gzip) || ws::is_available(ws::encoding::br)) {
+    DividingLine(test_files);
+    test::test_files();
+
+    DividingLine(test_dynamic);
+    test::test_dynamic(ws::backend::libevent);
+    try {
+      test::test_dynamic(ws::backend::io_uring);
+    } catch (const std::system_error& e) {
+      fmt::print("io_uring backend unavailable ({}): skipped\n", e.what());
+    }
+
+    DividingLine(test_cached);
+    test::test_cached();
+
+    DividingLine(bench_compression);
+    test::bench_compression(false);
+    test::bench_compression(true);
+  }
+  return test::failures;
+}
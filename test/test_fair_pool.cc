@@ -0,0 +1,117 @@
+/** @file    test_fair_pool.cc
+ *  @time    2026/10/18 ~ 上午10:48
+ *  @author  Leon
+ *
+ *  @note    Weighted sharing of worker time among task groups
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <threadpool/fair_pool.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <check.h>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <stdexcept>
+
+namespace test {
+
+using namespace std::chrono_literals;
+constexpr std::size_t TEST_TASK_NUM = 2000;
+
+// keep a worker busy for about `duration`
+void busy_for(std::chrono::microseconds duration) {
+  auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+void print_stats(tp::FairThreadPool& pool) {
+  for (auto&& s : pool.get_stats()) {
+    fmt::print("{:>8}: weight {}, queued {:>5}, running {}, completed {:>5}, busy {:>8.2f}ms\n", s.name, s.weight, s.queued,
+               s.running, s.completed, std::chrono::duration<double, std::milli>(s.busy).count());
+  }
+}
+
+void test_weighted_share() {
+  tp::FairThreadPool pool{2};
+  auto noisy = pool.add_group("noisy", 1);
+  auto quiet = pool.add_group("quiet", 3);
+
+  // the noisy tenant floods the pool first, the quiet one still gets ~3/4 of the time
+  std::vector<std::function<void()>> tasks(TEST_TASK_NUM, [] { busy_for(50us); });
+  auto f1 = pool.submit_in_batch_to(noisy, tasks);
+  std::vector<std::function<void()>> tasks2(TEST_TASK_NUM, [] { busy_for(50us); });
+  auto f2 = pool.submit_in_batch_to(quiet, tasks2);
+
+  std::this_thread::sleep_for(100ms);
+  auto n = pool.get_group_stats(noisy).busy.count();
+  auto q = pool.get_group_stats(quiet).busy.count();
+  fmt::print("share of quiet under contention: {:.2f} (expect ~0.75)\n", static_cast<double>(q) / static_cast<double>(n + q));
+  print_stats(pool);
+
+  TIC(test_weighted_share)
+  pool.wait_for_tasks();
+  TOK(test_weighted_share)
+  print_stats(pool);
+}
+
+void test_idle_capacity() {
+  tp::FairThreadPool pool{2};
+  auto lonely = pool.add_group("lonely", 1);
+  pool.add_group("absent", 100);
+
+  // a low-weight group alone still uses every worker
+  std::vector<std::future<int>> futures;
+  futures.reserve(TEST_TASK_NUM);
+  TIC(test_idle_capacity)
+  for (std::size_t i = 0; i < TEST_TASK_NUM; ++i) {
+    futures.emplace_back(pool.submit_task_to(lonely, [i] { return static_cast<int>(i); }));
+  }
+  pool.wait_for_tasks();
+  TOK(test_idle_capacity)
+  fmt::print("last result: {}\n", futures.back().get());
+  print_stats(pool);
+}
+
+// a task refused by the queue must not be waited for, by wait_for_tasks() nor by the destructor
+void test_unknown_group() {
+  bool one_refused{false};
+  bool batch_refused{false};
+  {
+    tp::FairThreadPool pool{2};
+    try {
+      pool.submit_task_to(tp::FairThreadPool::group_id{42}, [] {});
+    } catch (const std::out_of_range&) {
+      one_refused = true;
+    }
+    std::vector<std::function<void()>> tasks(3, [] {});
+    try {
+      pool.submit_in_batch_to(tp::FairThreadPool::group_id{42}, tasks);
+    } catch (const std::out_of_range&) {
+      batch_refused = true;
+    }
+    pool.submit_task([] {}).get();
+    pool.wait_for_tasks();
+  }
+  check(one_refused && batch_refused, "an unknown group throws, and the pool is destroyed");
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_weighted_share);
+  test::test_weighted_share();
+
+  DividingLine(test_idle_capacity);
+  test::test_idle_capacity();
+
+  DividingLine(test_unknown_group);
+  test::test_unknown_group();
+  return test::failures;
+}
@@ -0,0 +1,108 @@
+/** @file    test_fiber.cc
+ *  @time    2026/10/18 ~ 下午6:05
+ *  @author  Leon
+ *
+ *  @note    Many blocking-style fibers on a handful of workers
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <threadpool/fiber.h>
+#include <threadpool/steady_pool.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <vector>
+#include <unistd.h>
+
+namespace test {
+
+using namespace std::chrono_literals;
+constexpr std::size_t TEST_FIBER_NUM = 10000;
+
+int check(bool ok, const char* what) {
+  fmt::print("{} {}\n", ok ? "[ OK ]" : "[FAIL]", what);
+  return ok ? 0 : 1;
+}
+
+int test_await_futures() {
+  tp::SteadyThreadPool pool{4};
+  tp::fiber_scheduler fibers{pool};
+
+  // each "request" waits on two sub-requests; thousands are in flight on 4 workers
+  std::vector<tp::future<int>> results;
+  results.reserve(TEST_FIBER_NUM);
+  TIC(test_await_futures)
+  for (std::size_t i = 0; i < TEST_FIBER_NUM; ++i) {
+    results.emplace_back(fibers.spawn([&pool, i] {
+      auto a = tp::this_fiber::await(pool.async([i] { return static_cast<int>(i); }));
+      tp::this_fiber::yield();
+      auto b = tp::this_fiber::await(pool.async([] { return 1; }));
+      return a + b;
+    }));
+  }
+  auto values = tp::when_all(std::move(results)).get();
+  TOK(test_await_futures)
+
+  bool ok{true};
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    ok = ok && values[i] == static_cast<int>(i) + 1;
+  }
+  return check(ok, "fibers awaiting pool futures");
+}
+
+int test_wait_readable() {
+  tp::SteadyThreadPool pool{2};
+  tp::fiber_scheduler fibers{pool};
+
+  int fds[2];
+  if (::pipe(fds) != 0) {
+    return check(false, "pipe");
+  }
+  auto reader = fibers.spawn([fd = fds[0]] {
+    tp::this_fiber::wait_readable(fd);  // the worker stays free meanwhile
+    char c{0};
+    return ::read(fd, &c, 1) == 1 ? c : '?';
+  });
+
+  // the workers still run other tasks while the fiber is parked
+  auto other = pool.async([] { return 7; });
+  int failures = check(other.get() == 7, "workers are not blocked by a parked fiber");
+
+  std::this_thread::sleep_for(50ms);
+  char c{'x'};
+  [[maybe_unused]] auto n = ::write(fds[1], &c, 1);
+  failures += check(reader.get() == 'x', "fiber resumed on fd readiness");
+  ::close(fds[0]);
+  ::close(fds[1]);
+  return failures;
+}
+
+int test_exceptions() {
+  tp::SteadyThreadPool pool{2};
+  tp::fiber_scheduler fibers{pool};
+  auto failing = fibers.spawn([]() -> int { throw std::runtime_error{"handler failed"}; });
+  try {
+    failing.get();
+    return check(false, "an exception leaves the fiber through its future");
+  } catch (const std::runtime_error&) {
+    return check(true, "an exception leaves the fiber through its future");
+  }
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  int failures{0};
+  DividingLine(Start Tests !);
+  DividingLine(test_await_futures);
+  failures += test::test_await_futures();
+
+  DividingLine(test_wait_readable);
+  failures += test::test_wait_readable();
+
+  DividingLine(test_exceptions);
+  failures += test::test_exceptions();
+  return failures;
+}
@@ -0,0 +1,126 @@
+/** @file    test_future.cc
+ *  @time    2026/10/18 ~ 下午4:40
+ *  @author  Leon
+ *
+ *  @note    Continuations and when_all / when_any over pool futures
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <threadpool/future.h>
+#include <threadpool/steady_pool.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+
+namespace test {
+
+using namespace std::chrono_literals;
+constexpr std::size_t TEST_TASK_NUM = 100000;
+
+int check(bool ok, const char* what) {
+  fmt::print("{} {}\n", ok ? "[ OK ]" : "[FAIL]", what);
+  return ok ? 0 : 1;
+}
+
+int test_scatter_gather() {
+  tp::SteadyThreadPool pool{4};
+
+  // one request fans out to N sub-requests; the gather runs as a continuation, nothing waits in between
+  std::vector<tp::future<int>> parts;
+  parts.reserve(TEST_TASK_NUM);
+  TIC(test_scatter_gather)
+  for (std::size_t i = 0; i < TEST_TASK_NUM; ++i) {
+    parts.emplace_back(pool.async([i] { return static_cast<int>(i % 7); }));
+  }
+  auto total = tp::when_all(std::move(parts)).then([](tp::future<std::vector<int>> f) {
+    auto values = f.get();
+    return std::accumulate(values.begin(), values.end(), 0L);
+  });
+  auto sum = total.get();
+  TOK(test_scatter_gather)
+
+  long expected{0};
+  for (std::size_t i = 0; i < TEST_TASK_NUM; ++i) {
+    expected += static_cast<long>(i % 7);
+  }
+  return check(sum == expected, "when_all gathers every result");
+}
+
+int test_when_any() {
+  tp::SteadyThreadPool pool{4};
+  int failures{0};
+
+  std::vector<tp::future<int>> racers;
+  racers.emplace_back(pool.async([] {
+    std::this_thread::sleep_for(200ms);
+    return 1;
+  }));
+  racers.emplace_back(pool.async([] { return 2; }));
+  auto first = tp::when_any(std::move(racers)).get();
+  failures += check(first.index == 1 && first.value == 2, "when_any picks the first to complete");
+
+  std::vector<tp::future<void>> voids;
+  voids.emplace_back(pool.async([] {}));
+  failures += check(tp::when_any(std::move(voids)).get().index == 0, "when_any over void futures");
+  return failures;
+}
+
+int test_errors_and_continuations() {
+  tp::SteadyThreadPool pool{2};
+  int failures{0};
+
+  std::vector<tp::future<int>> parts;
+  parts.emplace_back(pool.async([] { return 1; }));
+  parts.emplace_back(pool.async([]() -> int { throw std::runtime_error{"sub-request failed"}; }));
+  auto all = tp::when_all(std::move(parts));
+  try {
+    all.get();
+    failures += check(false, "when_all propagates an exception");
+  } catch (const std::runtime_error&) {
+    failures += check(true, "when_all propagates an exception");
+  }
+
+  // a chain of continuations, the last one back on the pool
+  auto chained = pool.async([] { return 20; })
+                     .then([](tp::future<int> f) { return f.get() + 1; })
+                     .then(pool, [](tp::future<int> f) { return f.get() * 2; });
+  failures += check(chained.get() == 42, "then() chains, also through the pool");
+
+  std::vector<tp::future<void>> none;
+  tp::when_all(std::move(none)).get();
+  failures += check(true, "when_all of nothing is ready at once");
+
+  tp::future<int> broken;
+  {
+    tp::promise<int> p;
+    broken = p.get_future();
+  }
+  try {
+    broken.get();
+    failures += check(false, "a dropped promise breaks its future");
+  } catch (const std::future_error&) {
+    failures += check(true, "a dropped promise breaks its future");
+  }
+  return failures;
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  int failures{0};
+  DividingLine(Start Tests !);
+  DividingLine(test_scatter_gather);
+  failures += test::test_scatter_gather();
+
+  DividingLine(test_when_any);
+  failures += test::test_when_any();
+
+  DividingLine(test_errors_and_continuations);
+  failures += test::test_errors_and_continuations();
+  return failures;
+}
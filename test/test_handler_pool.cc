@@ -0,0 +1,287 @@
+/** @file    test_handler_pool.cc
+ *  @time    2026/10/21 ~ 下午10:30
+ *  @author  Leon
+ *
+ *  @note    ws::handler_pool: request copies, heavy routes and ws::offload on both backends (order behind them, HEAD,
+ *           coding, failures), a slow handler not stalling its reactor; latency of light requests next to heavy ones
+ *
+ */
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/router.h>
+#include <webserver/handler_pool.h>
+#include <webserver/response_cache.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace test {
+
+using namespace std::chrono_literals;
+using steady = std::chrono::steady_clock;
+
+void test_copy_request() {
+  std::string buffer{"POST /a/b?x=1 HTTP/1.1\r\nHost: h\r\n\r\nbody"};
+  ws::request req{};
+  req.method = std::string_view{buffer}.substr(0, 4);
+  req.target = std::string_view{buffer}.substr(5, 8);
+  req.path = std::string_view{buffer}.substr(5, 4);
+  req.query = std::string_view{buffer}.substr(10, 3);
+  req.headers.push_back({std::string_view{buffer}.substr(24, 4), std::string_view{buffer}.substr(30, 1)});
+  req.body = std::string_view{buffer}.substr(35);
+  req.keep_alive = false;
+  auto copy = ws::copy_request(req);
+  buffer.assign(buffer.size(), '#');
+  check(copy->method == "POST" && copy->target == "/a/b?x=1" && copy->path == "/a/b" && copy->query == "x=1" &&
+            copy->get_header("host") == "h" && copy->body == "body" && !copy->keep_alive,
+        "a copy owns what it views");
+}
+
+std::atomic<std::thread::id> worker_thread{};
+
+ws::router make_routes() {
+  ws::router routes{};
+  routes.add("GET", "/fast", [](const ws::request&, const ws::route_params&, ws::response& resp) {
+    resp.body = "fast";
+  });
+  routes.add(
+      "GET", "/slow/:ms",
+      [](const ws::request& req, const ws::route_params& p, ws::response& resp) {
+        worker_thread = std::this_thread::get_id();
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::stoi(std::string{p.get("ms")})));
+        resp.headers.emplace_back("X-Query", std::string{req.query});
+        resp.body = fmt::format("slept {}", p.get("ms"));
+      },
+      ws::run_on::pool);
+  routes.add(
+      "GET", "/text",
+      [](const ws::request&, const ws::route_params&, ws::response& resp) {
+        resp.body = std::string(20000, 'z');
+      },
+      ws::run_on::pool);
+  routes.add(
+      "GET", "/fail",
+      [](const ws::request&, const ws::route_params&, ws::response&) { throw std::runtime_error{"boom"}; },
+      ws::run_on::pool);
+  routes.add(
+      "GET", "/fail/int", [](const ws::request&, const ws::route_params&, ws::response&) { throw 42; }, ws::run_on::pool);
+  return routes;
+}
+
+void heavy_routes(ws::backend backend) {
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.backend = backend;
+  config.handler_threads = 2;
+  config.compression.enabled = ws::is_available(ws::encoding::gzip);
+  ws::server srv{config, make_routes()};
+  try {
+    srv.start();
+  } catch (const std::system_error& e) {
+    fmt::print("backend unavailable ({}): skipped\n", e.what());
+    return;
+  }
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /slow/10?q=7 HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 200 &&
+            resp.body == "slept 10" && resp.header("X-Query") == "q=7" && resp.header("Date").size() == 29,
+        "a heavy route, captures matched on the copy");
+  check(worker_thread.load() != std::thread::id{} && worker_thread.load() != std::this_thread::get_id(),
+        "run on a worker");
+
+  check(client.send_all("GET /slow/50 HTTP/1.1\r\n\r\nGET /fast HTTP/1.1\r\n\r\nGET /slow/1 HTTP/1.1\r\n\r\n") &&
+            client.read_response(resp) && resp.body == "slept 50" && client.read_response(resp) &&
+            resp.body == "fast" && client.read_response(resp) && resp.body == "slept 1",
+        "pipelined requests answered in order around it");
+
+  check(client.send_all("HEAD /slow/1 HTTP/1.1\r\n\r\nGET /fast HTTP/1.1\r\n\r\n") &&
+            client.read_response(resp, false) && resp.header("Content-Length") == "7" && client.read_response(resp) &&
+            resp.body == "fast",
+        "HEAD: the length, no body");
+
+  if (config.compression.enabled) {
+    check(client.send_all("GET /text HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n") && client.read_response(resp) &&
+              resp.header("Content-Encoding") == "gzip" && resp.body.size() < 1000,
+          "encoded on the worker");
+  }
+  check(client.send_all("GET /fail HTTP/1.1\r\n\r\nGET /fast HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+            resp.status == 500 && client.read_response(resp) && resp.body == "fast",
+        "a throwing handler: 500, the connection goes on");
+  check(client.send_all("GET /fail/int HTTP/1.1\r\n\r\nGET /fast HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+            resp.status == 500 && client.read_response(resp) && resp.body == "fast",
+        "... whatever it throws");
+
+  // the reactor keeps serving its other connections meanwhile
+  http_client slow{srv.get_port()};
+  slow.send_all("GET /slow/500 HTTP/1.1\r\n\r\n");
+  std::this_thread::sleep_for(20ms);
+  auto start = steady::now();
+  bool fast_ok{true};
+  for (int i = 0; i < 10; ++i) {
+    fast_ok = fast_ok && client.send_all("GET /fast HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+              resp.body == "fast";
+  }
+  auto took = steady::now() - start;
+  check(fast_ok && took < 250ms, "not stalled by a slow handler on the same reactor");
+  check(slow.read_response(resp) && resp.body == "slept 500", "the slow one arrives too");
+
+  // closed while its response is being made: dropped quietly
+  {
+    http_client gone{srv.get_port()};
+    gone.send_all("GET /slow/100 HTTP/1.1\r\n\r\n");
+  }
+  std::this_thread::sleep_for(150ms);
+  check(client.send_all("GET /fast HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == "fast",
+        "a closed connection's response is dropped");
+}
+
+void test_heavy_routes() {
+  heavy_routes(ws::backend::libevent);
+#ifdef WITH_IO_URING
+  heavy_routes(ws::backend::io_uring);
+#endif
+}
+
+void test_offload() {
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.handler_threads = 1;
+  std::atomic<std::thread::id> ran{};
+  ws::server srv{config, ws::offload{[&](const ws::request& req, ws::response& resp) {
+                   ran = std::this_thread::get_id();
+                   resp.body = std::string{req.path};
+                 }}};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /offloaded HTTP/1.1\r\nConnection: close\r\n\r\n") && client.read_response(resp) &&
+            resp.body == "/offloaded" && resp.header("Connection") == "close" && client.closed_by_peer(),
+        "ws::offload, Connection: close");
+  check(ran.load() != std::thread::id{}, "ran");
+
+  // without a pool the deferred part runs on the reactor
+  config.handler_threads = 0;
+  ws::server inline_srv{config, ws::offload{[](const ws::request&, ws::response& resp) { resp.body = "inline"; }}};
+  inline_srv.start();
+  http_client other{inline_srv.get_port()};
+  check(other.send_all("GET / HTTP/1.1\r\n\r\n") && other.read_response(resp) && resp.body == "inline",
+        "no handler pool");
+  ws::server throwing_srv{config, ws::offload{[](const ws::request&, ws::response&) { throw "not an exception"; }}};
+  throwing_srv.start();
+  http_client thrower{throwing_srv.get_port()};
+  check(thrower.send_all("GET / HTTP/1.1\r\n\r\n") && thrower.read_response(resp) && resp.status == 500,
+        "a non-std::exception on the reactor: 500");
+}
+
+// a cache in front of an offloaded handler stores what the worker made, not the empty response left on the reactor
+void test_cached_offload() {
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.handler_threads = 1;
+  ws::response_cache cache{};
+  std::atomic<int> made{0};
+  ws::server srv{config, ws::caching_handler{cache, ws::offload{[&](const ws::request&, ws::response& resp) {
+                                                ++made;
+                                                resp.body = "made on a worker";
+                                              }}}};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /report HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+            resp.body == "made on a worker" && !resp.header("ETag").empty(),
+        "the first answer has the worker's body");
+  auto etag = resp.header("ETag");
+  check(client.send_all("GET /report HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+            resp.body == "made on a worker" && made.load() == 1 && cache.get_num_entries() == 1,
+        "then served from the cache");
+  check(client.send_all("GET /report HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n") && client.read_response(resp) &&
+            resp.status == 304 && made.load() == 1,
+        "304 from the cache");
+}
+
+// ~1 ms of arithmetic
+std::string burn() {
+  std::uint64_t x{88172645463325252ULL};
+  for (int i = 0; i < 400000; ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  return std::to_string(x);
+}
+
+// p99 latency of light requests while another connection keeps a heavy route busy
+double light_p99_us(ws::run_on where) {
+  ws::router routes{};
+  routes.add("GET", "/light", [](const ws::request&, const ws::route_params&, ws::response& resp) { resp.body = "l"; });
+  routes.add("GET", "/heavy", [](const ws::request&, const ws::route_params&, ws::response& resp) { resp.body = burn(); },
+             where);
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.handler_threads = 1;
+  ws::server srv{config, routes};
+  srv.start();
+  std::atomic<bool> done{false};
+  std::thread heavy{[&] {
+    http_client c{srv.get_port()};
+    http_response r;
+    std::string batch{};
+    for (int i = 0; i < 8; ++i) {
+      batch += "GET /heavy HTTP/1.1\r\n\r\n";
+    }
+    while (!done.load() && c.send_all(batch)) {
+      for (int i = 0; i < 8; ++i) {
+        c.read_response(r);
+      }
+    }
+  }};
+  http_client client{srv.get_port()};
+  http_response resp;
+  std::vector<double> latencies{};
+  auto start = steady::now();
+  while (steady::now() - start < 1s) {
+    auto t = steady::now();
+    client.send_all("GET /light HTTP/1.1\r\n\r\n");
+    client.read_response(resp);
+    latencies.push_back(std::chrono::duration<double, std::micro>(steady::now() - t).count());
+  }
+  done = true;
+  heavy.join();
+  std::sort(latencies.begin(), latencies.end());
+  return latencies[latencies.size() * 99 / 100];
+}
+
+void bench_latency() {
+  auto on_reactor = light_p99_us(ws::run_on::reactor);
+  auto on_pool = light_p99_us(ws::run_on::pool);
+  fmt::print("light request p99 next to 8 pipelined ~1 ms handlers: on the reactor {:>8.0f} us, on the pool {:>8.0f} us\n",
+             on_reactor, on_pool);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_copy_request);
+  test::test_copy_request();
+
+  DividingLine(test_heavy_routes);
+  test::test_heavy_routes();
+
+  DividingLine(test_offload);
+  test::test_offload();
+
+  DividingLine(test_cached_offload);
+  test::test_cached_offload();
+
+  DividingLine(bench_latency);
+  test::bench_latency();
+  return test::failures;
+}
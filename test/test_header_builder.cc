@@ -0,0 +1,165 @@
+/** @file    test_header_builder.cc
+ *  @time    2026/10/20 ~ 下午8:30
+ *  @author  Leon
+ *
+ *  @note    ws::header_builder: status lines, head layout, the Date line and its once-a-second refresh, Date on every
+ *           kind of response; head rendering against per-response formatting with strftime
+ *
+ */
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/header_builder.h>
+#include <webserver/response_cache.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <chrono>
+#include <ctime>
+#include <string>
+
+namespace test {
+
+using namespace std::chrono_literals;
+
+void test_status_lines() {
+  check(ws::status_line(200) == "HTTP/1.1 200 OK\r\n" && ws::status_line(404) == "HTTP/1.1 404 Not Found\r\n" &&
+            ws::status_line(431) == "HTTP/1.1 431 Request Header Fields Too Large\r\n",
+        "pre-serialized status lines");
+  check(ws::status_line(299).empty() && ws::status_line(42).empty() && ws::status_line(1000).empty(),
+        "none for unknown statuses");
+}
+
+void test_date() {
+  ws::header_builder builder{};
+  builder.update_date(784111777);  // RFC 9110's example
+  check(builder.get_date() == "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n", "IMF-fixdate");
+  builder.update_date(951782400);
+  check(builder.get_date() == "Date: Tue, 29 Feb 2000 00:00:00 GMT\r\n", "a leap day");
+  builder.update_date(std::time(nullptr));
+  auto now = std::string{builder.get_date()};
+  check(now.size() == 37 && now.rfind("Date: ", 0) == 0 && now.find(" GMT\r\n") == 31, "now");
+}
+
+void test_build() {
+  ws::header_builder builder{};
+  builder.update_date(784111777);
+  ws::response resp{};
+  resp.body = "hello";
+  resp.headers.emplace_back("X-Id", "7");
+  check(builder.build(resp) ==
+            "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 5\r\nX-Id: 7\r\n"
+            "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\nConnection: keep-alive\r\n\r\n",
+        "a full head");
+  resp.status = 299;
+  resp.keep_alive = false;
+  auto head = builder.build(resp);
+  check(head.rfind("HTTP/1.1 299 Unknown\r\n", 0) == 0 && head.find("Connection: close\r\n\r\n") == head.size() - 21,
+        "an unknown status, Connection: close");
+
+  std::string plain{};
+  resp.serialize_head(plain);
+  check(plain.find("Date:") == std::string::npos && plain.find("Content-Length: 5\r\n") != std::string::npos,
+        "serialize_head() leaves the Date to the reactor");
+}
+
+void test_serving() {
+  ws::response_cache cache{};
+  ws::handler pages = [](const ws::request& req, ws::response& resp) {
+    resp.body = req.path == "/large" ? std::string(20000, 'L') : "page";
+  };
+  ws::server srv{{"127.0.0.1", 0, 1}, ws::caching_handler{cache, pages}};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  auto dated = [](const http_response& r) { return r.header("Date").size() == 29; };
+  check(client.send_all("GET /page HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == "page" && dated(resp),
+        "Date on a rendered response");
+  check(client.send_all("GET /page HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == "page" && dated(resp),
+        "Date on a prepared one");
+  check(client.send_all("GET /page HTTP/1.1\r\nIf-None-Match: " + resp.header("ETag") + "\r\n\r\n") &&
+            client.read_response(resp) && resp.status == 304 && dated(resp),
+        "Date on a 304");
+  check(client.send_all("GET /large HTTP/1.1\r\n\r\nGET /large HTTP/1.1\r\nConnection: close\r\n\r\n") &&
+            client.read_response(resp) && resp.body.size() == 20000 && dated(resp) && client.read_response(resp) &&
+            resp.body.size() == 20000 && dated(resp) && resp.header("Connection") == "close",
+        "Date on a large prepared one, kept alive and closing");
+
+  // the reactor's tick moves it on
+  http_client second{srv.get_port()};
+  second.send_all("GET /x HTTP/1.1\r\n\r\n");
+  second.read_response(resp);
+  auto first = resp.header("Date");
+  std::this_thread::sleep_for(1200ms);
+  check(second.send_all("GET /x HTTP/1.1\r\n\r\n") && second.read_response(resp) && resp.header("Date") != first,
+        "re-rendered within a second");
+}
+
+// the head as it was rendered before: runtime format strings into a string, strftime per response
+void legacy_head(std::string& out, const ws::response& resp) {
+  fmt::format_to(std::back_inserter(out), "HTTP/1.1 {} {}\r\nContent-Type: {}\r\nContent-Length: {}\r\n", resp.status,
+                 ws::status_reason(resp.status), resp.content_type, resp.body.size());
+  for (const auto& [name, value] : resp.headers) {
+    fmt::format_to(std::back_inserter(out), "{}: {}\r\n", name, value);
+  }
+  char date[64];
+  auto now = std::time(nullptr);
+  std::tm t{};
+  ::gmtime_r(&now, &t);
+  auto n = std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &t);
+  fmt::format_to(std::back_inserter(out), "Date: {}\r\n", std::string_view{date, n});
+  out += resp.keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+}
+
+void bench_heads() {
+  constexpr int N{1'000'000};
+  ws::response resp{};
+  resp.content_type = "application/json";
+  resp.body = std::string(321, 'j');
+  resp.headers.emplace_back("Cache-Control", "no-cache");
+  resp.headers.emplace_back("X-Request-Id", "4f3c2a1b");
+  std::size_t bytes{0};
+
+  std::string out{};
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    out.clear();
+    legacy_head(out, resp);
+    bytes += out.size();
+  }
+  auto legacy = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / N;
+
+  ws::header_builder builder{};
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    bytes -= builder.build(resp).size();
+  }
+  auto built = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / N;
+  check(bytes == 0, "same head sizes");
+  fmt::print("per head: runtime format + strftime {:>6.1f} ns, header_builder {:>6.1f} ns\n", legacy, built);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_status_lines);
+  test::test_status_lines();
+
+  DividingLine(test_date);
+  test::test_date();
+
+  DividingLine(test_build);
+  test::test_build();
+
+  DividingLine(test_serving);
+  test::test_serving();
+
+  DividingLine(bench_heads);
+  test::bench_heads();
+  return test::failures;
+}
@@ -0,0 +1,175 @@
+/** @file    test_http_parser.cc
+ *  @time    2026/10/19 ~ 上午10:00
+ *  @author  Leon
+ *
+ *  @note    ws::http_parser on pipelined, fragmented and malformed input with every scanner, then requests/s and GB/s
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/http_parser.h>
+#include <webserver/scan.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <check.h>
+#include <string>
+#include <vector>
+#include <chrono>
+
+namespace test {
+
+const std::string typical =
+    "GET /api/v1/users/12345/profile?fields=name,email&lang=en HTTP/1.1\r\n"
+    "Host: api.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/118.0 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Cookie: session=4f3c2a1b0e9d8c7b6a5f4e3d2c1b0a99; theme=dark; tracking=off\r\n"
+    "Referer: https://www.example.com/dashboard\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+// parse everything in `input`, feeding it `step` bytes at a time; returns the paths of the parsed requests
+std::vector<std::string> parse_all(const std::string& input, std::size_t step, int* error = nullptr) {
+  ws::http_parser parser;
+  ws::request req;
+  std::vector<std::string> paths;
+  std::string buf;
+  std::size_t start{0};
+  for (std::size_t fed = 0; fed < input.size();) {
+    auto n = std::min(step, input.size() - fed);
+    buf.append(input, fed, n);
+    fed += n;
+    while (true) {
+      auto status = parser.parse(std::string_view{buf}.substr(start), req);
+      if (status == ws::parse_status::incomplete) {
+        break;
+      }
+      if (status == ws::parse_status::error) {
+        if (error != nullptr) {
+          *error = parser.get_error_status();
+        }
+        return paths;
+      }
+      paths.emplace_back(req.path);
+      start += parser.get_consumed();
+      parser.reset();
+    }
+  }
+  return paths;
+}
+
+int error_of(const std::string& input, ws::parser_limits limits = {}) {
+  ws::http_parser parser{limits};
+  ws::request req;
+  auto status = parser.parse(input, req);
+  return status == ws::parse_status::error ? parser.get_error_status() : 0;
+}
+
+void test_correctness() {
+  ws::http_parser parser;
+  ws::request req;
+  check(parser.parse(typical, req) == ws::parse_status::complete, "typical request");
+  check(parser.get_consumed() == typical.size(), "consumed all");
+  check(req.method == "GET" && req.path == "/api/v1/users/12345/profile", "method and path");
+  check(req.query == "fields=name,email&lang=en", "query");
+  check(req.headers.size() == 9 && req.get_header("host") == "api.example.com", "headers");
+  check(req.get_header("Accept-Encoding") == "gzip, deflate, br", "value trimmed");
+  check(req.keep_alive && req.version_minor == 1, "keep-alive");
+  // zero copy: the views point into the input
+  check(req.method.data() == typical.data() && req.get_header("Host").data() > typical.data(), "views into buffer");
+
+  // pipelined, with a body in the middle, in one buffer
+  std::string pipelined = "GET /a HTTP/1.1\r\n\r\nPOST /b HTTP/1.1\r\nContent-Length: 4\r\n\r\nbodyGET /c HTTP/1.0\r\n\r\n";
+  for (std::size_t step : {pipelined.size(), std::size_t{1}, std::size_t{3}, std::size_t{7}}) {
+    auto paths = parse_all(pipelined, step);
+    check(paths == std::vector<std::string>{"/a", "/b", "/c"}, "pipelined requests");
+  }
+
+  // fragmented byte by byte: every prefix is incomplete, and no byte is scanned twice
+  auto paths = parse_all(typical + typical, 1);
+  check(paths.size() == 2, "fragmented typical requests");
+
+  // bare LF line endings and leading empty lines are tolerated
+  paths = parse_all("\r\nGET /lf HTTP/1.1\nHost: x\n\n", 5);
+  check(paths == std::vector<std::string>{"/lf"}, "bare LF");
+
+  ws::request r10;
+  ws::http_parser p10;
+  p10.parse("GET / HTTP/1.0\r\n\r\n", r10);
+  check(!r10.keep_alive, "HTTP/1.0 closes by default");
+
+  // malformed
+  check(error_of("GET / HTTP/1.1\r\nNoColon\r\n\r\n") == 400, "header without colon");
+  check(error_of("GET / HTTP/1.1\r\nBad Name: x\r\n\r\n") == 400, "space in header name");
+  check(error_of("GET / HTTP/1.1\r\nHost : x\r\n\r\n") == 400, "space before colon");
+  check(error_of("GET / HTTP/1.1\r\n folded\r\n\r\n") == 400, "obsolete line folding");
+  check(error_of("GET / HTTP/2.0\r\n\r\n") == 400, "bad version");
+  check(error_of("GET  HTTP/1.1\r\n\r\n") == 400, "empty target");
+  check(error_of("G(T / HTTP/1.1\r\n\r\n") == 400, "bad method");
+  check(error_of("POST / HTTP/1.1\r\nContent-Length: 12x\r\n\r\n") == 400, "bad Content-Length");
+  check(error_of("POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n") == 400, "conflicting lengths");
+  check(error_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n") == 501, "chunked body");
+
+  // limits
+  ws::parser_limits small{};
+  small.max_request_line = 32;
+  small.max_header_bytes = 256;
+  small.max_headers = 4;
+  small.max_body = 16;
+  check(error_of("GET /" + std::string(64, 'a') + " HTTP/1.1\r\n\r\n", small) == 414, "request line too long");
+  check(error_of("GET /" + std::string(64, 'a'), small) == 414, "request line too long, incomplete");
+  check(error_of("GET / HTTP/1.1\r\nA: 1\r\nB: 2\r\nC: 3\r\nD: 4\r\nE: 5\r\n\r\n", small) == 431, "too many headers");
+  check(error_of("GET / HTTP/1.1\r\nA: " + std::string(300, 'x'), small) == 431, "header section too large");
+  check(error_of("POST / HTTP/1.1\r\nContent-Length: 17\r\n\r\n", small) == 413, "body too large");
+}
+
+void bench_parser() {
+  // a pipelined batch, like one big read from a load balancer
+  std::string batch;
+  for (int i = 0; i < 64; ++i) {
+    batch += typical;
+  }
+  constexpr int ROUNDS = 5000;
+  ws::http_parser parser;
+  ws::request req;
+  std::size_t parsed{0};
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; ++r) {
+    std::string_view rest{batch};
+    while (!rest.empty() && parser.parse(rest, req) == ws::parse_status::complete) {
+      rest.remove_prefix(parser.get_consumed());
+      parser.reset();
+      ++parsed;
+    }
+  }
+  auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("{:<8} {:>10.2f} M req/s {:>8.2f} GB/s\n", ws::scan::isa_name(ws::scan::current_isa()),
+             static_cast<double>(parsed) / secs / 1e6, static_cast<double>(batch.size()) * ROUNDS / secs / 1e9);
+  check(parsed == 64u * ROUNDS, "benchmark parsed every request");
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  fmt::print("best scanner: {}\n", ws::scan::isa_name(ws::scan::best_isa()));
+  DividingLine(Start Tests !);
+  for (auto level : {ws::scan::isa::scalar, ws::scan::isa::sse42, ws::scan::isa::avx2}) {
+    ws::scan::use_isa(level);
+    test::context = std::string{ws::scan::isa_name(ws::scan::current_isa())};
+    DividingLine(test_correctness);
+    test::test_correctness();
+  }
+  test::context.clear();
+
+  DividingLine(bench_parser);
+  for (auto level : {ws::scan::isa::scalar, ws::scan::isa::sse42, ws::scan::isa::avx2}) {
+    ws::scan::use_isa(level);
+    test::bench_parser();
+  }
+  return test::failures;
+}
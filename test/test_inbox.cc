@@ -0,0 +1,259 @@
+/** @file    test_inbox.cc
+ *  @time    2026/10/21 ~ 下午8:00
+ *  @author  Leon
+ *
+ *  @note    ws::inbox: order per producer, coalesced doorbells, sockets nobody took; the single acceptor on both
+ *           backends, pool results back on the loop's thread; messages per second against a mutex-guarded vector
+ *
+ */
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/inbox.h>
+#include <webserver/reactor.h>
+#include <threadpool/dynamic_pool.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace test {
+
+using namespace std::chrono_literals;
+
+void test_order_and_doorbell() {
+  constexpr int NUM_THREADS{4};
+  constexpr int PER_THREAD{10000};
+  ws::inbox in{};
+  std::vector<std::thread> threads{};
+  std::vector<std::vector<int>> seen(NUM_THREADS);  // only touched by run(), on this thread
+  for (int t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < PER_THREAD; ++i) {
+        in.post([&seen, t, i] { seen[t].push_back(i); });
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  std::uint64_t value{0};
+  check(::read(in.get_fd(), &value, sizeof(value)) == sizeof(value) && value == 1 && in.get_num_rings() == 1,
+        "one doorbell for 40000 messages nobody took yet");
+  check(in.run([](int) {}) == NUM_THREADS * PER_THREAD, "all delivered");
+  bool ordered{true};
+  for (const auto& s : seen) {
+    for (int i = 0; i < PER_THREAD; ++i) {
+      ordered = ordered && static_cast<int>(s.size()) == PER_THREAD && s[i] == i;
+    }
+  }
+  check(ordered, "each producer's messages in order");
+  check(::read(in.get_fd(), &value, sizeof(value)) < 0 && in.run([](int) {}) == 0, "quiet once taken");
+  in.post([] {});
+  check(in.get_num_rings() == 2, "the next message rings again");
+}
+
+void test_fds() {
+  int kept[2];
+  int orphan[2];
+  check(::pipe(kept) == 0 && ::pipe(orphan) == 0, "pipes");
+  {
+    ws::inbox in{};
+    in.post_fd(kept[0]);
+    int got{-1};
+    in.run([&](int fd) { got = fd; });
+    check(got == kept[0], "a socket handed over");
+    in.post_fd(orphan[0]);
+  }
+  check(::fcntl(kept[0], F_GETFD) >= 0, "a taken fd belongs to the taker");
+  check(::fcntl(orphan[0], F_GETFD) < 0, "an fd nobody took is closed with the inbox");
+  for (int fd : {kept[0], kept[1], orphan[1]}) {
+    ::close(fd);
+  }
+}
+
+// connections spread over every reactor by the acceptor thread
+void single_acceptor(ws::backend backend) {
+  constexpr std::size_t NUM_REACTORS{4};
+  std::mutex mtx{};
+  std::set<std::thread::id> threads{};
+  ws::handler who = [&](const ws::request&, ws::response& resp) {
+    std::lock_guard<std::mutex> lck{mtx};
+    threads.insert(std::this_thread::get_id());
+    resp.body = "hi";
+  };
+  ws::server_config config{"127.0.0.1", 0, NUM_REACTORS};
+  config.backend = backend;
+  config.single_acceptor = true;
+  ws::server srv{config, who};
+  try {
+    srv.start();
+  } catch (const std::system_error& e) {
+    fmt::print("backend unavailable ({}): skipped\n", e.what());
+    return;
+  }
+  bool ok{true};
+  http_response resp;
+  for (int round = 0; round < 2; ++round) {
+    std::vector<std::unique_ptr<http_client>> clients{};
+    for (std::size_t i = 0; i < 2 * NUM_REACTORS; ++i) {
+      clients.push_back(std::make_unique<http_client>(srv.get_port()));
+    }
+    for (auto& c : clients) {
+      ok = ok && c->send_all("GET / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\n") && c->read_response(resp) &&
+           resp.body == "hi" && c->read_response(resp) && resp.body == "hi";
+    }
+  }
+  check(ok, "served through the acceptor");
+  check(threads.size() == NUM_REACTORS, "round-robin over every reactor");
+  check(srv.get_num_requests() == 2 * 2 * 2 * NUM_REACTORS, "every request counted");
+  http_client last{srv.get_port()};
+  last.send_all("GET / HTTP/1.1\r\n\r\n");
+  last.read_response(resp);
+  srv.stop();
+  check(last.closed_by_peer(), "connections closed on stop");
+}
+
+void test_single_acceptor() {
+  single_acceptor(ws::backend::libevent);
+#ifdef WITH_IO_URING
+  single_acceptor(ws::backend::io_uring);
+#endif
+}
+
+void test_pool_results() {
+  ws::buffer_pool buffers{};
+  ws::handler none = [](const ws::request&, ws::response&) {};
+  ws::reactor loop{0, -1, none, buffers};
+  loop.start();
+  std::promise<std::thread::id> loop_id{};
+  loop.post([&] { loop_id.set_value(std::this_thread::get_id()); });
+  auto loop_thread = loop_id.get_future().get();
+
+  tp::DynamicThreadPool pool{2};
+  std::promise<std::pair<std::thread::id, std::thread::id>> ids{};
+  ws::run_then(pool, loop, [] { return std::this_thread::get_id(); },
+               [&](std::thread::id worker) { ids.set_value({worker, std::this_thread::get_id()}); });
+  auto [worker, done] = ids.get_future().get();
+  check(worker != loop_thread && worker != std::this_thread::get_id(), "the work on a pool thread");
+  check(done == loop_thread, "its result on the loop's thread");
+
+  std::promise<void> finished{};
+  ws::run_then(pool, loop, [] {}, [&] { finished.set_value(); });
+  check(finished.get_future().wait_for(5s) == std::future_status::ready, "void work");
+  loop.stop();
+  loop.join();
+}
+
+// the design it replaced, for comparison
+class locked_inbox {
+ private:
+  std::mutex mtx{};
+  std::vector<std::function<void()>> fns{};
+  int bell{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+
+ public:
+  ~locked_inbox() { ::close(bell); }
+
+  void post(std::function<void()> fn) {
+    bool was_empty;
+    {
+      std::lock_guard<std::mutex> lck{mtx};
+      was_empty = fns.empty();
+      fns.push_back(std::move(fn));
+    }
+    if (was_empty) {
+      std::uint64_t one{1};
+      [[maybe_unused]] auto n = ::write(bell, &one, sizeof(one));
+    }
+  }
+
+  std::size_t run() {
+    std::vector<std::function<void()>> batch{};
+    {
+      std::lock_guard<std::mutex> lck{mtx};
+      batch.swap(fns);
+    }
+    for (auto& fn : batch) {
+      fn();
+    }
+    return batch.size();
+  }
+};
+
+constexpr int NUM_THREADS{2};
+constexpr int PER_THREAD{500000};
+
+// producers post while a consumer drains: messages per second
+template <typename Inbox, typename Run>
+double pump(Inbox& in, Run run) {
+  std::atomic<bool> done{false};
+  std::size_t consumed{0};
+  auto start = std::chrono::steady_clock::now();
+  std::thread consumer{[&] {
+    while (!done.load(std::memory_order_acquire) || consumed < NUM_THREADS * PER_THREAD) {
+      auto n = run(in);
+      consumed += n;
+      if (n == 0) {
+        std::this_thread::yield();
+      }
+    }
+  }};
+  std::vector<std::thread> producers{};
+  for (int t = 0; t < NUM_THREADS; ++t) {
+    producers.emplace_back([&] {
+      for (int i = 0; i < PER_THREAD; ++i) {
+        in.post([] {});
+      }
+    });
+  }
+  for (auto& p : producers) {
+    p.join();
+  }
+  done.store(true, std::memory_order_release);
+  consumer.join();
+  return NUM_THREADS * PER_THREAD / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void bench_messages() {
+  locked_inbox locked{};
+  auto with_lock = pump(locked, [](locked_inbox& in) { return in.run(); });
+  ws::inbox lock_free{};
+  auto without = pump(lock_free, [](ws::inbox& in) { return in.run([](int fd) { ::close(fd); }); });
+  fmt::print("messages per second: mutex + vector {:>10.0f}, ws::inbox {:>10.0f}; {} doorbells for {} messages\n",
+             with_lock, without, lock_free.get_num_rings(), NUM_THREADS * PER_THREAD);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_order_and_doorbell);
+  test::test_order_and_doorbell();
+
+  DividingLine(test_fds);
+  test::test_fds();
+
+  DividingLine(test_single_acceptor);
+  test::test_single_acceptor();
+
+  DividingLine(test_pool_results);
+  test::test_pool_results();
+
+  DividingLine(bench_messages);
+  test::bench_messages();
+  return test::failures;
+}
@@ -0,0 +1,239 @@
+/** @file    test_logger.cc
+ *  @time    2026/10/21 ~ 下午2:00
+ *  @author  Leon
+ *
+ *  @note    utils::logger: argument encoding, per-thread order, drop / block when full, the compile-time level filter;
+ *           cost per call against fmt::print, and access logging on a server at full speed
+ *
+ */
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <thread>
+#include <utils/logger.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <webserver/server.h>
+#include <webserver/access_log.h>
+#include <http_client.h>
+#include <check.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace test {
+
+using namespace std::chrono_literals;
+namespace fs = std::filesystem;
+
+struct point {
+  int x;
+  int y;
+};
+
+fs::path log_path(std::string_view name) { return fs::temp_directory_path() / fmt::format("ws_{}_{}.log", name, ::getpid()); }
+
+std::vector<std::string> read_lines(const fs::path& path) {
+  std::ifstream in{path};
+  std::vector<std::string> lines{};
+  for (std::string line; std::getline(in, line);) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+// the message: what follows "<date> <time> <level> [tid] "
+std::string_view message(std::string_view line) {
+  auto bracket = line.find("] ");
+  return bracket == std::string_view::npos ? std::string_view{} : line.substr(bracket + 2);
+}
+
+}  // namespace test
+
+template <>
+struct fmt::formatter<test::point> : fmt::formatter<std::string_view> {
+  template <typename Context>
+  auto format(const test::point& p, Context& ctx) const {
+    return fmt::format_to(ctx.out(), "({}, {})", p.x, p.y);
+  }
+};
+
+namespace test {
+
+void test_records() {
+  auto path = log_path("records");
+  check(utils::logger::start({path.string()}), "started");
+  std::string owned{"owned string"};
+  std::string_view view{"a view"};
+  int local{42};
+  LOG_INFO("int {} double {:.2f} char {} bool {}", -7, 3.14159, 'c', true);
+  LOG_WARN("{} / {} / {}", owned, view, "literal");
+  LOG_ERROR("hex {:#x}, unsigned {}, pointer {}", 255, 18446744073709551615ULL, static_cast<const void*>(&local));
+  LOG_INFO("a type with a formatter: {}", point{1, 2});
+  LOG_INFO("no arguments");
+  owned = "changed after the call";
+  int evaluated{0};
+  LOG_DEBUG("below the compiled level {}", ++evaluated);
+  LOG_TRACE("below the compiled level {}", ++evaluated);
+  utils::logger::stop();
+  LOG_INFO("after stop");
+
+  auto lines = read_lines(path);
+  check(lines.size() == 5, "5 lines");
+  if (lines.size() == 5) {
+    check(message(lines[0]) == "int -7 double 3.14 char c bool true", "arithmetic arguments");
+    check(message(lines[1]) == "owned string / a view / literal", "strings are copied at the call");
+    check(message(lines[2]).rfind("hex 0xff, unsigned 18446744073709551615, pointer 0x", 0) == 0, "specs, pointer");
+    check(message(lines[3]) == "a type with a formatter: (1, 2)", "formatted on the caller");
+    check(message(lines[4]) == "no arguments", "no arguments");
+    check(lines[0].find(" INFO  [") == 26 && lines[1].find(" WARN  [") == 26 && lines[2].find(" ERROR [") == 26,
+          "timestamp and level");
+  }
+  check(evaluated == 0, "filtered levels do not evaluate their arguments");
+  fs::remove(path);
+}
+
+void test_threads() {
+  constexpr int NUM_THREADS{4};
+  constexpr int PER_THREAD{50000};
+  auto path = log_path("threads");
+  utils::logger::start({path.string(), utils::logger::overflow::block, 16 * 1024});
+  std::vector<std::thread> threads{};
+  for (int t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < PER_THREAD; ++i) {
+        LOG_INFO("thread {} record {} {}", t, i, "padding to make the records wrap the small rings often");
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  utils::logger::flush();
+  auto dropped = utils::logger::get_dropped();
+  utils::logger::stop();
+
+  std::vector<int> next(NUM_THREADS, 0);
+  bool ordered{true};
+  auto lines = read_lines(path);
+  for (const auto& line : lines) {
+    int t{-1};
+    int i{-1};
+    std::sscanf(std::string{message(line)}.c_str(), "thread %d record %d", &t, &i);
+    ordered = ordered && t >= 0 && t < NUM_THREADS && next[t] == i;
+    if (t >= 0 && t < NUM_THREADS) {
+      ++next[t];
+    }
+  }
+  check(dropped == 0 && lines.size() == NUM_THREADS * PER_THREAD, "block: nothing lost");
+  check(ordered, "each thread's records in order");
+  fs::remove(path);
+}
+
+void test_drop() {
+  constexpr int N{100000};
+  auto path = log_path("drop");
+  utils::logger::start({path.string(), utils::logger::overflow::drop, 4096, 50ms});
+  for (int i = 0; i < N; ++i) {
+    LOG_INFO("burst {}", i);
+  }
+  utils::logger::flush();
+  auto dropped = utils::logger::get_dropped();
+  utils::logger::stop();
+  auto lines = read_lines(path);
+  fmt::print("burst of {} into a 4 KB ring: {} written, {} dropped\n", N, lines.size(), dropped);
+  check(dropped > 0 && lines.size() + dropped == N, "drop: every record written or counted");
+  fs::remove(path);
+}
+
+// ns per call: LOG_INFO into the ring vs fmt::print to a file
+void bench_calls() {
+  constexpr int N{1'000'000};
+  auto path = log_path("bench");
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    fmt::print(file, "{} {} {} {}\n", "GET", "/index.html", 200, i);
+  }
+  auto printed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / N;
+  std::fclose(file);
+  fs::remove(path);
+
+  // a ring large enough for the whole run and a writer that waits for stop(): the cost on the calling thread only,
+  // the formatting belongs to another core
+  utils::logger::start({path.string(), utils::logger::overflow::block, 128 << 20, 1h});
+  LOG_INFO("the first record allocates the thread's ring");
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    LOG_INFO("{} {} {} {}", "GET", "/index.html", 200, i);
+  }
+  auto logged = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / N;
+  utils::logger::stop();
+  check(read_lines(path).size() == N + 1, "every benchmark record written");
+  fs::remove(path);
+  fmt::print("per call: fmt::print to a file {:>6.1f} ns, LOG_INFO {:>6.1f} ns\n", printed, logged);
+}
+
+// pipelined requests per second with and without an access log line per request
+double serve(bool logged) {
+  ws::handler hello = [](const ws::request&, ws::response& resp) { resp.body = "Hello, World!"; };
+  ws::server srv{{"127.0.0.1", 0, 1}, logged ? ws::handler{ws::access_log{hello}} : hello};
+  srv.start();
+  std::string batch{};
+  for (int i = 0; i < 32; ++i) {
+    batch += "GET /hello?name=world HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  }
+  http_client client{srv.get_port()};
+  http_response resp;
+  std::size_t n{0};
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < 1s && client.send_all(batch)) {
+    for (int i = 0; i < 32 && client.read_response(resp); ++i) {
+      ++n;
+    }
+  }
+  return static_cast<double>(n) / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void bench_access_log() {
+  auto path = log_path("access");
+  auto plain = serve(false);
+  utils::logger::start({path.string()});
+  auto logged = serve(true);
+  utils::logger::flush();
+  auto dropped = utils::logger::get_dropped();
+  utils::logger::stop();
+  auto lines = read_lines(path);
+  check(!lines.empty() && message(lines.front()) == "GET /hello?name=world 200 13", "access log line");
+  fmt::print("without access log {:>10.0f} req/s\nwith access log    {:>10.0f} req/s ({:+.1f}%), {} lines, {} dropped\n",
+             plain, logged, (logged / plain - 1) * 100, lines.size(), dropped);
+  fs::remove(path);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_records);
+  test::test_records();
+
+  DividingLine(test_threads);
+  test::test_threads();
+
+  DividingLine(test_drop);
+  test::test_drop();
+
+  DividingLine(bench_calls);
+  test::bench_calls();
+
+  DividingLine(bench_access_log);
+  test::bench_access_log();
+  return test::failures;
+}
@@ -0,0 +1,85 @@
+/** @file    test_placement.cc
+ *  @time    2026/10/18 ~ 下午7:00
+ *  @author  Leon
+ *
+ *  @note    Scaling of the SteadyThreadPool placement strategies from 4 to 64 workers
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <threadpool/steady_pool.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <vector>
+#include <future>
+#include <complex>
+#include <chrono>
+
+namespace test {
+
+constexpr std::size_t TEST_TASK_NUM = 50000;
+
+float do_math(float a, float b) {
+  return std::cos(std::sin(a)) + std::sin(std::cos(b));
+}
+
+// ns per submitted task, from the first submit until all tasks are done
+template <typename Placement>
+double bench(std::size_t num_workers) {
+  tp::BasicSteadyThreadPool<Placement> pool{num_workers};
+  std::vector<std::future<float>> futures;
+  futures.reserve(TEST_TASK_NUM);
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < TEST_TASK_NUM; ++i) {
+    futures.emplace_back(pool.submit_task(do_math, 3.14F, 2.71F));
+  }
+  pool.wait_for_tasks();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / TEST_TASK_NUM;
+}
+
+void test_scaling_curves() {
+  fmt::print("{:>8} {:>12} {:>12} {:>12} {:>16}   (ns per task)\n", "workers", "least_busy", "two_choices",
+             "round_robin", "sticky_producer");
+  for (std::size_t n : {4, 8, 16, 32, 64}) {
+    fmt::print("{:>8} {:>12.1f} {:>12.1f} {:>12.1f} {:>16.1f}\n", n, bench<tp::least_busy>(n), bench<tp::two_choices>(n),
+               bench<tp::round_robin>(n), bench<tp::sticky_producer>(n));
+  }
+}
+
+// the cost of the placement decision alone, with every worker equally idle (the worst case for least_busy's scan)
+template <typename Placement>
+double placement_cost(std::size_t num_workers) {
+  std::vector<std::size_t> loads(num_workers, 0);
+  Placement placement{num_workers};
+  std::size_t sink{0};
+  constexpr std::size_t rounds{1000000};
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < rounds; ++i) {
+    sink += placement.pick(num_workers, [&loads](std::size_t w) { return loads[w] + 1; });
+  }
+  auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds;
+  return sink == static_cast<std::size_t>(-1) ? 0 : ns;  // keep `sink` alive
+}
+
+void test_placement_cost() {
+  fmt::print("{:>8} {:>12} {:>12} {:>12} {:>16}   (ns per pick)\n", "workers", "least_busy", "two_choices",
+             "round_robin", "sticky_producer");
+  for (std::size_t n : {4, 8, 16, 32, 64}) {
+    fmt::print("{:>8} {:>12.2f} {:>12.2f} {:>12.2f} {:>16.2f}\n", n, placement_cost<tp::least_busy>(n),
+               placement_cost<tp::two_choices>(n), placement_cost<tp::round_robin>(n),
+               placement_cost<tp::sticky_producer>(n));
+  }
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_placement_cost);
+  test::test_placement_cost();
+
+  DividingLine(test_scaling_curves);
+  test::test_scaling_curves();
+}
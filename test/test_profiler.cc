@@ -0,0 +1,141 @@
+/** @file    test_profiler.cc
+ *  @time    2026/10/18 ~ 下午9:50
+ *  @author  Leon
+ *
+ *  @note    Overhead of PROFILE_SCOPE (disabled / enabled) vs TIC/TOK, per-label report and Chrome trace dump
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <utils/profiler.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <check.h>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <filesystem>
+
+namespace test {
+
+constexpr std::size_t NUM_SCOPES = 1000000;
+
+volatile std::uint64_t sink{0};
+
+// ns per iteration of a loop doing a tiny bit of work in a scope
+template <typename Body>
+double ns_per_scope(Body&& body) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < NUM_SCOPES; ++i) {
+    body(i);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_SCOPES;
+}
+
+void test_overhead() {
+  auto bare = ns_per_scope([](std::size_t i) { sink = sink + i; });
+  auto steady = ns_per_scope([](std::size_t i) {
+    auto t0 = std::chrono::steady_clock::now();
+    sink = sink + i;
+    sink = sink + static_cast<std::uint64_t>((std::chrono::steady_clock::now() - t0).count());
+  });
+
+  utils::profiler::enable(false);
+  auto disabled = ns_per_scope([](std::size_t i) {
+    PROFILE_SCOPE("overhead.disabled");
+    sink = sink + i;
+  });
+
+  utils::profiler::enable(true);
+  auto enabled = ns_per_scope([](std::size_t i) {
+    PROFILE_SCOPE("overhead.enabled");
+    sink = sink + i;
+  });
+  utils::profiler::enable(false);
+
+  fmt::print("bare loop        {:>6.1f} ns/iter\n", bare);
+  fmt::print("2x steady_clock  {:>6.1f} ns/iter\n", steady);
+  fmt::print("scope, disabled  {:>6.1f} ns/iter\n", disabled);
+  fmt::print("scope, enabled   {:>6.1f} ns/iter\n", enabled);
+  fmt::print("ns per tick: {:.4f}\n", utils::profiler::ns_per_tick());
+}
+
+void test_report() {
+  utils::profiler::reset();
+  utils::profiler::enable(true);
+  constexpr std::size_t NUM_THREADS = 4;
+  constexpr std::size_t ROUNDS = 200;
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([] {
+      for (std::size_t i = 0; i < ROUNDS; ++i) {
+        PROFILE_SCOPE("request");
+        {
+          PROFILE_SCOPE("parse");
+          std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+        {
+          PROFILE_SCOPE("handle");
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  utils::profiler::enable(false);
+  utils::profiler::print_report();
+
+  auto stats = utils::profiler::report();  // the threads exited, their data is still there
+#ifdef WITH_PROFILER
+  check(stats.size() == 3, "three labels");
+  for (const auto& s : stats) {
+    check(s.count == NUM_THREADS * ROUNDS, "every scope counted");
+    check(s.min_ns <= s.p50_ns && s.p99_ns <= 2 * s.max_ns, "quantiles within bounds");
+  }
+  check(!stats.empty() && stats.front().label == "request", "the outer scope has the largest total");
+#else
+  check(stats.empty(), "compiled out");
+#endif
+
+  auto path = (std::filesystem::temp_directory_path() / "test_profiler_trace.json").string();
+  check(utils::profiler::dump_chrome_trace(path), "trace written");
+  fmt::print("trace: {} ({} bytes)\n", path, std::filesystem::file_size(path));
+  std::remove(path.c_str());
+}
+
+// short-lived threads (a dynamic pool, compensating threads): their rings are freed, their aggregates kept
+void test_thread_churn() {
+  utils::profiler::reset();
+  utils::profiler::enable(true);
+  auto before = utils::profiler::get_num_threads();
+  constexpr std::size_t NUM_THREADS = 200;
+  for (std::size_t t = 0; t < NUM_THREADS; ++t) {
+    std::thread{[] { utils::profiler::scoped_timer timer{"churn"}; }}.join();
+  }
+  utils::profiler::enable(false);
+  check(utils::profiler::get_num_threads() == before, "no ring left behind by exited threads");
+  auto stats = utils::profiler::report();
+  auto it = std::find_if(stats.begin(), stats.end(), [](const auto& s) { return s.label == "churn"; });
+  check(it != stats.end() && it->count == NUM_THREADS, "their scopes still reported");
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_overhead);
+  test::test_overhead();
+
+  DividingLine(test_report);
+  test::test_report();
+
+  DividingLine(test_thread_churn);
+  test::test_thread_churn();
+  return test::failures;
+}
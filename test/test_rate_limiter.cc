@@ -0,0 +1,187 @@
+/** @file    test_rate_limiter.cc
+ *  @time    2026/10/22 ~ 下午4:00
+ *  @author  Leon
+ *
+ *  @note    ws::rate_limiter: per-client and per-route buckets, lazy refill, sweeping (survivors still found after
+ *           backward shifts), failing open when full; 429 before the body on both backends; the cost of an admit
+ *
+ */
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/rate_limiter.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace test {
+
+using namespace std::chrono_literals;
+
+ws::net::ip_address ip(std::uint32_t n) {
+  ws::net::ip_address a{};
+  a[10] = a[11] = 0xff;
+  a[12] = static_cast<std::uint8_t>(n >> 24);
+  a[13] = static_cast<std::uint8_t>(n >> 16);
+  a[14] = static_cast<std::uint8_t>(n >> 8);
+  a[15] = static_cast<std::uint8_t>(n);
+  return a;
+}
+
+void test_buckets() {
+  ws::rate_limiter limiter{{{10, 3}, {{"/login", {0.5, 1}}}}};
+  bool burst{true};
+  for (int i = 0; i < 3; ++i) {
+    burst = burst && limiter.admit(ip(1), "/") == 0;
+  }
+  check(burst, "a burst is admitted");
+  check(limiter.admit(ip(1), "/") == 1, "then refused, for about a second");
+  check(limiter.admit(ip(2), "/") == 0, "another client has its own bucket");
+
+  check(limiter.admit(ip(3), "/login") == 0, "a limited route");
+  check(limiter.admit(ip(3), "/login/again") == 2, "refused by the route's bucket, which is slower");
+  check(limiter.admit(ip(3), "/index.html") == 0, "the client's other routes are not");
+  check(limiter.get_num_limited() == 2 && limiter.get_num_buckets() == 4, "counted");
+
+  ws::rate_limiter routes_only{{{}, {{"/api", {1, 1}}}}};
+  check(routes_only.admit(ip(1), "/") == 0 && routes_only.admit(ip(1), "/") == 0 &&
+            routes_only.get_num_buckets() == 0,
+        "no bucket where no limit applies");
+}
+
+void test_refill() {
+  ws::rate_limiter limiter{{{100, 1}}};
+  check(limiter.admit(ip(1), "/") == 0 && limiter.admit(ip(1), "/") != 0, "empty");
+  std::this_thread::sleep_for(30ms);
+  check(limiter.admit(ip(1), "/") == 0, "refilled on the next look");
+  check(limiter.admit(ip(1), "/") != 0, "by one token only");
+}
+
+void test_sweep() {
+  ws::rate_limit_config config{{1000, 1}, {{"/slow", {0.01, 1}}}};
+  config.num_shards = 1;
+  config.max_buckets = 256;
+  ws::rate_limiter limiter{config};
+  for (std::uint32_t i = 0; i < 100; ++i) {
+    limiter.admit(ip(i), i % 2 == 0 ? "/slow" : "/");
+  }
+  check(limiter.get_num_buckets() == 150, "a client bucket each, a route bucket for half");
+  std::this_thread::sleep_for(30ms);
+  check(limiter.sweep() == 100 && limiter.get_num_buckets() == 50, "the refilled ones dropped");
+  bool still_empty{true};
+  for (std::uint32_t i = 0; i < 100; i += 2) {
+    still_empty = still_empty && limiter.admit(ip(i), "/slow") != 0;
+  }
+  check(still_empty, "the others are still found, not recreated full");
+  check(limiter.get_num_buckets() == 100, "... beside new client buckets");
+}
+
+void test_full() {
+  ws::rate_limit_config config{{0.01, 1}};
+  config.num_shards = 1;
+  config.max_buckets = 4;
+  ws::rate_limiter limiter{config};
+  for (std::uint32_t i = 0; i < 4; ++i) {
+    limiter.admit(ip(i), "/");
+  }
+  check(limiter.admit(ip(0), "/") != 0, "limited");
+  check(limiter.admit(ip(9), "/") == 0 && limiter.admit(ip(9), "/") == 0 && limiter.get_num_buckets() == 4,
+        "a client beyond the table's size is not");
+}
+
+void limited_server(ws::backend backend) {
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.backend = backend;
+  config.rate_limits.routes = {{"/limited", {1, 2}}};
+  std::atomic<std::size_t> handled{0};
+  ws::server srv{config, [&](const ws::request& req, ws::response& resp) {
+                   ++handled;
+                   resp.body = std::string{req.path};
+                 }};
+  try {
+    srv.start();
+  } catch (const std::system_error& e) {
+    fmt::print("backend unavailable ({}): skipped\n", e.what());
+    return;
+  }
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /limited?a HTTP/1.1\r\n\r\nGET /limited?b HTTP/1.1\r\n\r\nGET /free HTTP/1.1\r\n\r\n") &&
+            client.read_response(resp) && resp.status == 200 && client.read_response(resp) && resp.status == 200 &&
+            client.read_response(resp) && resp.body == "/free",
+        "within the burst");
+  check(client.send_all("GET /limited HTTP/1.1\r\n\r\nGET /free HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+            resp.status == 429 && resp.header("Retry-After") == "1" && resp.header("Connection") == "close" &&
+            client.closed_by_peer(),
+        "429, then closed: what was pipelined behind it is dropped");
+
+  // refused on its head: the megabyte of body is never waited for
+  http_client upload{srv.get_port()};
+  check(upload.send_all("POST /limited/upload HTTP/1.1\r\nContent-Length: 1000000\r\n\r\n") &&
+            upload.read_response(resp) && resp.status == 429,
+        "429 before the body");
+  check(handled.load() == 3 && srv.get_num_limited() == 2, "the handler never saw them");
+
+  http_client other{srv.get_port()};
+  check(other.send_all("GET /free HTTP/1.1\r\n\r\n") && other.read_response(resp) && resp.status == 200,
+        "the client's other routes go on");
+}
+
+void test_server() {
+  limited_server(ws::backend::libevent);
+#ifdef WITH_IO_URING
+  limited_server(ws::backend::io_uring);
+#endif
+}
+
+void bench_admit() {
+  constexpr std::uint32_t NUM_CLIENTS{10000};
+  constexpr int ROUNDS{100};
+  ws::rate_limiter limiter{{{1e9, 1e9}, {{"/api", {1e9, 1e9}}}}};
+  std::vector<ws::net::ip_address> ips{};
+  for (std::uint32_t i = 0; i < NUM_CLIENTS; ++i) {
+    ips.push_back(ip(i * 2654435761U));
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::size_t refused{0};
+  for (int r = 0; r < ROUNDS; ++r) {
+    for (const auto& a : ips) {
+      refused += limiter.admit(a, (r & 1) != 0 ? "/api/x" : "/") != 0;
+    }
+  }
+  auto took = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("admit over {} clients: {:.0f} ns each ({} buckets, {} refused)\n", NUM_CLIENTS,
+             took / (NUM_CLIENTS * ROUNDS), limiter.get_num_buckets(), refused);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_buckets);
+  test::test_buckets();
+
+  DividingLine(test_refill);
+  test::test_refill();
+
+  DividingLine(test_sweep);
+  test::test_sweep();
+
+  DividingLine(test_full);
+  test::test_full();
+
+  DividingLine(test_server);
+  test::test_server();
+
+  DividingLine(bench_admit);
+  test::bench_admit();
+  return test::failures;
+}
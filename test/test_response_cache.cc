@@ -0,0 +1,229 @@
+/** @file    test_response_cache.cc
+ *  @time    2026/10/19 ~ 下午10:50
+ *  @author  Leon
+ *
+ *  @note    ws::response_cache (rendering, ETags, CLOCK eviction, expiry) and caching_handler (hits, 304, HEAD, files);
+ *           throughput with and without the cache
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/static_files.h>
+#include <webserver/response_cache.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <string>
+#include <chrono>
+#include <unistd.h>
+
+namespace test {
+
+using namespace std::chrono_literals;
+namespace fs = std::filesystem;
+
+ws::response make_response(std::string body) {
+  ws::response resp{};
+  resp.body = std::move(body);
+  return resp;
+}
+
+void test_cache() {
+  ws::response_cache cache{{1024 * 1024, 64 * 1024, 4, 200ms}};
+  check(cache.lookup("/a") == nullptr, "empty");
+  auto a = cache.insert("/a", make_response("hello"));
+  check(a != nullptr && cache.lookup("/a") == a, "hit after insert");
+  check(a->etag.size() == 18 && a->etag.front() == '"' && a->etag.back() == '"', "strong ETag");
+  const auto& full = a->full.bytes;
+  check(full.rfind("HTTP/1.1 200 OK\r\n", 0) == 0 && full.find("ETag: " + a->etag + "\r\n") != std::string::npos,
+        "rendered head with the ETag");
+  check(full.substr(a->full.head_size, a->full.body_offset - a->full.head_size) == "Connection: keep-alive\r\n\r\n" &&
+            full.substr(a->full.body_offset) == "hello",
+        "Connection header and body at their offsets");
+  const auto& nm = a->not_modified.bytes;
+  check(nm.rfind("HTTP/1.1 304 Not Modified\r\n", 0) == 0 && nm.find(a->etag) != std::string::npos &&
+            a->not_modified.body_offset == nm.size() && nm.find("Content-Length") == std::string::npos,
+        "304 without a body");
+  check(cache.insert("/b", make_response("hello"))->etag == a->etag, "same body, same ETag");
+  check(cache.insert("/c", make_response("hellp"))->etag != a->etag, "different body, different ETag");
+
+  auto own = make_response("x");
+  own.headers.emplace_back("ETag", "\"v1\"");
+  own.headers.emplace_back("Cache-Control", "max-age=60");
+  auto o = cache.insert("/own", own);
+  check(o->etag == "\"v1\"" && o->full.bytes.find("ETag") == o->full.bytes.rfind("ETag"), "the handler's ETag is kept");
+  check(o->not_modified.bytes.find("Cache-Control: max-age=60\r\n") != std::string::npos, "304 repeats Cache-Control");
+
+  auto missing = make_response("no");
+  missing.status = 404;
+  auto cookie = make_response("c");
+  cookie.headers.emplace_back("Set-Cookie", "id=1");
+  auto no_store = make_response("n");
+  no_store.headers.emplace_back("Cache-Control", "no-store");
+  check(cache.insert("/404", missing) == nullptr && cache.insert("/cookie", cookie) == nullptr &&
+            cache.insert("/no-store", no_store) == nullptr && cache.insert("/big", make_response(std::string(65 * 1024, 'x'))) == nullptr,
+        "not cacheable");
+  check(cache.lookup("/404") == nullptr, "nothing stored for them");
+
+  cache.erase("/a");
+  check(cache.lookup("/a") == nullptr && a->full.bytes.substr(a->full.body_offset) == "hello",
+        "erased, the entry held outside stays valid");
+  std::this_thread::sleep_for(250ms);
+  check(cache.lookup("/b") == nullptr, "expired after max_age");
+  cache.clear();
+  check(cache.get_num_entries() == 0 && cache.get_bytes() == 0, "cleared");
+}
+
+void test_eviction() {
+  // one shard, room for about 8 entries of 1 KB
+  ws::response_cache cache{{9 * 1024 + 512, 4096, 1, 10s}};
+  std::string body(600, 'e');  // plus about 500 bytes of head and bookkeeping
+  for (int i = 0; i < 8; ++i) {
+    cache.insert(fmt::format("/{}", i), make_response(body));
+  }
+  auto entries = cache.get_num_entries();
+  for (int round = 0; round < 40; ++round) {
+    cache.lookup("/0");  // hot
+    cache.insert(fmt::format("/cold{}", round), make_response(body));
+  }
+  check(cache.get_bytes() <= 9 * 1024 + 512, "within the byte budget");
+  check(cache.get_num_entries() == entries, "steady entry count");
+  check(cache.lookup("/0") != nullptr, "a referenced entry survives the sweeps");
+  check(cache.lookup("/1") == nullptr, "cold entries are evicted");
+  check(cache.insert("/huge", make_response(std::string(4000, 'h'))) != nullptr && cache.get_bytes() <= 9 * 1024 + 512,
+        "still within budget with a large entry");
+
+  check(ws::etag_matches("\"a\", W/\"b\" ,\"c\"", "\"b\"") && ws::etag_matches("*", "\"z\"") &&
+            ws::etag_matches("W/\"a\"", "\"a\"") && !ws::etag_matches("\"a\", \"b\"", "\"ab\"") &&
+            !ws::etag_matches("", "\"a\""),
+        "If-None-Match lists");
+}
+
+void test_serving() {
+  std::atomic<int> calls{0};
+  ws::response_cache cache{};
+  ws::handler pages = [&calls](const ws::request& req, ws::response& resp) {
+    ++calls;
+    if (req.path == "/private") {
+      resp.headers.emplace_back("Cache-Control", "private");
+    }
+    resp.body = req.path == "/large" ? std::string(20000, 'L') : fmt::format("page {}", req.target);
+  };
+  ws::server srv{{"127.0.0.1", 0, 2}, ws::caching_handler{cache, pages}};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  for (int i = 0; i < 5; ++i) {
+    check(client.send_all("GET /home HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == "page /home", "GET");
+  }
+  check(calls == 1, "the handler ran once");
+  auto etag = resp.header("ETag");
+  check(!etag.empty(), "ETag sent");
+  check(client.send_all("GET /home HTTP/1.1\r\nIf-None-Match: W/\"x\", " + etag + "\r\n\r\n") && client.read_response(resp),
+        "conditional GET");
+  check(resp.status == 304 && resp.body.empty() && resp.header("ETag") == etag, "304 with the ETag");
+  check(client.send_all("GET /home HTTP/1.1\r\nIf-None-Match: \"stale\"\r\n\r\n") && client.read_response(resp) &&
+            resp.status == 200 && resp.body == "page /home",
+        "200 when the tag differs");
+  check(client.send_all("HEAD /home HTTP/1.1\r\n\r\n") && client.read_response(resp, false) &&
+            resp.header("Content-Length") == "10",
+        "HEAD from the cache");
+  check(client.send_all("GET /home?q=1 HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == "page /home?q=1",
+        "the query is part of the key");
+  check(client.send_all("GET /private HTTP/1.1\r\n\r\nGET /private HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+            client.read_response(resp),
+        "private");
+  check(client.send_all("POST /home HTTP/1.1\r\nContent-Length: 0\r\n\r\n") && client.read_response(resp), "POST");
+  check(calls == 5, "misses, private responses and POST reach the handler");
+
+  // a large entry goes out by reference, pipelined behind small ones
+  check(client.send_all("GET /large HTTP/1.1\r\n\r\nGET /large HTTP/1.1\r\n\r\nGET /home HTTP/1.1\r\n\r\n"), "pipelined");
+  check(client.read_response(resp) && resp.body == std::string(20000, 'L'), "large miss");
+  check(client.read_response(resp) && resp.body == std::string(20000, 'L'), "large hit");
+  check(client.read_response(resp) && resp.body == "page /home", "small hit behind it");
+  check(client.send_all("GET /large HTTP/1.1\r\nConnection: close\r\n\r\n") && client.read_response(resp) &&
+            resp.body.size() == 20000 && resp.header("Connection") == "close",
+        "hit with Connection: close");
+  check(client.closed_by_peer(), "closed after the hit");
+}
+
+void test_files() {
+  auto root = fs::temp_directory_path() / fmt::format("ws_response_cache_{}", ::getpid());
+  fs::create_directories(root);
+  std::ofstream{root / "page.html", std::ios::binary} << "<p>v1</p>";
+  ws::file_cache files{{root.string()}};
+  ws::response_cache cache{{1024 * 1024, 64 * 1024, 4, 300ms}};
+  ws::server srv{{"127.0.0.1", 0, 1}, ws::caching_handler{cache, ws::static_files{files}}};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /page.html HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == "<p>v1</p>", "file");
+  check(!resp.header("Last-Modified").empty() && resp.header("Content-Type") == "text/html; charset=utf-8",
+        "entity headers kept");
+  fs::remove(root / "page.html");
+  check(client.send_all("GET /page.html HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == "<p>v1</p>",
+        "a hot page does not touch the disk");
+  std::ofstream{root / "page.html", std::ios::binary} << "<p>v2</p>";
+  std::this_thread::sleep_for(1100ms);  // past max_age and the file_cache revalidation
+  check(client.send_all("GET /page.html HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.body == "<p>v2</p>",
+        "picked up after max_age");
+  srv.stop();
+  fs::remove_all(root);
+}
+
+// pipelined GETs of a rendered page, with and without the cache in front
+void bench_cache(bool cached) {
+  ws::handler render = [](const ws::request&, ws::response& resp) {
+    resp.content_type = "text/html; charset=utf-8";
+    for (int i = 0; i < 64; ++i) {
+      resp.body += fmt::format("<li>item {}</li>", i);
+    }
+  };
+  ws::response_cache cache{};
+  ws::server srv{{"127.0.0.1", 0, 1}, cached ? ws::handler{ws::caching_handler{cache, render}} : render};
+  srv.start();
+  std::string batch{};
+  for (int i = 0; i < 16; ++i) {
+    batch += "GET /list HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  }
+  http_client client{srv.get_port()};
+  http_response resp;
+  std::size_t n{0};
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < 500ms && client.send_all(batch)) {
+    for (int i = 0; i < 16 && client.read_response(resp); ++i) {
+      ++n;
+    }
+  }
+  auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("{:<14} {:>10.0f} req/s\n", cached ? "cached:" : "handler:", static_cast<double>(n) / secs);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_cache);
+  test::test_cache();
+
+  DividingLine(test_eviction);
+  test::test_eviction();
+
+  DividingLine(test_serving);
+  test::test_serving();
+
+  DividingLine(test_files);
+  test::test_files();
+
+  DividingLine(bench_cache);
+  test::bench_cache(false);
+  test::bench_cache(true);
+  return test::failures;
+}
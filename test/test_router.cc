@@ -0,0 +1,256 @@
+/** @file    test_router.cc
+ *  @time    2026/10/20 ~ 下午4:00
+ *  @author  Leon
+ *
+ *  @note    ws::router: static / param / wildcard matching, priorities and backtracking, 404 / 405, bad patterns, no
+ *           allocation per match, behind a server; lookups over 1k routes against std::map and a linear std::regex scan
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/router.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace test {
+std::atomic<std::size_t> allocations{0};
+}  // namespace test
+
+// counts every allocation in the process, to show a match makes none
+void* operator new(std::size_t size) {
+  test::allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace test {
+
+using namespace std::chrono_literals;
+
+// a handler naming its route, so a match can be told from another
+ws::route_handler named(std::string name) {
+  return [name = std::move(name)](const ws::request&, const ws::route_params& params, ws::response& resp) {
+    resp.body = name;
+    for (std::size_t i = 0; i < params.size(); ++i) {
+      resp.body += fmt::format(" {}={}", params.name_of(i), params[i]);
+    }
+  };
+}
+
+// the body the matched handler writes, or "-" if none matched
+std::string route(const ws::router& r, std::string_view method, std::string_view path) {
+  ws::route_params params{};
+  const auto* h = r.match(method, path, params);
+  if (h == nullptr) {
+    return "-";
+  }
+  ws::response resp{};
+  (*h)(ws::request{}, params, resp);
+  return resp.body;
+}
+
+void test_matching() {
+  ws::router r{};
+  r.add("GET", "/", named("root"));
+  r.add("GET", "/users", named("users"));
+  r.add("POST", "/users", named("create"));
+  r.add("GET", "/users/new", named("new"));
+  r.add("GET", "/users/:id", named("user"));
+  r.add("DELETE", "/users/:uid", named("delete"));
+  r.add("GET", "/users/:id/posts/:post", named("post"));
+  r.add("GET", "/users/:id/posts/latest", named("latest"));
+  r.add("GET", "/static/*path", named("static"));
+  r.add("GET", "/static/favicon.ico", named("favicon"));
+  r.add("GET", "/u:x", named("colon in a segment"));
+  r.add("GET", "/*rest", named("fallback"));
+  check(r.get_num_routes() == 12, "12 routes");
+
+  check(route(r, "GET", "/") == "root" && route(r, "GET", "/users") == "users" && route(r, "POST", "/users") == "create",
+        "static, by method");
+  check(route(r, "GET", "/users/new") == "new" && route(r, "GET", "/users/42") == "user id=42", "static before a param");
+  check(route(r, "GET", "/users/newton") == "user id=newton" && route(r, "GET", "/users/ne") == "user id=ne",
+        "backtracking from a static prefix into the param");
+  check(route(r, "DELETE", "/users/7") == "delete uid=7", "names belong to the route");
+  check(route(r, "GET", "/users/7/posts/99") == "post id=7 post=99" && route(r, "GET", "/users/7/posts/latest") == "latest id=7",
+        "two params, and static beside the second");
+  check(route(r, "GET", "/static/css/site.css") == "static path=css/site.css" &&
+            route(r, "GET", "/static/") == "static path=" && route(r, "GET", "/static/favicon.ico") == "favicon",
+        "wildcard, empty wildcard, static beside it");
+  check(route(r, "GET", "/u:x") == "colon in a segment", "':' inside a segment is text");
+  check(route(r, "GET", "/users/") == "fallback rest=users/" && route(r, "GET", "/users/7/posts") == "fallback rest=users/7/posts",
+        "an empty param never matches; the root wildcard catches the rest");
+  check(route(r, "HEAD", "/users/5") == "user id=5", "HEAD falls back to GET");
+  check(route(r, "PUT", "/users/5") == "-" && route(r, "POST", "/static/x") == "-", "no route for the method");
+
+  ws::router files{};
+  files.add("GET", "/files/index", named("index"));
+  files.add("DELETE", "/files/:name", named("remove"));
+  check(route(files, "DELETE", "/files/index") == "remove name=index" &&
+            route(files, "DELETE", "/files/other") == "remove name=other" && route(files, "GET", "/files/index") == "index",
+        "a static route of another method does not hide a param");
+  ws::request put{};
+  put.method = "PUT";
+  put.path = "/files/index";
+  ws::response refused{};
+  files(put, refused);
+  check(refused.status == 405 && refused.headers.size() == 1 && refused.headers[0].first == "Allow" &&
+            refused.headers[0].second == "GET, DELETE, HEAD",
+        "Allow gathers the methods of both routes");
+
+  ws::router strict{};
+  strict.add("GET", "/a/:id", named("a"));
+  check(route(strict, "GET", "/a/1/") == "-" && route(strict, "GET", "/a") == "-" && route(strict, "GET", "/b/1") == "-",
+        "no trailing slash, prefix or sibling match");
+
+  int rejected{0};
+  for (auto pattern : {"users", "/a/:", "/a/*", "/a/*rest/b", "/a/:x/:x", "/a/:b:c", "/users/:id"}) {
+    try {
+      ws::router bad{};
+      bad.add("GET", "/users/:id", named("x"));
+      bad.add("GET", pattern, named("y"));
+    } catch (const std::invalid_argument& e) {
+      ++rejected;
+    }
+  }
+  check(rejected == 7, "malformed and duplicate patterns throw");
+}
+
+void test_no_allocation() {
+  ws::router r{};
+  for (int i = 0; i < 200; ++i) {
+    r.add("GET", fmt::format("/api/v{}/items/:id/parts/:part", i), named("x"));
+    r.add("GET", fmt::format("/api/v{}/files/*path", i), named("y"));
+  }
+  ws::route_params params{};
+  std::size_t matched{0};
+  auto before = allocations.load();
+  for (int i = 0; i < 1000; ++i) {
+    matched += r.match("GET", "/api/v7/nothing", params) != nullptr;
+    matched += r.match("GET", "/api/v123/items/abc/parts/9", params) != nullptr;
+    matched += r.match("GET", "/api/v7/files/a/b/c.txt", params) != nullptr;
+  }
+  auto made = allocations.load() - before;
+  check(matched == 2000 && params.get("path") == "a/b/c.txt", "matched");
+  check(made == 0, "no allocation per match");
+  fmt::print("allocations in 3000 lookups: {}\n", made);
+}
+
+void test_serving() {
+  ws::router r{};
+  r.add("GET", "/hello/:name", [](const ws::request& req, const ws::route_params& p, ws::response& resp) {
+    resp.body = fmt::format("hello {} ({})", p.get("name"), req.query);
+  });
+  r.add("POST", "/echo", [](const ws::request& req, const ws::route_params&, ws::response& resp) {
+    resp.body = std::string{req.body};
+  });
+  ws::server srv{{"127.0.0.1", 0, 1}, r};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /hello/leon?x=1 HTTP/1.1\r\n\r\n") && client.read_response(resp) &&
+            resp.body == "hello leon (x=1)",
+        "a capture through the server, query apart");
+  check(client.send_all("POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc") && client.read_response(resp) &&
+            resp.body == "abc",
+        "POST");
+  check(client.send_all("GET /echo HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 405 &&
+            resp.header("Allow") == "POST",
+        "405 with Allow");
+  check(client.send_all("DELETE /hello/x HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 405 &&
+            resp.header("Allow") == "GET, HEAD",
+        "Allow adds HEAD for GET");
+  check(client.send_all("GET /nowhere HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 404, "404");
+}
+
+// lookups per second over 1000 routes: the router, a std::map of the static ones, a linear std::regex scan
+void bench_routing() {
+  constexpr int NUM_ROUTES{1000};
+  ws::router r{};
+  std::map<std::string, int, std::less<>> exact{};
+  std::vector<std::regex> patterns{};
+  std::vector<std::string> static_paths{};
+  std::vector<std::string> param_paths{};
+  for (int i = 0; i < NUM_ROUTES; ++i) {
+    auto base = fmt::format("/api/v{}/service{}/resource{}", i % 3, i % 40, i);
+    if (i % 2 == 0) {
+      r.add("GET", base + "/list", named("s"));
+      exact.emplace(base + "/list", i);
+      patterns.emplace_back("^" + base + "/list$");
+      static_paths.push_back(base + "/list");
+    } else {
+      r.add("GET", base + "/:id/items/:item", named("p"));
+      patterns.emplace_back("^" + base + "/([^/]+)/items/([^/]+)$");
+      param_paths.push_back(base + fmt::format("/{}/items/{}", i * 7, i * 13));
+    }
+  }
+
+  auto rate = [](auto&& lookup, const std::vector<std::string>& paths, std::size_t rounds) {
+    std::size_t hits{0};
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t k = 0; k < rounds; ++k) {
+      for (const auto& path : paths) {
+        hits += lookup(path);
+      }
+    }
+    auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return std::make_pair(static_cast<double>(rounds * paths.size()) / secs / 1e6, hits == rounds * paths.size());
+  };
+  ws::route_params params{};
+  auto by_router = [&](const std::string& path) { return r.match("GET", path, params) != nullptr; };
+  auto by_map = [&](const std::string& path) { return exact.find(path) != exact.end(); };
+  auto by_regex = [&](const std::string& path) {
+    std::smatch m;
+    for (const auto& re : patterns) {
+      if (std::regex_match(path, m, re)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto [router_static, ok1] = rate(by_router, static_paths, 200);
+  auto [map_static, ok2] = rate(by_map, static_paths, 200);
+  auto [router_params, ok3] = rate(by_router, param_paths, 200);
+  auto [regex_params, ok4] = rate(by_regex, std::vector<std::string>(param_paths.begin(), param_paths.begin() + 50), 1);
+  check(ok1 && ok2 && ok3 && ok4, "every benchmark path matched");
+  fmt::print("{} routes, million lookups per second:\n", NUM_ROUTES);
+  fmt::print("  static:   router {:>8.2f}   std::map {:>8.2f}\n", router_static, map_static);
+  fmt::print("  captures: router {:>8.2f}   std::regex scan {:>8.4f}\n", router_params, regex_params);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_matching);
+  test::test_matching();
+
+  DividingLine(test_no_allocation);
+  test::test_no_allocation();
+
+  DividingLine(test_serving);
+  test::test_serving();
+
+  DividingLine(bench_routing);
+  test::bench_routing();
+  return test::failures;
+}
@@ -0,0 +1,149 @@
+/** @file    test_rw_lock.cc
+ *  @time    2026/10/18 ~ 下午8:40
+ *  @author  Leon
+ *
+ *  @note    Read-heavy benchmark: std::shared_mutex vs tp::brw_spinlock vs tp::seqlock vs tp::epoch_domain
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <threadpool/rw_spin_lock.h>
+#include <threadpool/seqlock.h>
+#include <threadpool/epoch_reclaim.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <vector>
+#include <atomic>
+#include <shared_mutex>
+#include <chrono>
+
+namespace test {
+
+constexpr std::size_t NUM_THREADS = 4;
+constexpr std::size_t OPS_PER_THREAD = 500000;
+constexpr std::size_t WRITE_EVERY = 1000;  // 0.1% writes
+
+// a small read-mostly record; readers check the invariant b == 2 * a. Trivial (no member initializers, value-initialize
+// it with `config{}`), as tp::seqlock copies it bytewise
+struct config {
+  std::uint64_t a;
+  std::uint64_t b;
+  std::uint64_t c;
+};
+
+std::atomic<std::size_t> torn_reads{0};
+
+void check_config(const config& cfg) {
+  if (cfg.b != 2 * cfg.a) {
+    torn_reads.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+// run `op(thread, i)` on NUM_THREADS threads; prints million ops per second
+template <typename Op>
+void bench(const char* name, Op&& op) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&op, t] {
+      for (std::size_t i = 0; i < OPS_PER_THREAD; ++i) {
+        op(t, i);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("{:<22} {:>8.2f} Mops/s\n", name, static_cast<double>(NUM_THREADS * OPS_PER_THREAD) / s / 1e6);
+}
+
+template <typename Lock>
+void bench_lock(const char* name) {
+  Lock lock;
+  config cfg{};
+  bench(name, [&](std::size_t, std::size_t i) {
+    if (i % WRITE_EVERY == 0) {
+      std::unique_lock<Lock> lck{lock};
+      ++cfg.a;
+      cfg.b = 2 * cfg.a;
+    } else {
+      std::shared_lock<Lock> lck{lock};
+      check_config(cfg);
+    }
+  });
+}
+
+void test_read_heavy() {
+  bench_lock<std::shared_mutex>("std::shared_mutex");
+  bench_lock<tp::brw_spinlock<>>("tp::brw_spinlock");
+
+  tp::seqlock<config> seq;
+  bench("tp::seqlock", [&](std::size_t, std::size_t i) {
+    if (i % WRITE_EVERY == 0) {
+      seq.update([](config& cfg) {
+        ++cfg.a;
+        cfg.b = 2 * cfg.a;
+      });
+    } else {
+      check_config(seq.load());
+    }
+  });
+
+  // RCU style: readers dereference the published pointer, writers copy, publish and retire the old one
+  tp::epoch_domain domain;
+  std::atomic<config*> current{new config{}};
+  bench("tp::epoch_domain", [&](std::size_t, std::size_t i) {
+    if (i % WRITE_EVERY == 0) {
+      auto* next = new config{};
+      tp::epoch_domain::guard g{domain};
+      auto* old = current.load(std::memory_order_acquire);
+      do {
+        next->a = old->a + 1;
+        next->b = 2 * next->a;
+      } while (!current.compare_exchange_weak(old, next, std::memory_order_acq_rel));
+      domain.retire(old);
+    } else {
+      tp::epoch_domain::guard g{domain};
+      check_config(*current.load(std::memory_order_acquire));
+    }
+  });
+  domain.retire(current.load());
+
+  fmt::print("torn reads: {}\n", torn_reads.load());
+}
+
+void test_reclamation() {
+  static std::atomic<int> alive{0};
+  struct tracked {
+    tracked() { ++alive; }
+    ~tracked() { --alive; }
+  };
+
+  tp::epoch_domain domain;
+  for (int i = 0; i < 1000; ++i) {
+    domain.retire(new tracked{});
+  }
+  {
+    tp::epoch_domain::guard g{domain};  // a reader holds the epoch: nothing retired now may be freed
+    domain.retire(new tracked{});
+    domain.reclaim();
+    fmt::print("alive while a reader is inside: {} (>= 1)\n", alive.load());
+  }
+  domain.reclaim();
+  fmt::print("alive after reclaim: {} (expect 0)\n", alive.load());
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_read_heavy);
+  test::test_read_heavy();
+
+  DividingLine(test_reclamation);
+  test::test_reclamation();
+  return test::torn_reads.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/** @file    test_server.cc
+ *  @time    2026/10/18 ~ 下午11:20
+ *  @author  Leon
+ *
+ *  @note    Multi-reactor server: basic exchanges, pipelining and partial writes, then loopback throughput
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/server.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+namespace test {
+
+void hello(const ws::request& req, ws::response& resp) {
+  if (req.path == "/echo") {
+    resp.body = std::string{req.body};
+    return;
+  }
+  if (req.path == "/big") {  // larger than the socket buffers: needs partial writes
+    resp.body = std::string(8 * 1024 * 1024, 'b');
+    return;
+  }
+  resp.body = "Hello, World!";
+}
+
+void test_basic() {
+  ws::server srv{{"127.0.0.1", 0, 2}, hello};
+  srv.start();
+
+  http_client client{srv.get_port()};
+  check(client.connected(), "connect");
+  http_response resp;
+  check(client.send_all("GET / HTTP/1.1\r\nHost: x\r\n\r\n") && client.read_response(resp), "GET");
+  check(resp.status == 200 && resp.body == "Hello, World!", "GET body");
+
+  check(client.send_all("HEAD / HTTP/1.1\r\nHost: x\r\n\r\n") && client.read_response(resp, false), "HEAD");
+  check(resp.status == 200 && resp.header("Content-Length") == "13", "HEAD keeps Content-Length");
+
+  check(client.send_all("POST /echo HTTP/1.1\r\nContent-Length: 5\r\n\r\nabcde") && client.read_response(resp), "POST");
+  check(resp.body == "abcde", "POST body echoed");
+
+  check(client.send_all("GET / HTTP/1.1\r\nConnection: close\r\n\r\n") && client.read_response(resp), "close");
+  check(resp.header("Connection") == "close" && client.closed_by_peer(), "closed after Connection: close");
+
+  http_client bad{srv.get_port()};
+  check(bad.send_all("NONSENSE\r\n\r\n") && bad.read_response(resp) && resp.status == 400, "400 on garbage");
+  check(bad.closed_by_peer(), "closed after 400");
+
+  fmt::print("requests served: {}\n", srv.get_num_requests());
+}
+
+void test_pipelining() {
+  ws::server srv{{"127.0.0.1", 0, 1}, hello};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+
+  // one send, several requests of different kinds: the answers come back in order
+  std::string large(10000, 'x');
+  std::string batch = "GET /a HTTP/1.1\r\n\r\n"
+                      "HEAD /b HTTP/1.1\r\n\r\n"
+                      "POST /echo HTTP/1.1\r\nContent-Length: " + std::to_string(large.size()) + "\r\n\r\n" + large +
+                      "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\nxyz";
+  check(client.send_all(batch), "send pipelined batch");
+  check(client.read_response(resp) && resp.body == "Hello, World!", "1st pipelined response");
+  check(client.read_response(resp, false) && resp.header("Content-Length") == "13", "2nd (HEAD) pipelined response");
+  check(client.read_response(resp) && resp.body == large, "3rd pipelined response (separate body segment)");
+  check(client.read_response(resp) && resp.body == "xyz", "4th pipelined response");
+
+  // more pipelined requests than one batch, followed by a request split across sends
+  std::string many;
+  for (int i = 0; i < 200; ++i) {
+    many += "GET / HTTP/1.1\r\n\r\n";
+  }
+  check(client.send_all(many + "GET / HT"), "send 200 + half");
+  bool all{true};
+  for (int i = 0; i < 200; ++i) {
+    all = all && client.read_response(resp) && resp.status == 200;
+  }
+  check(all, "200 pipelined responses");
+  check(client.send_all("TP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 200, "split request");
+
+  // a client that does not read: the server blocks on the socket and resumes from the partial write
+  http_client slow{srv.get_port()};
+  check(slow.send_all("GET /big HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\n"), "send to slow client");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  check(slow.read_response(resp) && resp.body.size() == 8 * 1024 * 1024 && resp.body.find_first_not_of('b') == std::string::npos,
+        "large body after partial writes");
+  check(slow.read_response(resp) && resp.body == "Hello, World!", "pipelined response after the large one");
+}
+
+// keep-alive clients sending `depth` pipelined requests per round trip
+void bench_pipelined(std::size_t depth, std::chrono::milliseconds duration) {
+  ws::server srv{{"127.0.0.1", 0, 1}, hello};
+  srv.start();
+  std::string batch;
+  for (std::size_t i = 0; i < depth; ++i) {
+    batch += "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  }
+  std::atomic<bool> done{false};
+  std::atomic<std::size_t> completed{0};
+  std::vector<std::thread> clients;
+  for (int c = 0; c < 4; ++c) {
+    clients.emplace_back([&] {
+      http_client client{srv.get_port()};
+      http_response resp;
+      std::size_t n{0};
+      while (!done.load(std::memory_order_relaxed) && client.send_all(batch)) {
+        for (std::size_t i = 0; i < depth && client.read_response(resp); ++i) {
+          ++n;
+        }
+      }
+      completed += n;
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  done = true;
+  for (auto& t : clients) {
+    t.join();
+  }
+  fmt::print("pipeline depth {:>3}: {:>10.0f} req/s\n", depth,
+             static_cast<double>(completed.load()) / std::chrono::duration<double>(duration).count());
+}
+
+// closed-loop keep-alive clients, like `wrk -c <clients>`
+void bench_throughput(std::size_t num_reactors, std::size_t num_clients, std::chrono::milliseconds duration) {
+  ws::server srv{{"127.0.0.1", 0, num_reactors}, hello};
+  srv.start();
+
+  std::atomic<bool> done{false};
+  std::atomic<std::size_t> completed{0};
+  std::vector<std::thread> clients;
+  for (std::size_t c = 0; c < num_clients; ++c) {
+    clients.emplace_back([&] {
+      http_client client{srv.get_port()};
+      http_response resp;
+      std::size_t n{0};
+      while (!done.load(std::memory_order_relaxed)) {
+        if (!client.send_all("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n") || !client.read_response(resp)) {
+          break;
+        }
+        ++n;
+      }
+      completed += n;
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  done = true;
+  for (auto& t : clients) {
+    t.join();
+  }
+  auto secs = std::chrono::duration<double>(duration).count();
+  fmt::print("reactors {:>2}, clients {:>3}: {:>10.0f} req/s\n", num_reactors, num_clients,
+             static_cast<double>(completed.load()) / secs);
+  check(completed.load() > 0, "requests completed");
+  check(srv.get_num_requests() >= completed.load(), "server counted every request");
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_basic);
+  test::test_basic();
+
+  DividingLine(test_pipelining);
+  test::test_pipelining();
+
+  DividingLine(bench_throughput);
+  for (std::size_t reactors : {1, 2, 4}) {
+    test::bench_throughput(reactors, 16, std::chrono::milliseconds(500));
+  }
+  for (std::size_t depth : {1, 16}) {
+    test::bench_pipelined(depth, std::chrono::milliseconds(500));
+  }
+  return test::failures;
+}
@@ -0,0 +1,302 @@
+/** @file    test_static_files.cc
+ *  @time    2026/10/19 ~ 下午12:00
+ *  @author  Leon
+ *
+ *  @note    ws::file_cache (hits, revalidation, eviction, traversal) and sendfile serving; Range / If-Range, single and
+ *           multipart, on both backends; buffers held while large files stream to a slow reader; lookup cost vs
+ *           open+fstat
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/static_files.h>
+#include <webserver/byte_ranges.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace test {
+
+namespace fs = std::filesystem;
+
+void write_file(const fs::path& path, const std::string& content) {
+  std::ofstream{path, std::ios::binary} << content;
+}
+
+std::string make_content(std::size_t size) {
+  std::string s(size, '\0');
+  for (std::size_t i = 0; i < size; ++i) {
+    s[i] = static_cast<char>('a' + (i * 7 + i / 4096) % 26);
+  }
+  return s;
+}
+
+fs::path make_root() {
+  auto root = fs::temp_directory_path() / fmt::format("ws_static_{}", ::getpid());
+  fs::create_directories(root / "sub");
+  write_file(root / "index.html", "<h1>index</h1>");
+  write_file(root / "style.css", "body{}");
+  write_file(root / "sub" / "data.json", "{\"a\":1}");
+  write_file(root / "big.bin", make_content(4 * 1024 * 1024 + 123));
+  write_file(fs::temp_directory_path() / "ws_static_secret.txt", "secret");
+  return root;
+}
+
+void test_cache(const fs::path& root) {
+  ws::file_cache cache{{root.string(), 4, 8, std::chrono::milliseconds(50)}};
+  auto a = cache.lookup("/style.css");
+  auto b = cache.lookup("/style.css");
+  check(a != nullptr && a == b, "second lookup is a hit on the same open file");
+  check(a->content_type == "text/css; charset=utf-8" && a->size == 6, "type and size");
+  check(a->headers.find("Last-Modified: ") != std::string::npos, "pre-rendered headers");
+  check(cache.lookup("/") != nullptr && cache.lookup("/")->size == 14, "/ maps to index.html");
+  check(cache.lookup("/missing") == nullptr, "missing file");
+  check(cache.lookup("/sub") == nullptr, "directories are not served");
+  check(cache.lookup("/../ws_static_secret.txt") == nullptr, "no traversal");
+  check(cache.lookup("/sub/../../ws_static_secret.txt") == nullptr, "no traversal through a subdirectory");
+
+  // a changed file is picked up at the first lookup after revalidate_after
+  write_file(root / "style.css", "body{color:red}");
+  check(cache.lookup("/style.css") == a, "still cached within the revalidation period");
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  auto c = cache.lookup("/style.css");
+  check(c != nullptr && c != a && c->size == 15, "revalidated after a change");
+  check(a->fd >= 0 && ::fcntl(a->fd, F_GETFD) != -1, "the old fd stays open while it is in use");
+
+  // bounded number of open files
+  for (int i = 0; i < 32; ++i) {
+    write_file(root / fmt::format("f{}.txt", i), "x");
+    cache.lookup(fmt::format("/f{}.txt", i));
+  }
+  check(cache.get_num_open() <= 8, "fd count bounded");
+  fmt::print("open files after 32 distinct lookups: {}\n", cache.get_num_open());
+}
+
+void test_serving(const fs::path& root) {
+  ws::file_cache cache{{root.string()}};
+  ws::server srv{{"127.0.0.1", 0, 2}, ws::static_files{cache}};
+  srv.start();
+
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET / HTTP/1.1\r\n\r\n") && client.read_response(resp), "GET /");
+  check(resp.status == 200 && resp.body == "<h1>index</h1>", "index body");
+  check(resp.header("Content-Type") == "text/html; charset=utf-8", "index type");
+
+  auto big = make_content(4 * 1024 * 1024 + 123);
+  check(client.send_all("GET /big.bin HTTP/1.1\r\n\r\n") && client.read_response(resp), "GET big");
+  check(resp.body == big, "large file intact through sendfile");
+
+  check(client.send_all("HEAD /big.bin HTTP/1.1\r\n\r\n") && client.read_response(resp, false), "HEAD big");
+  check(resp.header("Content-Length") == std::to_string(big.size()), "HEAD length");
+
+  check(client.send_all("GET /sub/data.json HTTP/1.1\r\n\r\n") && client.read_response(resp), "GET json");
+  check(resp.body == "{\"a\":1}" && resp.header("Content-Type") == "application/json", "json");
+
+  // pipelined: a file body between two in-memory responses, all in one flush
+  check(client.send_all("GET /nope HTTP/1.1\r\n\r\nGET /big.bin HTTP/1.1\r\n\r\nGET /style.css HTTP/1.1\r\n\r\n"),
+        "pipelined with a file");
+  check(client.read_response(resp) && resp.status == 404, "pipelined 404");
+  check(client.read_response(resp) && resp.body == big, "pipelined file");
+  check(client.read_response(resp) && resp.body == "body{color:red}", "pipelined small file (rewritten by test_cache)");
+
+  check(client.send_all("GET /nope HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 404, "404");
+  check(client.send_all("POST / HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 405, "405");
+}
+
+void test_parse_ranges() {
+  std::vector<ws::byte_range> r{};
+  auto one = [&](std::string_view value, std::int64_t first, std::int64_t last) {
+    return ws::parse_ranges(value, 100, r) && r.size() == 1 && r[0].first == first && r[0].last == last;
+  };
+  check(one("bytes=0-9", 0, 9) && one("bytes=90-", 90, 99) && one("bytes=-10", 90, 99) && one("Bytes=5-5", 5, 5),
+        "first-last, open-ended, suffix");
+  check(one("bytes=95-200", 95, 99) && one("bytes=-200", 0, 99), "clipped to the body");
+  check(one("bytes=, 0-1 ,200-", 0, 1), "unsatisfiable ranges beside satisfiable ones are left out");
+  check(ws::parse_ranges("bytes=200-300,-0", 100, r) && r.empty(), "none satisfiable: 416");
+  check(ws::parse_ranges("bytes=0-1,10-19,-5", 100, r) && r.size() == 3 && r[2].first == 95, "several, in order");
+  bool ignored{true};
+  for (auto value : {"items=0-1", "bytes=", "bytes=5-1", "bytes=abc", "bytes=1", "bytes=--1", "bytes=0-99,0-99",
+                     "bytes=0-0,1-1,2-2,3-3,4-4,5-5,6-6,7-7,8-8,9-9,10-10,11-11,12-12,13-13,14-14,15-15,16-16"}) {
+    ignored = ignored && !ws::parse_ranges(value, 100, r);
+  }
+  check(ignored, "malformed, another unit, too many or overlapping too much: ignored");
+
+  ws::open_file f{};
+  f.etag = "\"5f.0-64\"";
+  f.last_modified = "Thu, 22 Oct 2026 12:00:00 GMT";
+  check(ws::if_range_matches("\"5f.0-64\"", f) && ws::if_range_matches(" Thu, 22 Oct 2026 12:00:00 GMT", f),
+        "If-Range: the tag or the date");
+  check(!ws::if_range_matches("W/\"5f.0-64\"", f) && !ws::if_range_matches("\"old\"", f) &&
+            !ws::if_range_matches("Thu, 22 Oct 2026 11:00:00 GMT", f),
+        "a weak tag, another tag or date do not match");
+}
+
+void ranges(const fs::path& root, ws::backend backend) {
+  ws::file_cache cache{{root.string()}};
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.backend = backend;
+  ws::server srv{config, ws::static_files{cache}};
+  try {
+    srv.start();
+  } catch (const std::system_error& e) {
+    fmt::print("backend unavailable ({}): skipped\n", e.what());
+    return;
+  }
+  auto big = make_content(4 * 1024 * 1024 + 123);
+  auto size = std::to_string(big.size());
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /big.bin HTTP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 200 &&
+            resp.header("Accept-Ranges") == "bytes" && !resp.header("ETag").empty(),
+        "ranges advertised");
+  auto etag = resp.header("ETag");
+  auto last_modified = resp.header("Last-Modified");
+
+  check(client.send_all("GET /big.bin HTTP/1.1\r\nRange: bytes=100-199\r\n\r\n") && client.read_response(resp) &&
+            resp.status == 206 && resp.header("Content-Range") == "bytes 100-199/" + size &&
+            resp.body == big.substr(100, 100),
+        "one range");
+  check(client.send_all("GET /big.bin HTTP/1.1\r\nRange: bytes=-5\r\n\r\nGET /index.html HTTP/1.1\r\n\r\n") &&
+            client.read_response(resp) && resp.status == 206 && resp.body == big.substr(big.size() - 5) &&
+            client.read_response(resp) && resp.body == "<h1>index</h1>",
+        "a suffix, pipelined");
+
+  check(client.send_all("GET /big.bin HTTP/1.1\r\nRange: bytes=0-9,3000000-3000009\r\n\r\n") &&
+            client.read_response(resp) && resp.status == 206,
+        "two ranges");
+  auto type = resp.header("Content-Type");
+  auto boundary = type.substr(type.find("boundary=") + 9);
+  std::string expected = "\r\n--" + boundary + "\r\nContent-Type: application/octet-stream\r\nContent-Range: bytes 0-9/" +
+                         size + "\r\n\r\n" + big.substr(0, 10) + "\r\n--" + boundary +
+                         "\r\nContent-Type: application/octet-stream\r\nContent-Range: bytes 3000000-3000009/" + size +
+                         "\r\n\r\n" + big.substr(3000000, 10) + "\r\n--" + boundary + "--\r\n";
+  check(type.rfind("multipart/byteranges; boundary=", 0) == 0 && resp.body == expected &&
+            resp.header("Content-Range").empty(),
+        "multipart/byteranges");
+
+  check(client.send_all("GET /big.bin HTTP/1.1\r\nRange: bytes=99999999-\r\n\r\n") && client.read_response(resp) &&
+            resp.status == 416 && resp.header("Content-Range") == "bytes */" + size,
+        "416");
+  check(client.send_all("HEAD /big.bin HTTP/1.1\r\nRange: bytes=0-9\r\n\r\n") && client.read_response(resp, false) &&
+            resp.status == 200 && resp.header("Content-Length") == size,
+        "HEAD ignores Range");
+
+  check(client.send_all("GET /big.bin HTTP/1.1\r\nRange: bytes=10-19\r\nIf-Range: " + etag + "\r\n\r\n") &&
+            client.read_response(resp) && resp.status == 206 && resp.body == big.substr(10, 10),
+        "If-Range with the current ETag");
+  check(client.send_all("GET /big.bin HTTP/1.1\r\nRange: bytes=10-19\r\nIf-Range: " + last_modified + "\r\n\r\n") &&
+            client.read_response(resp) && resp.status == 206,
+        "If-Range with the Last-Modified date");
+  check(client.send_all("GET /big.bin HTTP/1.1\r\nRange: bytes=10-19\r\nIf-Range: \"stale\"\r\n\r\n") &&
+            client.read_response(resp) && resp.status == 200 && resp.body == big,
+        "a stale If-Range: the whole file");
+}
+
+void test_ranges(const fs::path& root) {
+  ranges(root, ws::backend::libevent);
+#ifdef WITH_IO_URING
+  ranges(root, ws::backend::io_uring);
+#endif
+}
+
+// many large files asked for at once by a client that does not read: the server's buffers stay as they are
+void streaming(const fs::path& root, ws::backend backend) {
+  constexpr int NUM_DOWNLOADS{16};  // 64 MB
+  ws::file_cache cache{{root.string()}};
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.backend = backend;
+  ws::server srv{config, ws::static_files{cache}};
+  try {
+    srv.start();
+  } catch (const std::system_error& e) {
+    fmt::print("backend unavailable ({}): skipped\n", e.what());
+    return;
+  }
+  http_client client{srv.get_port()};
+  std::string batch{};
+  for (int i = 0; i < NUM_DOWNLOADS; ++i) {
+    batch += "GET /big.bin HTTP/1.1\r\n\r\n";
+  }
+  client.send_all(batch);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  auto held = srv.get_buffer_bytes_in_use();
+  check(held < 512 * 1024, "buffers held while the client does not read: bounded");
+
+  auto big = make_content(4 * 1024 * 1024 + 123);
+  http_response resp;
+  bool intact{true};
+  for (int i = 0; i < NUM_DOWNLOADS; ++i) {
+    intact = intact && client.read_response(resp) && resp.body == big;
+  }
+  check(intact, "every download intact");
+  fmt::print("{} MB asked for, not read: {} bytes of buffers held\n", NUM_DOWNLOADS * 4, held);
+}
+
+void test_streaming(const fs::path& root) {
+  streaming(root, ws::backend::libevent);
+#ifdef WITH_IO_URING
+  streaming(root, ws::backend::io_uring);
+#endif
+}
+
+void bench_lookup(const fs::path& root) {
+  constexpr int ROUNDS = 200000;
+  auto full = (root / "style.css").string();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; ++i) {
+    int fd = ::open(full.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st {};
+    ::fstat(fd, &st);
+    ::close(fd);
+  }
+  auto syscalls = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+
+  ws::file_cache cache{{root.string()}};
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; ++i) {
+    auto f = cache.lookup("/style.css");
+  }
+  auto cached = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+  fmt::print("open+fstat+close: {:>8.1f} ns, file_cache hit: {:>8.1f} ns\n", syscalls, cached);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  auto root = test::make_root();
+  DividingLine(Start Tests !);
+  DividingLine(test_cache);
+  test::test_cache(root);
+
+  DividingLine(test_serving);
+  test::test_serving(root);
+
+  DividingLine(test_parse_ranges);
+  test::test_parse_ranges();
+
+  DividingLine(test_ranges);
+  test::test_ranges(root);
+
+  DividingLine(test_streaming);
+  test::test_streaming(root);
+
+  DividingLine(bench_lookup);
+  test::bench_lookup(root);
+
+  std::filesystem::remove_all(root);
+  std::filesystem::remove(std::filesystem::temp_directory_path() / "ws_static_secret.txt");
+  return test::failures;
+}
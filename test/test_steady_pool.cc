@@ -8,13 +8,15 @@
 
 #include <fmt/core.h>
 #include <thread>
-// #include <threadpool/dynamic_pool.h>
+#include <threadpool/dynamic_pool.h>
 #include <threadpool/steady_pool.h>
 #include <utils/printer.h>
 #include <utils/tictok.h>
+#include <check.h>
 #include <vector>
 #include <future>
 #include <complex>
+#include <atomic>
 #include <Hipe/steady_pond.h>
 
 #ifdef WITH_TBB
@@ -70,6 +72,146 @@ void test_submit_in_batch() {
   //  for (auto&& f : futures) { fmt::print("{} ", f.get()); }
 
 }
+
+void test_submit_buffered() {
+  tp::SteadyThreadPool pool{8};
+
+  std::vector<std::future<float>> futures(TEST_TASK_NUM);
+  TIC(test_submit_buffered)
+  for (std::size_t i = 0; i < futures.size(); ++i) {
+    futures[i] = pool.submit_buffered(do_math, 3.14F, 2.71F);
+  }
+  pool.wait_for_tasks();  // flushes the tail of the buffer
+  TOK(test_submit_buffered)
+
+  // a small burst stays buffered until flushed explicitly
+  pool.set_buffer_policy(1024, std::chrono::microseconds{0});
+  auto future = pool.submit_buffered([] { return 42; });
+  pool.flush();
+  fmt::print("buffered result: {}\n", future.get());
+}
+
+// buffered tasks nobody flushes: due ones are flushed by idle workers, the others when the producer exits or the
+// pool is destroyed; they count as submitted
+template <typename Pool>
+void buffer_deadlines() {
+  {
+    Pool pool{2};
+    pool.set_buffer_policy(1024, 1ms);
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 3; ++i) {
+      futures.emplace_back(pool.submit_buffered([i] { return i; }));
+    }
+    bool ready{true};
+    for (auto&& f : futures) {  // no flush(): the producer just blocks
+      ready = ready && f.wait_for(2s) == std::future_status::ready;
+    }
+    check(ready, "flushed once due");
+  }
+  {
+    Pool pool{2};
+    pool.set_buffer_policy(1024, 50ms);
+    std::atomic<int> done{0};
+    std::atomic<bool> buffered{false};
+    std::thread producer{[&] {
+      for (int i = 0; i < 3; ++i) {
+        pool.submit_buffered([&done] { ++done; });
+      }
+      buffered = true;
+      std::this_thread::sleep_for(100ms);  // alive until after the deadline
+    }};
+    while (!buffered) {
+      std::this_thread::yield();
+    }
+    pool.wait_for_tasks();
+    check(done == 3, "waited for by another thread");
+    producer.join();
+  }
+  {
+    Pool pool{2};
+    pool.set_buffer_policy(1024, 0us);
+    std::future<int> future;
+    std::thread{[&] { future = pool.submit_buffered([] { return 1; }); }}.join();
+    check(future.wait_for(2s) == std::future_status::ready, "handed over when the producer exits");
+  }
+  std::future<int> first;
+  {
+    Pool pool{2};
+    pool.set_buffer_policy(1024, 0us);
+    first = pool.submit_buffered([] { return 1; });
+  }
+  check(first.wait_for(2s) == std::future_status::ready, "handed over when the pool is destroyed");
+  Pool other{2};
+  auto second = other.submit_buffered([] { return 2; });  // the buffer no longer points at the destroyed pool
+  other.flush();
+  check(second.get() == 2, "then buffered for another pool");
+}
+
+void test_buffer_deadlines() {
+  buffer_deadlines<tp::SteadyThreadPool>();
+  buffer_deadlines<tp::DynamicThreadPool>();
+}
+
+void test_submit_blocking() {
+  tp::SteadyThreadPool pool{2};
+
+  // both workers block; their queued CPU tasks keep running on compensating threads
+  auto io1 = pool.submit_blocking([] { std::this_thread::sleep_for(300ms); });
+  auto io2 = pool.submit_task([] {
+    tp::blocking_region region;
+    std::this_thread::sleep_for(300ms);
+  });
+  std::this_thread::sleep_for(10ms);
+
+  std::vector<std::future<float>> futures(TEST_TASK_NUM / 100);
+  TIC(test_submit_blocking)
+  for (std::size_t i = 0; i < futures.size(); ++i) {
+    futures[i] = pool.submit_task(do_math, 3.14F, 2.71F);
+  }
+  for (auto&& f : futures) {
+    f.get();
+  }
+  TOK(test_submit_blocking)  // far below the 300ms the workers are blocked
+  io1.get();
+  io2.get();
+}
+
+// two workers block at once while one compensating thread is parked: each still gets its own
+void test_blocking_together() {
+  tp::SteadyThreadPool pool{2};
+  pool.submit_blocking([] {}).get();  // leaves a parked compensating thread behind
+  std::this_thread::sleep_for(20ms);
+
+  std::atomic<int> arrived{0};
+  auto block = [&arrived] {
+    ++arrived;
+    while (arrived.load() < 2) {  // enter the regions together
+      std::this_thread::yield();
+    }
+    tp::blocking_region region;
+    std::this_thread::sleep_for(300ms);
+  };
+  auto io1 = pool.submit_task(block);
+  auto io2 = pool.submit_task(block);
+  while (arrived.load() < 2) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(10ms);
+
+  std::vector<std::future<float>> futures(TEST_TASK_NUM / 1000);
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < futures.size(); ++i) {  // spread over both workers' queues
+    futures[i] = pool.submit_task(do_math, 3.14F, 2.71F);
+  }
+  for (auto&& f : futures) {
+    f.get();
+  }
+  auto took = std::chrono::steady_clock::now() - start;
+  fmt::print("tasks behind two blocked workers: {:.2f}ms\n", std::chrono::duration<double, std::milli>(took).count());
+  check(took < 200ms, "both blocked workers compensated");
+  io1.get();
+  io2.get();
+}
 }  // namespace test
 
 
@@ -81,4 +223,17 @@ int main() {
 
   DividingLine(test_submit_in_batch);
   test::test_submit_in_batch();
+
+  DividingLine(test_submit_buffered);
+  test::test_submit_buffered();
+
+  DividingLine(test_buffer_deadlines);
+  test::test_buffer_deadlines();
+
+  DividingLine(test_submit_blocking);
+  test::test_submit_blocking();
+
+  DividingLine(test_blocking_together);
+  test::test_blocking_together();
+  return test::failures;
 }
\ No newline at end of file
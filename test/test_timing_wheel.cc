@@ -0,0 +1,183 @@
+/** @file    test_timing_wheel.cc
+ *  @time    2026/10/19 ~ 下午5:40
+ *  @author  Leon
+ *
+ *  @note    ws::timing_wheel expiry, lazy resets and revolutions; connection timeouts of the server;
+ *           resetting 100k timeouts on the wheel vs libevent timers
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/timing_wheel.h>
+#include <event2/event.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+
+namespace test {
+
+using namespace std::chrono_literals;
+using clock = std::chrono::steady_clock;
+
+struct counter {
+  int fired{0};
+  static void fire(void* arg) { ++static_cast<counter*>(arg)->fired; }
+};
+
+void test_wheel() {
+  auto t0 = clock::now();
+  ws::timing_wheel wheel{100ms, 8, t0};
+  counter a, b, c;
+  ws::wheel_timer ta{&counter::fire, &a};
+  ws::wheel_timer tb{&counter::fire, &b};
+  ws::wheel_timer tc{&counter::fire, &c};
+
+  wheel.schedule(ta, 300ms);
+  wheel.schedule(tb, 250ms);  // rounded up to 3 ticks
+  wheel.schedule(tc, 2000ms);  // 20 ticks: more than two revolutions of 8 slots
+  check(wheel.get_num_armed() == 3, "armed");
+  check(wheel.advance(t0 + 299ms) == 0 && a.fired == 0, "not yet due");
+  check(wheel.advance(t0 + 300ms) == 2 && a.fired == 1 && b.fired == 1, "due at 3 ticks");
+  check(!ta.is_armed() && wheel.get_num_armed() == 1, "fired timers are disarmed");
+
+  // activity pushes the deadline: only a store, the timer is moved when its old slot comes round
+  wheel.schedule(ta, 300ms);  // due at tick 6
+  wheel.advance(t0 + 500ms);
+  wheel.schedule(ta, 300ms);  // due at tick 8
+  check(wheel.advance(t0 + 700ms) == 0 && a.fired == 1, "reset postpones");
+  check(wheel.advance(t0 + 800ms) == 1 && a.fired == 2, "fires at the new deadline");
+
+  // moving a deadline earlier re-links it
+  wheel.schedule(ta, 1000ms);
+  wheel.schedule(ta, 100ms);
+  check(wheel.advance(t0 + 900ms) == 1 && a.fired == 3, "earlier deadline");
+
+  check(wheel.advance(t0 + 1900ms) == 0 && c.fired == 0, "later revolution waits");
+  check(wheel.advance(t0 + 2000ms) == 1 && c.fired == 1, "fires after revolutions");
+
+  wheel.schedule(ta, 100ms);
+  wheel.cancel(ta);
+  check(wheel.advance(t0 + 3000ms) == 0 && wheel.get_num_armed() == 0, "cancel");
+
+  // a callback cancelling a timer due in the same tick
+  struct canceller {
+    ws::timing_wheel* wheel;
+    ws::wheel_timer* other;
+    static void fire(void* arg) {
+      auto* self = static_cast<canceller*>(arg);
+      self->wheel->cancel(*self->other);
+    }
+  };
+  canceller k{&wheel, &tb};
+  ws::wheel_timer tk{&canceller::fire, &k};
+  wheel.schedule(tk, 100ms);
+  wheel.schedule(tb, 100ms);
+  check(wheel.advance(t0 + 3100ms) == 1 && b.fired == 1, "cancelled from a callback");
+}
+
+void hello(const ws::request&, ws::response& resp) { resp.body = "hello"; }
+
+void test_timeouts() {
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.timeouts.idle = 400ms;
+  config.timeouts.read_header = 300ms;
+  config.timeouts.write = 400ms;
+  ws::server srv{config, hello};
+  srv.start();
+
+  http_client idle{srv.get_port()};
+  http_client slow{srv.get_port()};
+  http_client busy{srv.get_port()};
+  http_response resp;
+  check(idle.send_all("GET / HTTP/1.1\r\n\r\n") && idle.read_response(resp), "first request");
+  check(slow.send_all("GET / HTTP/1.1\r\nHost: x"), "partial head");
+
+  // `busy` keeps sending requests: each one resets its idle timeout
+  auto start = clock::now();
+  bool ok{true};
+  while (clock::now() - start < 900ms) {
+    ok = ok && busy.send_all("GET / HTTP/1.1\r\n\r\n") && busy.read_response(resp);
+    std::this_thread::sleep_for(50ms);
+    if (clock::now() - start < 200ms) {
+      ok = ok && slow.send_all("x");  // dribbling bytes does not extend the head's deadline
+    }
+  }
+  check(ok, "busy connection served");
+  check(slow.read_response(resp) && resp.status == 408, "408 on a slow head");
+  check(slow.closed_by_peer(), "slow connection closed");
+  check(idle.closed_by_peer(), "idle connection closed");
+  check(busy.send_all("GET / HTTP/1.1\r\n\r\n") && busy.read_response(resp) && resp.status == 200, "busy one kept");
+  check(srv.get_num_connections() == 1, "one connection left");
+  srv.stop();
+}
+
+void bench_reset() {
+  constexpr int TIMERS = 100000;
+  constexpr int ROUNDS = 10;
+
+  // libevent: every reset is an event_add on a min-heap (remove + reinsert)
+  auto* base = ::event_base_new();
+  std::vector<event*> events;
+  for (int i = 0; i < TIMERS; ++i) {
+    events.push_back(evtimer_new(base, [](evutil_socket_t, short, void*) {}, nullptr));
+  }
+  auto start = clock::now();
+  for (int r = 0; r < ROUNDS; ++r) {
+    for (int i = 0; i < TIMERS; ++i) {
+      timeval tv{60, (i % 1000) * 1000};
+      evtimer_add(events[i], &tv);
+    }
+  }
+  auto heap = std::chrono::duration<double, std::nano>(clock::now() - start).count() / (TIMERS * ROUNDS);
+  start = clock::now();
+  for (auto* ev : events) {
+    ::event_free(ev);
+  }
+  auto heap_del = std::chrono::duration<double, std::nano>(clock::now() - start).count() / TIMERS;
+  ::event_base_free(base);
+
+  auto t0 = clock::now();
+  ws::timing_wheel wheel{100ms, 512, t0};
+  counter fired;
+  std::vector<std::unique_ptr<ws::wheel_timer>> timers;
+  for (int i = 0; i < TIMERS; ++i) {
+    timers.push_back(std::make_unique<ws::wheel_timer>(&counter::fire, &fired));
+  }
+  start = clock::now();
+  for (int r = 0; r < ROUNDS; ++r) {
+    for (int i = 0; i < TIMERS; ++i) {
+      wheel.schedule(*timers[i], std::chrono::milliseconds(60000 + i % 1000));
+    }
+  }
+  auto wheel_ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / (TIMERS * ROUNDS);
+  start = clock::now();
+  wheel.advance(t0 + 70s);  // bulk expiry of all of them
+  auto expiry = std::chrono::duration<double, std::nano>(clock::now() - start).count() / TIMERS;
+  check(fired.fired == TIMERS, "bulk expiry");
+
+  fmt::print("{} timers, reset -> evtimer_add: {:>6.1f} ns, wheel: {:>6.1f} ns\n", TIMERS, heap, wheel_ns);
+  fmt::print("per timer, removal -> event_free: {:>6.1f} ns, wheel expiry: {:>6.1f} ns\n", heap_del, expiry);
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  DividingLine(test_wheel);
+  test::test_wheel();
+
+  DividingLine(test_timeouts);
+  test::test_timeouts();
+
+  DividingLine(bench_reset);
+  test::bench_reset();
+  return test::failures;
+}
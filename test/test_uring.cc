@@ -0,0 +1,217 @@
+/** @file    test_uring.cc
+ *  @time    2026/10/19 ~ 下午9:00
+ *  @author  Leon
+ *
+ *  @note    The io_uring backend: exchanges, pipelining, partial sends, files, timeouts, shutdown; then the same load
+ *           on both backends
+ *
+ */
+
+#include <fmt/core.h>
+#include <thread>
+#include <webserver/server.h>
+#include <webserver/static_files.h>
+#include <utils/printer.h>
+#include <utils/tictok.h>
+#include <http_client.h>
+#include <check.h>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <unistd.h>
+
+namespace test {
+
+using namespace std::chrono_literals;
+namespace fs = std::filesystem;
+
+void hello(const ws::request& req, ws::response& resp) {
+  if (req.path == "/echo") {
+    resp.body = std::string{req.body};
+    return;
+  }
+  if (req.path == "/big") {
+    resp.body = std::string(8 * 1024 * 1024, 'b');
+    return;
+  }
+  resp.body = "Hello, World!";
+}
+
+ws::server_config uring_config(std::size_t num_reactors) {
+  ws::server_config config{"127.0.0.1", 0, num_reactors};
+  config.backend = ws::backend::io_uring;
+  return config;
+}
+
+bool uring_available() {
+  try {
+    ws::server srv{uring_config(1), hello};
+    srv.start();
+    return true;
+  } catch (const std::system_error& e) {
+    fmt::print("io_uring backend unavailable ({}): skipped\n", e.what());
+    return false;
+  }
+}
+
+void test_exchanges() {
+  ws::server srv{uring_config(2), hello};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET / HTTP/1.1\r\nHost: x\r\n\r\n") && client.read_response(resp), "GET");
+  check(resp.status == 200 && resp.body == "Hello, World!", "GET body");
+  check(client.send_all("HEAD / HTTP/1.1\r\n\r\n") && client.read_response(resp, false), "HEAD");
+  check(resp.header("Content-Length") == "13", "HEAD keeps Content-Length");
+  check(client.send_all("POST /echo HTTP/1.1\r\nContent-Length: 5\r\n\r\nab") && client.send_all("cde"), "split body");
+  check(client.read_response(resp) && resp.body == "abcde", "body across receives");
+
+  // one send, many requests, then a request split across sends
+  std::string many;
+  for (int i = 0; i < 300; ++i) {
+    many += "GET / HTTP/1.1\r\n\r\n";
+  }
+  check(client.send_all(many + "GET / HT"), "send 300 + half");
+  bool all{true};
+  for (int i = 0; i < 300; ++i) {
+    all = all && client.read_response(resp) && resp.status == 200;
+  }
+  check(all, "300 pipelined responses");
+  check(client.send_all("TP/1.1\r\n\r\n") && client.read_response(resp) && resp.status == 200, "split request");
+
+  // a client that does not read at first
+  http_client slow{srv.get_port()};
+  check(slow.send_all("GET /big HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\n"), "send to slow client");
+  std::this_thread::sleep_for(100ms);
+  check(slow.read_response(resp) && resp.body.size() == 8 * 1024 * 1024 && resp.body.find_first_not_of('b') == std::string::npos,
+        "large body");
+  check(slow.read_response(resp) && resp.body == "Hello, World!", "pipelined after the large one");
+
+  http_client bad{srv.get_port()};
+  check(bad.send_all("NONSENSE\r\n\r\n") && bad.read_response(resp) && resp.status == 400, "400 on garbage");
+  check(bad.closed_by_peer(), "closed after 400");
+  check(client.send_all("GET / HTTP/1.1\r\nConnection: close\r\n\r\n") && client.read_response(resp), "close");
+  check(client.closed_by_peer(), "closed after Connection: close");
+
+  for (int i = 0; i < 100 && srv.get_num_connections() != 0; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  check(srv.get_num_connections() == 1, "closed connections are reaped");  // `slow` is still open
+}
+
+void test_files() {
+  auto root = fs::temp_directory_path() / fmt::format("ws_uring_{}", ::getpid());
+  fs::create_directories(root);
+  std::string content(3 * 1024 * 1024 + 77, '\0');
+  for (std::size_t i = 0; i < content.size(); ++i) {
+    content[i] = static_cast<char>('a' + (i * 7 + i / 4096) % 26);
+  }
+  std::ofstream{root / "big.bin", std::ios::binary} << content;
+  std::ofstream{root / "small.txt", std::ios::binary} << "small";
+
+  ws::file_cache cache{{root.string()}};
+  ws::server srv{uring_config(1), ws::static_files{cache}};
+  srv.start();
+  http_client client{srv.get_port()};
+  http_response resp;
+  check(client.send_all("GET /big.bin HTTP/1.1\r\n\r\n") && client.read_response(resp), "file");
+  check(resp.body == content, "file spliced intact");
+  // a head, a file, a head, a small file: the links keep them in order
+  check(client.send_all("GET /small.txt HTTP/1.1\r\n\r\nGET /big.bin HTTP/1.1\r\n\r\nGET /small.txt HTTP/1.1\r\n\r\n"), "send");
+  check(client.read_response(resp) && resp.body == "small", "1st");
+  check(client.read_response(resp) && resp.body == content, "2nd");
+  check(client.read_response(resp) && resp.body == "small", "3rd");
+  srv.stop();
+  fs::remove_all(root);
+}
+
+void test_timeouts_and_stop() {
+  auto config = uring_config(1);
+  config.timeouts.idle = 300ms;
+  config.timeouts.read_header = 300ms;
+  ws::server srv{config, hello};
+  srv.start();
+  http_client idle{srv.get_port()};
+  http_client partial{srv.get_port()};
+  http_response resp;
+  check(idle.send_all("GET / HTTP/1.1\r\n\r\n") && idle.read_response(resp), "request");
+  check(partial.send_all("GET / HTTP/1.1\r\nHost"), "partial head");
+  std::this_thread::sleep_for(700ms);
+  check(partial.read_response(resp) && resp.status == 408, "408 on a stalled head");
+  check(idle.closed_by_peer(), "idle connection closed");
+  check(srv.get_buffer_bytes_in_use() == 0, "no buffers held after the timeouts");
+
+  // stopping with connections open, one of them blocked in a send
+  std::vector<std::unique_ptr<http_client>> open;
+  for (int i = 0; i < 20; ++i) {
+    open.push_back(std::make_unique<http_client>(srv.get_port()));
+  }
+  check(open.back()->send_all("GET /big HTTP/1.1\r\n\r\n"), "blocked send");
+  std::this_thread::sleep_for(100ms);
+  srv.stop();
+  check(srv.get_num_reactors() == 0, "stopped");
+}
+
+// the same keep-alive load on both backends
+void bench_backends(ws::backend b, std::size_t depth, std::size_t num_clients, std::chrono::milliseconds duration) {
+  ws::server_config config{"127.0.0.1", 0, 1};
+  config.backend = b;
+  ws::server srv{config, hello};
+  srv.start();
+  std::string batch;
+  for (std::size_t i = 0; i < depth; ++i) {
+    batch += "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  }
+  std::atomic<bool> done{false};
+  std::atomic<std::size_t> completed{0};
+  std::vector<std::thread> clients;
+  for (std::size_t c = 0; c < num_clients; ++c) {
+    clients.emplace_back([&] {
+      http_client client{srv.get_port()};
+      http_response resp;
+      std::size_t n{0};
+      while (!done.load(std::memory_order_relaxed) && client.send_all(batch)) {
+        for (std::size_t i = 0; i < depth && client.read_response(resp); ++i) {
+          ++n;
+        }
+      }
+      completed += n;
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  done = true;
+  for (auto& t : clients) {
+    t.join();
+  }
+  fmt::print("{:<8} clients {:>3}, depth {:>2}: {:>10.0f} req/s\n", b == ws::backend::io_uring ? "io_uring" : "libevent",
+             num_clients, depth, static_cast<double>(completed.load()) / std::chrono::duration<double>(duration).count());
+}
+}  // namespace test
+
+
+int main() {
+  fmt::print("My hardware concurrency -> {}\n", std::thread::hardware_concurrency());
+  DividingLine(Start Tests !);
+  if (!test::uring_available()) {
+    return 0;
+  }
+  DividingLine(test_exchanges);
+  test::test_exchanges();
+
+  DividingLine(test_files);
+  test::test_files();
+
+  DividingLine(test_timeouts_and_stop);
+  test::test_timeouts_and_stop();
+
+  DividingLine(bench_backends);
+  for (auto [clients, depth] : {std::pair<std::size_t, std::size_t>{16, 1}, {4, 16}}) {
+    for (auto b : {ws::backend::libevent, ws::backend::io_uring}) {
+      test::bench_backends(b, depth, clients, std::chrono::milliseconds(500));
+    }
+  }
+  return test::failures;
+}
@@ -9,8 +9,33 @@
 #pragma once
 
 #include <atomic>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace tp {
+
+/*!
+ * Busy-wait helper: `pause` for a while (cheap, polite to the sibling hyper-thread), then give up the time slice
+ * so a preempted lock holder can run.
+ */
+class spin_backoff {
+ private:
+  std::uint32_t count_{0};
+
+ public:
+  void pause() {
+    if (count_++ < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+      _mm_pause();
+#endif
+    } else {
+      std::this_thread::yield();
+    }
+  }
+};
+
 class atomic_spinlock {
  private:
   std::atomic_flag atomic_flag_ = ATOMIC_FLAG_INIT;
@@ -0,0 +1,522 @@
+/** @file    basic_pool.h
+ *  @time    2026/10/18 ~ 下午1:55
+ *  @author  Leon
+ *
+ *  @note    A thread pool composed from a queue, a lock, an idle and a stats policy (see pool_policies.h)
+ *
+ */
+
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <threadpool/pool_policies.h>
+#include <threadpool/blocking_region.h>
+#include <threadpool/future.h>
+
+
+namespace tp {  // thread pool
+
+/*!
+ * The submit / batch / wait logic shared by all pools.
+ * @tparam QueuePolicy where tasks wait and which worker runs them, e.g. `shared_queue`, `double_queue`
+ * @tparam LockPolicy the lock guarding the queues, e.g. `std::mutex`, `tp::atomic_spinlock`
+ * @tparam IdlePolicy what a worker does without tasks, e.g. `sleep_idle`, `spin_idle`
+ * @tparam StatsPolicy instrumentation hooks; `no_stats` compiles them away
+ */
+template <template <typename> typename QueuePolicy, typename LockPolicy, typename IdlePolicy, typename StatsPolicy>
+class basic_pool : private StatsPolicy {  // private base: an empty policy takes no space
+ public:
+  using queue_type = QueuePolicy<LockPolicy>;
+
+ private:
+  struct worker_slot {
+    std::thread thread{};
+    std::atomic<bool> blocked{false};  // inside a tp::blocking_region
+  };
+
+  // Tasks accumulated by one producer thread before being handed to the queue in bulk. It is registered with its
+  // owner, whose workers flush it once due and whose destructor takes it back; `owner` changes under registry_mutex().
+  struct SubmitBuffer {
+    std::atomic<basic_pool*> owner{nullptr};
+    LockPolicy lock{};  // guards the tasks and `oldest`: an idle worker may flush them
+    std::vector<std::function<void()>> tasks{};
+    std::chrono::steady_clock::time_point oldest{};
+
+    SubmitBuffer() = default;
+    SubmitBuffer(const SubmitBuffer&) = delete;
+    SubmitBuffer& operator=(const SubmitBuffer&) = delete;
+
+    ~SubmitBuffer() {  // the producer thread exits: hand what is left to the pool
+      std::lock_guard<std::mutex> reg{registry_mutex()};
+      if (auto* pool = owner.load(std::memory_order_relaxed); pool != nullptr) {
+        pool->release_buffer(*this);
+      }
+    }
+  };
+
+ private:  // Variables
+  queue_type task_queue;
+  IdlePolicy idle;
+  std::vector<worker_slot> workers;  // not movable, so constructed once with its final size
+  // Flag to stop the thread pool forever
+  std::atomic<bool> stop{false};
+  // total number of tasks remaining (queued or running)
+  std::atomic<std::size_t> num_tasks{0};
+  // threads inside wait_for_tasks()
+  std::atomic<std::size_t> num_waiters{0};
+  std::mutex mtx{};
+  std::condition_variable cv_tasks_done{};
+
+  // flush a producer's local buffer once it holds this many tasks
+  std::atomic<std::size_t> buffer_capacity{64};
+  // flush a producer's local buffer once its oldest task waited this many microseconds (checked on submit and by idle
+  // workers); 0 to disable. Atomic, like the capacity: set_buffer_policy may change them while workers read them
+  std::atomic<std::chrono::microseconds::rep> buffer_max_delay{100};
+  // the producers' buffers holding tasks for this pool, guarded by registry_mutex()
+  std::vector<SubmitBuffer*> buffers{};
+  // tasks in those buffers; they are counted in num_tasks already
+  std::atomic<std::size_t> num_buffered{0};
+
+  // Compensating threads: parked until a worker enters a blocking region, then they run its queued tasks
+  std::vector<std::thread> compensators{};
+  std::vector<std::size_t> blocked_workers{};  // blocked workers not covered yet
+  std::size_t idle_compensators{0};  // parked and not yet taken by a blocked worker
+  bool stop_compensators{false};
+  std::mutex compensate_mtx{};
+  std::condition_variable cv_compensate{};
+
+ public:  // constructor and destructor
+  explicit basic_pool(std::size_t num_threads = std::thread::hardware_concurrency())
+      : StatsPolicy{num_threads}, task_queue{num_threads}, idle{num_threads}, workers(num_threads) {
+    for (std::size_t i = 0; i < num_threads; ++i) {
+      workers[i].thread = std::thread{&basic_pool::worker, this, i};
+    }
+  }
+
+  ~basic_pool() {
+    {
+      std::lock_guard<std::mutex> reg{registry_mutex()};
+      while (!buffers.empty()) {  // the producers' buffers must not point here any longer
+        release_buffer(*buffers.back());
+      }
+    }
+    wait_for_tasks();
+    force_to_stop();
+    for (auto& w : workers) {
+      w.thread.join();
+    }
+    {
+      std::unique_lock<std::mutex> lck{compensate_mtx};
+      stop_compensators = true;
+    }
+    cv_compensate.notify_all();
+    for (auto& thread : compensators) {
+      thread.join();
+    }
+  }
+
+  basic_pool(const basic_pool&) = delete;
+  basic_pool& operator=(const basic_pool&) = delete;
+
+ public:  // public functions
+  template <typename F, typename... Args>
+  auto submit_task(F&& func, Args&&... args) {
+    auto [task, future] = package(std::forward<F>(func), std::forward<Args>(args)...);
+    enqueue(std::move(task));
+    return std::move(future);  // a structured binding is not moved implicitly
+  }
+
+  /*!
+   * Submit a task returning a `tp::future`, which takes continuations and works with `tp::when_all` / `tp::when_any`.
+   */
+  template <typename F, typename... Args>
+  auto async(F&& func, Args&&... args) {
+    using return_type = std::invoke_result_t<F, Args...>;
+    auto bound = std::bind(std::forward<F>(func), std::forward<Args>(args)...);
+    struct context {
+      promise<return_type> p;
+      decltype(bound) fn;
+    };
+    auto ctx = std::make_shared<context>(context{promise<return_type>{}, std::move(bound)});
+    auto future = ctx->p.get_future();
+    enqueue([ctx]() { detail::fulfil(ctx->p, ctx->fn); });
+    return future;
+  }
+
+  /*!
+   * Submit a fire-and-forget task; cheaper than `submit_task` as no future is made.
+   */
+  template <typename F>
+  void post(F&& func) {
+    enqueue(std::function<void()>{std::forward<F>(func)});
+  }
+
+  /*!
+   * Submit tasks returning `Ret`, handed to the queue at once.
+   * @note the functions are moved out of the container
+   */
+  template <template <typename> typename Container, typename Ret,
+            typename = std::void_t<decltype(std::begin(std::declval<Container<std::function<Ret()>>>()))>>
+  auto submit_in_batch(Container<std::function<Ret()>>& container) {
+    std::vector<std::future<Ret>> futures;
+    auto tasks = package_all(container, futures);
+    enqueue(tasks.begin(), tasks.end());
+    return futures;
+  }
+
+  /*!
+   * Submit fire-and-forget tasks, handed to the queue at once.
+   */
+  template <typename Container,
+            typename = std::void_t<decltype(std::function<void()>{*std::begin(std::declval<Container>())})>>
+  void submit_in_batch(Container&& container) {
+    enqueue(std::begin(container), std::end(container));
+  }
+
+  /*!
+   * Submit a task to a queue addressed by `key` (e.g. a task group of `fair_queue`); needs `QueuePolicy::push_to`.
+   */
+  template <typename Key, typename F, typename... Args>
+  auto submit_task_to(const Key& key, F&& func, Args&&... args) {
+    auto [task, future] = package(std::forward<F>(func), std::forward<Args>(args)...);
+    idle.notify(push_counted(1, [&] { return task_queue.push_to(key, std::move(task)); }), 1);
+    return std::move(future);
+  }
+
+  template <typename Key, template <typename> typename Container, typename Ret,
+            typename = std::void_t<decltype(std::begin(std::declval<Container<std::function<Ret()>>>()))>>
+  auto submit_in_batch_to(const Key& key, Container<std::function<Ret()>>& container) {
+    std::vector<std::future<Ret>> futures;
+    auto tasks = package_all(container, futures);
+    idle.notify(push_counted(tasks.size(), [&] { return task_queue.push_to(key, tasks.begin(), tasks.end()); }),
+                tasks.size());
+    return futures;
+  }
+
+  /*!
+   * Submit a task through the calling thread's local buffer. The buffer is handed to the queue in one batch when it
+   * holds `capacity` tasks, when its oldest task is older than `max_delay` (see `set_buffer_policy`; an idle worker
+   * flushes it then, so a producer may block on the future), on `flush()`, when the producer thread exits, or when the
+   * pool is destroyed. Buffered tasks count as submitted: `wait_for_tasks()` waits for them.
+   * @attention With `max_delay` 0 a partly filled buffer waits for one of the others; `wait_for_tasks()` from another
+   *            thread than the producer may wait that long.
+   */
+  template <typename F, typename... Args>
+  auto submit_buffered(F&& func, Args&&... args) {
+    auto [task, future] = package(std::forward<F>(func), std::forward<Args>(args)...);
+    buffer_task(std::move(task));
+    return std::move(future);
+  }
+
+  /*!
+   * Submit a task that blocks (file I/O, fsync, ...); it runs inside a `tp::blocking_region`.
+   */
+  template <typename F, typename... Args>
+  auto submit_blocking(F&& func, Args&&... args) {
+    using return_type = std::invoke_result_t<F, Args...>;
+    auto sp_task = std::make_shared<std::packaged_task<return_type()>>(
+        std::bind(std::forward<F>(func), std::forward<Args>(args)...));
+    auto future = sp_task->get_future();
+    enqueue([sp_task]() {
+      blocking_region region;
+      (*sp_task)();
+    });
+    return future;
+  }
+
+  /*!
+   * Hand the tasks buffered by the calling thread to the queue.
+   */
+  void flush() {
+    auto& buffer = local_buffer();
+    if (buffer.owner.load(std::memory_order_relaxed) == this) {
+      std::lock_guard<LockPolicy> lck{buffer.lock};
+      flush_buffer(buffer);
+    }
+  }
+
+  /*!
+   * Set when `submit_buffered` flushes; applies from the next buffered task, so it may be changed while the pool runs.
+   * @param capacity flush after this many buffered tasks (1 disables buffering)
+   * @param max_delay flush once the oldest buffered task waited this long; 0 disables the time limit
+   */
+  void set_buffer_policy(std::size_t capacity, std::chrono::microseconds max_delay) {
+    buffer_capacity.store(std::max<std::size_t>(capacity, 1), std::memory_order_relaxed);
+    buffer_max_delay.store(std::max(max_delay.count(), std::chrono::microseconds::rep{0}), std::memory_order_relaxed);
+  }
+
+  void wait_for_tasks() {
+    flush();  // tasks buffered by the calling thread would never be waited for otherwise
+    std::unique_lock<std::mutex> lck{mtx};
+    num_waiters.fetch_add(1);
+    cv_tasks_done.wait(lck, [this]() { return num_tasks.load() == 0 || stop.load(std::memory_order_relaxed); });
+    num_waiters.fetch_sub(1);
+  }
+
+  void force_to_stop() {
+    stop.store(true, std::memory_order_release);  // abandon remaining tasks!
+    idle.notify_all();
+    { std::lock_guard<std::mutex> lck{mtx}; }
+    cv_tasks_done.notify_all();
+  }
+
+  [[nodiscard]] std::size_t get_num_threads() const { return workers.size(); }
+
+  queue_type& get_queue() { return task_queue; }
+
+  [[nodiscard]] const StatsPolicy& stats_policy() const { return *this; }
+
+ private:
+  template <typename F, typename... Args>
+  static auto package(F&& func, Args&&... args) {
+    using return_type = std::invoke_result_t<F, Args...>;
+    // packaged_task is not copyable but std::function needs a copyable callable, so share it
+    auto sp_task = std::make_shared<std::packaged_task<return_type()>>(
+        std::bind(std::forward<F>(func), std::forward<Args>(args)...));
+    std::future<return_type> future{sp_task->get_future()};
+    return std::make_pair(std::function<void()>{[sp_task]() { (*sp_task)(); }}, std::move(future));
+  }
+
+  template <typename Container, typename Ret>
+  static std::vector<std::function<void()>> package_all(Container& container, std::vector<std::future<Ret>>& futures) {
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(container.size());
+    futures.reserve(container.size());
+    for (auto&& function : container) {
+      auto sp_task = std::make_shared<std::packaged_task<Ret()>>(std::move(function));
+      futures.emplace_back(sp_task->get_future());
+      tasks.emplace_back([sp_task]() { (*sp_task)(); });
+    }
+    return tasks;
+  }
+
+  void prepare_submit(std::size_t n) {
+    num_tasks.fetch_add(n, std::memory_order_relaxed);  // before the push, so a fast worker cannot underflow it
+    StatsPolicy::on_submit(n);
+  }
+
+  // Like prepare_submit then `push`, but a push that throws (e.g. `fair_queue` given an unknown group) takes its tasks
+  // back, or wait_for_tasks() and the destructor would wait for them forever
+  template <typename Push>
+  std::size_t push_counted(std::size_t n, Push&& push) {
+    num_tasks.fetch_add(n, std::memory_order_relaxed);
+    std::size_t target;
+    try {
+      target = push();
+    } catch (...) {
+      finish_tasks(n);
+      throw;
+    }
+    StatsPolicy::on_submit(n);
+    return target;
+  }
+
+  void enqueue(std::function<void()>&& task) {
+    prepare_submit(1);
+    idle.notify(task_queue.push(std::move(task)), 1);
+  }
+
+  template <typename Itr>
+  void enqueue(Itr begin, Itr end) {
+    auto n = static_cast<std::size_t>(std::distance(begin, end));
+    if (n == 0) {
+      return;
+    }
+    prepare_submit(n);
+    idle.notify(task_queue.push(begin, end), n);
+  }
+
+  void finish_tasks(std::size_t n) {
+    if (num_tasks.fetch_sub(n) == n && num_waiters.load() != 0) {
+      { std::lock_guard<std::mutex> lck{mtx}; }
+      cv_tasks_done.notify_all();  // notify the threads who called wait_for_tasks();
+    }
+  }
+
+  auto make_runner(std::size_t index) {
+    return [this, index](std::function<void()>& task) {
+      StatsPolicy::on_task_begin(index);
+      task();
+      StatsPolicy::on_task_end(index);
+    };
+  }
+
+  void worker(std::size_t index) {
+    auto& hooks = detail::current_blocking_hooks();
+    hooks.pool = this;
+    hooks.worker = &workers[index];
+    hooks.enter = [](void* pool, void* slot) {
+      auto* self = static_cast<basic_pool*>(pool);
+      self->enter_blocking(static_cast<std::size_t>(static_cast<worker_slot*>(slot) - self->workers.data()));
+    };
+    hooks.leave = [](void*, void* slot) { static_cast<worker_slot*>(slot)->blocked.store(false, std::memory_order_release); };
+
+    auto run = make_runner(index);
+    auto ready = [this, index] { return stop.load(std::memory_order_relaxed) || task_queue.has_tasks(index); };
+    auto drain_at = std::chrono::steady_clock::time_point::min();  // no buffer is due before
+    while (!stop.load(std::memory_order_acquire)) {
+      if (auto n = task_queue.consume(index, run); n != 0) {
+        finish_tasks(n);
+      } else {
+        StatsPolicy::on_idle(index);
+        if (!buffers_due()) {
+          idle.wait([this, &ready] { return ready() || buffers_due(); });  // woken by the first buffered task too
+        } else {
+          if (std::chrono::steady_clock::now() >= drain_at) {
+            drain_at = drain_buffers();
+          }
+          idle.wait_until(ready, drain_at);
+        }
+      }
+    }
+  }
+
+  // One buffer per producer thread and pool type; it belongs to the pool that last buffered into it.
+  static SubmitBuffer& local_buffer() {
+    thread_local SubmitBuffer buffer{};
+    return buffer;
+  }
+
+  // Guards the buffers' owners and the pools' lists of buffers; shared by the pools of one type, as a buffer moves
+  // between them and a producer may exit while its buffer's pool is being destroyed
+  static std::mutex& registry_mutex() {
+    static std::mutex mtx{};
+    return mtx;
+  }
+
+  // Hand the buffered tasks to the queue; they were counted when buffered. Called with the buffer's lock held.
+  void flush_buffer(SubmitBuffer& buffer) {
+    auto n = buffer.tasks.size();
+    if (n == 0) {
+      return;
+    }
+    idle.notify(task_queue.push(buffer.tasks.begin(), buffer.tasks.end()), n);  // one handoff for the whole batch
+    num_buffered.fetch_sub(n, std::memory_order_relaxed);
+    buffer.tasks.clear();  // keep the capacity for the next batch
+  }
+
+  // Flush `buffer` and forget it; called with registry_mutex() held
+  void release_buffer(SubmitBuffer& buffer) {
+    {
+      std::lock_guard<LockPolicy> lck{buffer.lock};
+      flush_buffer(buffer);
+    }
+    buffers.erase(std::find(buffers.begin(), buffers.end(), &buffer));
+    buffer.owner.store(nullptr, std::memory_order_relaxed);
+  }
+
+  void buffer_task(std::function<void()>&& task) {
+    auto& buffer = local_buffer();
+    if (buffer.owner.load(std::memory_order_relaxed) != this) {  // the producer switched pools
+      std::lock_guard<std::mutex> reg{registry_mutex()};
+      if (auto* old = buffer.owner.load(std::memory_order_relaxed); old != nullptr) {
+        old->release_buffer(buffer);  // hand the old batch over first
+      }
+      buffers.push_back(&buffer);
+      buffer.owner.store(this, std::memory_order_relaxed);
+    }
+
+    prepare_submit(1);
+    auto capacity = buffer_capacity.load(std::memory_order_relaxed);
+    auto delay = buffer_delay();
+    std::lock_guard<LockPolicy> lck{buffer.lock};
+    if (buffer.tasks.capacity() < capacity) {
+      buffer.tasks.reserve(capacity);
+    }
+    if (buffer.tasks.empty()) {
+      buffer.oldest = std::chrono::steady_clock::now();
+    }
+    buffer.tasks.emplace_back(std::move(task));
+    if (num_buffered.fetch_add(1) == 0 && delay.count() != 0) {
+      idle.notify(any_worker, 1);  // a sleeping worker has to watch the deadline
+    }
+
+    if (buffer.tasks.size() >= capacity ||
+        (delay.count() != 0 && std::chrono::steady_clock::now() - buffer.oldest >= delay)) {
+      flush_buffer(buffer);
+    }
+  }
+
+  [[nodiscard]] std::chrono::microseconds buffer_delay() const {
+    return std::chrono::microseconds{buffer_max_delay.load(std::memory_order_relaxed)};
+  }
+
+  // Whether some producer's buffer will be due
+  [[nodiscard]] bool buffers_due() const {
+    return buffer_max_delay.load(std::memory_order_relaxed) != 0 && num_buffered.load(std::memory_order_relaxed) != 0;
+  }
+
+  /*!
+   * Flush the buffers whose oldest task waited `max_delay`, so a producer blocking on a buffered task's future does not
+   * wait forever; called by idle workers.
+   * @return when to look again: no buffer is due before, including those started after this call
+   */
+  std::chrono::steady_clock::time_point drain_buffers() {
+    auto now = std::chrono::steady_clock::now();
+    auto delay = buffer_delay();
+    auto next = now + delay;
+    std::lock_guard<std::mutex> reg{registry_mutex()};
+    for (auto* buffer : buffers) {
+      std::lock_guard<LockPolicy> lck{buffer->lock};
+      if (buffer->tasks.empty()) {
+        continue;
+      }
+      if (auto due = buffer->oldest + delay; due > now) {
+        next = std::min(next, due);
+      } else {
+        flush_buffer(*buffer);
+      }
+    }
+    return next;
+  }
+
+  // Hand a blocked worker to a parked compensating thread, or start one if all are busy or taken already. The parked
+  // one is taken here, not when it wakes: workers blocking at once must not all count on the same one.
+  void enter_blocking(std::size_t index) {
+    workers[index].blocked.store(true, std::memory_order_release);
+    std::unique_lock<std::mutex> lck{compensate_mtx};
+    blocked_workers.push_back(index);
+    if (idle_compensators == 0) {
+      compensators.emplace_back(&basic_pool::compensator, this);
+    } else {
+      --idle_compensators;
+      lck.unlock();
+      cv_compensate.notify_one();
+    }
+  }
+
+  void compensator() {
+    std::unique_lock<std::mutex> lck{compensate_mtx};
+    while (true) {
+      // started for a blocked worker, or parked until one takes this thread (see enter_blocking)
+      cv_compensate.wait(lck, [this] { return !blocked_workers.empty() || stop_compensators; });
+      if (blocked_workers.empty()) {  // stopping
+        break;
+      }
+      auto index = blocked_workers.back();
+      blocked_workers.pop_back();
+      lck.unlock();
+
+      auto run = make_runner(index);
+      while (workers[index].blocked.load(std::memory_order_acquire)) {  // retire (park again) once the worker is back
+        if (auto n = task_queue.steal(index, run); n != 0) {
+          finish_tasks(n);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      lck.lock();
+      ++idle_compensators;
+    }
+  }
+};
+
+}  // namespace tp
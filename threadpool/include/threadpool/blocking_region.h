@@ -0,0 +1,62 @@
+/** @file    blocking_region.h
+ *  @time    2026/10/18 ~ 上午11:05
+ *  @author  Leon
+ *
+ *  @note    A guard telling the pool that the current worker is about to block (file I/O, fsync, ...)
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace tp {
+
+namespace detail {
+
+/*!
+ * Installed by a pool in each of its worker threads; left empty in any other thread.
+ */
+struct blocking_hooks {
+  void* pool{nullptr};
+  void* worker{nullptr};
+  void (*enter)(void* pool, void* worker){nullptr};
+  void (*leave)(void* pool, void* worker){nullptr};
+  std::size_t depth{0};  // nested regions only notify the pool once
+};
+
+inline blocking_hooks& current_blocking_hooks() {
+  thread_local blocking_hooks hooks{};
+  return hooks;
+}
+
+}  // namespace detail
+
+
+/*!
+ * RAII guard around a blocking call made from a pool task. While it lives, the pool lets a compensating thread run
+ * the tasks queued behind the blocked worker, so CPU-bound throughput does not drop. Outside a pool worker it does
+ * nothing, so library code may use it unconditionally.
+ * Usage: `{ tp::blocking_region region; ::fsync(fd); }`
+ */
+class blocking_region {
+ public:
+  blocking_region() {
+    auto& hooks = detail::current_blocking_hooks();
+    if (hooks.enter != nullptr && hooks.depth++ == 0) {
+      hooks.enter(hooks.pool, hooks.worker);
+    }
+  }
+
+  ~blocking_region() {
+    auto& hooks = detail::current_blocking_hooks();
+    if (hooks.leave != nullptr && --hooks.depth == 0) {
+      hooks.leave(hooks.pool, hooks.worker);
+    }
+  }
+
+  blocking_region(const blocking_region&) = delete;
+  blocking_region& operator=(const blocking_region&) = delete;
+};
+
+}  // namespace tp
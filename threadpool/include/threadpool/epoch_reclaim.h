@@ -0,0 +1,233 @@
+/** @file    epoch_reclaim.h
+ *  @time    2026/10/18 ~ 下午8:10
+ *  @author  Leon
+ *
+ *  @note    Epoch-based reclamation: RCU-like read-side sections and deferred deletion for read-mostly data
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+namespace tp {
+
+class epoch_domain;
+
+namespace detail {
+
+// Domains alive now, by id: a thread exiting after its domain was destroyed must not touch the domain's records
+inline std::mutex& epoch_registry_mtx() {
+  static std::mutex mtx;
+  return mtx;
+}
+
+inline std::unordered_map<std::uint64_t, epoch_domain*>& live_epoch_domains() {
+  static std::unordered_map<std::uint64_t, epoch_domain*> domains;
+  return domains;
+}
+
+}  // namespace detail
+
+
+/*!
+ * Readers enter a critical section with `epoch_domain::guard` (two stores to their own cache line, no shared
+ * writes) and may use any object reachable from shared pointers until they leave. Writers unlink an object, then
+ * `retire()` it; it is deleted once every thread has left the epoch it could have been seen in.
+ * Usage:
+ *   std::atomic<config*> current;            // published with current.exchange(new_config) + retire(old)
+ *   { tp::epoch_domain::guard g{domain}; use(current.load(std::memory_order_acquire)); }
+ * @attention The domain must outlive the guards and retire() calls made on it.
+ */
+class epoch_domain {
+ private:
+  static constexpr std::uint64_t inactive{~std::uint64_t{0}};
+  // try to advance the global epoch after this many retires by one thread
+  static constexpr std::size_t advance_period{64};
+
+  struct retired {
+    void* ptr;
+    void (*deleter)(void*);
+  };
+
+  struct alignas(64) record {
+    std::atomic<std::uint64_t> epoch{inactive};  // the epoch seen on entering; `inactive` outside a section
+    std::atomic<bool> owned{false};
+    std::size_t nesting{0};
+    std::size_t retire_count{0};
+    // objects retired in epoch e wait in limbo[e % 3]; they are safe once the global epoch reached e + 2
+    std::vector<retired> limbo[3]{};
+    std::uint64_t limbo_epoch[3]{0, 0, 0};
+  };
+
+  // this thread's records, one per domain it used
+  struct thread_records {
+    std::vector<std::pair<std::uint64_t, record*>> entries{};
+
+    ~thread_records() {
+      std::lock_guard<std::mutex> lck{detail::epoch_registry_mtx()};
+      for (auto& [id, rec] : entries) {
+        if (detail::live_epoch_domains().count(id) != 0) {
+          rec->owned.store(false, std::memory_order_release);  // its limbo is taken over by the next owner
+        }
+      }
+    }
+  };
+
+  std::uint64_t id_;
+  alignas(64) std::atomic<std::uint64_t> global_epoch_{0};
+  std::mutex records_mtx_{};
+  std::deque<record> records_{};  // a deque keeps addresses stable as threads register
+
+  static std::uint64_t next_id() {
+    static std::atomic<std::uint64_t> id{0};
+    return ++id;
+  }
+
+  record& local_record() {
+    thread_local thread_records mine{};
+    for (auto& [id, rec] : mine.entries) {  // usually a single entry
+      if (id == id_) {
+        return *rec;
+      }
+    }
+    record* rec{nullptr};
+    {
+      std::lock_guard<std::mutex> lck{records_mtx_};
+      for (auto& r : records_) {
+        bool expected{false};
+        if (r.owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+          rec = &r;
+          break;
+        }
+      }
+      if (rec == nullptr) {
+        rec = &records_.emplace_back();
+        rec->owned.store(true, std::memory_order_relaxed);
+      }
+    }
+    mine.entries.emplace_back(id_, rec);
+    return *rec;
+  }
+
+  static void free_list(std::vector<retired>& list) {
+    for (auto& r : list) {
+      r.deleter(r.ptr);
+    }
+    list.clear();
+  }
+
+ public:
+  epoch_domain() : id_(next_id()) {
+    std::lock_guard<std::mutex> lck{detail::epoch_registry_mtx()};
+    detail::live_epoch_domains()[id_] = this;
+  }
+
+  ~epoch_domain() {
+    {
+      std::lock_guard<std::mutex> lck{detail::epoch_registry_mtx()};
+      detail::live_epoch_domains().erase(id_);
+    }
+    for (auto& r : records_) {
+      for (auto& list : r.limbo) {
+        free_list(list);
+      }
+    }
+  }
+
+  epoch_domain(const epoch_domain&) = delete;
+  epoch_domain& operator=(const epoch_domain&) = delete;
+
+  /*!
+   * A read-side critical section; may be nested
+   */
+  class guard {
+   private:
+    record* rec_;
+
+   public:
+    explicit guard(epoch_domain& domain) : rec_(&domain.local_record()) {
+      if (rec_->nesting++ == 0) {
+        rec_->epoch.store(domain.global_epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // the announcement is visible before any shared pointer is read (pairs with the scan in try_advance)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+    }
+
+    ~guard() {
+      if (--rec_->nesting == 0) {
+        rec_->epoch.store(inactive, std::memory_order_release);
+      }
+    }
+
+    guard(const guard&) = delete;
+    guard& operator=(const guard&) = delete;
+  };
+
+  /*!
+   * Delete `ptr` once no reader can still hold it; call after unlinking it from every shared pointer.
+   */
+  template <typename T>
+  void retire(T* ptr) {
+    retire(static_cast<void*>(ptr), [](void* p) { delete static_cast<T*>(p); });
+  }
+
+  void retire(void* ptr, void (*deleter)(void*)) {
+    auto& rec = local_record();
+    std::atomic_thread_fence(std::memory_order_seq_cst);  // the unlink is visible before the epoch is read
+    auto epoch = global_epoch_.load(std::memory_order_relaxed);
+    auto bucket = epoch % 3;
+    if (rec.limbo_epoch[bucket] != epoch) {  // the bucket holds objects from epoch - 3 or older: all safe
+      free_list(rec.limbo[bucket]);
+      rec.limbo_epoch[bucket] = epoch;
+    }
+    rec.limbo[bucket].push_back({ptr, deleter});
+    if (++rec.retire_count % advance_period == 0) {
+      try_advance();
+    }
+  }
+
+  /*!
+   * Advance the global epoch if every thread inside a section has seen the current one.
+   * @return whether it advanced
+   */
+  bool try_advance() {
+    auto epoch = global_epoch_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      std::lock_guard<std::mutex> lck{records_mtx_};
+      for (auto& r : records_) {
+        auto e = r.epoch.load(std::memory_order_relaxed);
+        if (e != inactive && e != epoch) {
+          return false;  // a reader is still in the previous epoch
+        }
+      }
+    }
+    return global_epoch_.compare_exchange_strong(epoch, epoch + 1);
+  }
+
+  /*!
+   * Free what this thread retired, as far as it is safe now; advances the epoch when possible.
+   * Calling it outside any guard with no other readers frees everything.
+   */
+  void reclaim() {
+    try_advance();
+    try_advance();
+    auto& rec = local_record();
+    auto epoch = global_epoch_.load(std::memory_order_relaxed);
+    for (std::size_t b = 0; b < 3; ++b) {
+      if (!rec.limbo[b].empty() && rec.limbo_epoch[b] + 2 <= epoch) {
+        free_list(rec.limbo[b]);
+      }
+    }
+  }
+
+  [[nodiscard]] std::uint64_t get_epoch() const { return global_epoch_.load(std::memory_order_relaxed); }
+};
+
+}  // namespace tp
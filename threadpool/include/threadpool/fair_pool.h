@@ -0,0 +1,257 @@
+/** @file    fair_pool.h
+ *  @time    2026/10/18 ~ 上午10:20
+ *  @author  Leon
+ *
+ *  @note    A queue policy and a thread pool sharing worker time among weighted task groups (tenants)
+ *
+ */
+
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <threadpool/basic_pool.h>
+
+
+namespace tp {  // thread pool
+
+/*!
+ * A snapshot of one task group
+ */
+struct GroupStats {
+  std::string name;
+  std::size_t weight;
+  std::size_t queued;              // tasks waiting in the group's queue
+  std::size_t running;             // tasks being run by workers now
+  std::size_t completed;           // tasks finished since the group was added
+  std::chrono::nanoseconds busy;   // worker time consumed by the group's tasks
+};
+
+
+/*!
+ * A queue policy with one queue per weighted task group; workers pick the next group by deficit round robin,
+ * charging each group the worker time its tasks actually used.
+ * @tparam Lock
+ */
+template <typename Lock>
+class fair_queue {
+ public:
+  using group_id = std::size_t;
+  static constexpr group_id default_group{0};
+
+ private:
+  struct TaskGroup {
+    std::string name;
+    std::size_t weight;
+    std::queue<std::function<void()>> tasks{};  // guarded by lock
+    // Worker time (ns) the group may still use in the current round; refilled by `quantum * weight` per visit
+    std::atomic<std::int64_t> deficit{0};
+    std::atomic<std::size_t> running{0};
+    std::atomic<std::size_t> completed{0};
+    std::atomic<std::int64_t> busy_ns{0};
+
+    TaskGroup(std::string n, std::size_t w) : name(std::move(n)), weight(w) {}
+  };
+
+ private:
+  // The groups; a deque keeps references valid while groups are added
+  std::deque<TaskGroup> groups{};
+  // The group the round robin currently serves
+  std::size_t cursor{0};
+  // Worker time granted to a group of weight 1 per round
+  std::chrono::nanoseconds quantum{std::chrono::microseconds{100}};
+  Lock lock{};
+  // tasks queued in all groups
+  std::atomic<std::size_t> num_queued{0};
+
+ public:
+  explicit fair_queue(std::size_t /*num_workers*/) { groups.emplace_back("default", 1); }
+
+  group_id add_group(std::string name, std::size_t weight) {
+    std::unique_lock<Lock> lck{lock};
+    groups.emplace_back(std::move(name), std::max<std::size_t>(weight, 1));
+    return groups.size() - 1;
+  }
+
+  std::optional<group_id> find_group(std::string_view name) {
+    std::unique_lock<Lock> lck{lock};
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+      if (groups[i].name == name) {
+        return i;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void set_weight(group_id group, std::size_t weight) {
+    std::unique_lock<Lock> lck{lock};
+    groups.at(group).weight = std::max<std::size_t>(weight, 1);
+  }
+
+  void set_quantum(std::chrono::nanoseconds q) {
+    std::unique_lock<Lock> lck{lock};
+    quantum = std::max(q, std::chrono::nanoseconds{1});
+  }
+
+  std::size_t push(std::function<void()>&& task) { return push_to(default_group, std::move(task)); }
+
+  template <typename Itr>
+  std::size_t push(Itr begin, Itr end) {
+    return push_to(default_group, begin, end);
+  }
+
+  std::size_t push_to(group_id group, std::function<void()>&& task) {
+    std::unique_lock<Lock> lck{lock};
+    groups.at(group).tasks.emplace(std::move(task));
+    num_queued.fetch_add(1, std::memory_order_relaxed);
+    return any_worker;
+  }
+
+  template <typename Itr>
+  std::size_t push_to(group_id group, Itr begin, Itr end) {
+    std::size_t n{0};
+    std::unique_lock<Lock> lck{lock};
+    auto& queue = groups.at(group).tasks;
+    for (; begin != end; ++begin, ++n) {
+      queue.emplace(std::move(*begin));
+    }
+    num_queued.fetch_add(n, std::memory_order_relaxed);
+    return any_worker;
+  }
+
+  template <typename Run>
+  std::size_t consume(std::size_t /*index*/, Run&& run) {
+    std::function<void()> task;
+    TaskGroup* group;
+    {
+      std::unique_lock<Lock> lck{lock};
+      if (num_queued.load(std::memory_order_relaxed) == 0) {
+        return 0;
+      }
+      group = &pick_group();
+      task = std::move(group->tasks.front());
+      group->tasks.pop();
+      num_queued.fetch_sub(1, std::memory_order_relaxed);
+      group->running.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    run(task);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    group->deficit.fetch_sub(elapsed, std::memory_order_relaxed);  // charge the time actually used
+    group->busy_ns.fetch_add(elapsed, std::memory_order_relaxed);
+    group->completed.fetch_add(1, std::memory_order_relaxed);
+    group->running.fetch_sub(1, std::memory_order_relaxed);
+    return 1;
+  }
+
+  template <typename Run>
+  std::size_t steal(std::size_t index, Run&& run) {
+    return consume(index, std::forward<Run>(run));
+  }
+
+  [[nodiscard]] bool has_tasks(std::size_t /*index*/) const { return num_queued.load(std::memory_order_relaxed) != 0; }
+
+  [[nodiscard]] GroupStats get_group_stats(group_id group) {
+    std::unique_lock<Lock> lck{lock};
+    return make_stats(groups.at(group));
+  }
+
+  [[nodiscard]] std::vector<GroupStats> get_stats() {
+    std::vector<GroupStats> stats;
+    std::unique_lock<Lock> lck{lock};
+    stats.reserve(groups.size());
+    for (const auto& g : groups) {
+      stats.push_back(make_stats(g));
+    }
+    return stats;
+  }
+
+ private:
+  static GroupStats make_stats(const TaskGroup& g) {
+    return {g.name,
+            g.weight,
+            g.tasks.size(),
+            g.running.load(std::memory_order_relaxed),
+            g.completed.load(std::memory_order_relaxed),
+            std::chrono::nanoseconds{g.busy_ns.load(std::memory_order_relaxed)}};
+  }
+
+  /*!
+   * Deficit round robin over the non-empty groups; must be called with the lock held and tasks queued.
+   * Empty groups are skipped, so a lone busy group still gets every idle worker.
+   */
+  TaskGroup& pick_group() {
+    while (true) {
+      auto& group = groups[cursor];
+      const auto share = static_cast<std::int64_t>(quantum.count()) * static_cast<std::int64_t>(group.weight);
+      if (!group.tasks.empty()) {
+        auto deficit = group.deficit.load(std::memory_order_relaxed);
+        if (deficit > 0) {
+          return group;
+        }
+        if (deficit < -4 * share) {  // a very long task must not starve its group for many rounds
+          group.deficit.store(-4 * share, std::memory_order_relaxed);
+        }
+      } else {
+        group.deficit.store(0, std::memory_order_relaxed);  // idle groups do not bank credit
+      }
+
+      cursor = (cursor + 1) % groups.size();
+      auto& next = groups[cursor];
+      if (!next.tasks.empty()) {
+        next.deficit.fetch_add(static_cast<std::int64_t>(quantum.count()) * static_cast<std::int64_t>(next.weight),
+                               std::memory_order_relaxed);
+      }
+    }
+  }
+};
+
+
+/*!
+ * Workers share weighted task groups (tenants): under contention each group gets worker time in proportion to its
+ * weight, while a lone busy group may use every idle worker.
+ */
+class FairThreadPool : public basic_pool<fair_queue, std::mutex, sleep_idle, no_stats> {
+ public:
+  using group_id = fair_queue<std::mutex>::group_id;
+  static constexpr group_id default_group{fair_queue<std::mutex>::default_group};
+
+  using basic_pool::basic_pool;
+
+  /*!
+   * Add a named group; under contention it gets worker time in proportion to its weight.
+   * @param name
+   * @param weight relative share, at least 1
+   * @return the id to submit tasks with
+   */
+  group_id add_group(std::string name, std::size_t weight = 1) { return get_queue().add_group(std::move(name), weight); }
+
+  std::optional<group_id> find_group(std::string_view name) { return get_queue().find_group(name); }
+
+  void set_weight(group_id group, std::size_t weight) { get_queue().set_weight(group, weight); }
+
+  /*!
+   * Set the worker time a group of weight 1 may use before the next group is served.
+   * Smaller is fairer over short intervals; larger touches the round robin less often.
+   */
+  void set_quantum(std::chrono::nanoseconds q) { get_queue().set_quantum(q); }
+
+  [[nodiscard]] GroupStats get_group_stats(group_id group) { return get_queue().get_group_stats(group); }
+
+  [[nodiscard]] std::vector<GroupStats> get_stats() { return get_queue().get_stats(); }
+};
+
+}  // namespace tp
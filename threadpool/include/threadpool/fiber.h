@@ -0,0 +1,345 @@
+/** @file    fiber.h
+ *  @time    2026/10/18 ~ 下午5:20
+ *  @author  Leon
+ *
+ *  @note    Stackful fibers (ucontext) running on pool workers, for blocking-style code that cannot be a coroutine
+ *
+ *  @attention Linux only. A parked fiber may resume on another worker, so do not keep references to thread_local
+ *             objects across `this_fiber::await` / `wait_readable` / `yield`.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <system_error>
+#include <condition_variable>
+#include <cerrno>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <threadpool/future.h>
+
+
+namespace tp {  // thread pool
+
+/*!
+ * Fiber stacks: mmap'ed with a PROT_NONE guard page below, so an overflow faults instead of corrupting memory,
+ * and recycled through a free list since mmap/mprotect/munmap are syscalls.
+ */
+class stack_pool {
+ public:
+  struct stack {
+    void* base{nullptr};  // lowest usable address, just above the guard page
+    std::size_t size{0};
+  };
+
+ private:
+  std::size_t page_size{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))};
+  std::size_t stack_size;
+  std::size_t max_cached;
+  std::mutex mtx{};
+  std::vector<void*> free_stacks{};  // mapping addresses (guard page included)
+
+ public:
+  explicit stack_pool(std::size_t size, std::size_t max_cached_stacks = 1024)
+      : stack_size((size + page_size - 1) / page_size * page_size), max_cached(max_cached_stacks) {}
+
+  ~stack_pool() {
+    for (auto* mapping : free_stacks) {
+      ::munmap(mapping, stack_size + page_size);
+    }
+  }
+
+  stack_pool(const stack_pool&) = delete;
+  stack_pool& operator=(const stack_pool&) = delete;
+
+  stack allocate() {
+    {
+      std::lock_guard<std::mutex> lck{mtx};
+      if (!free_stacks.empty()) {
+        auto* mapping = free_stacks.back();
+        free_stacks.pop_back();
+        return {static_cast<char*>(mapping) + page_size, stack_size};
+      }
+    }
+    void* mapping = ::mmap(nullptr, stack_size + page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK,
+                           -1, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::system_error{errno, std::generic_category(), "mmap fiber stack"};
+    }
+    if (::mprotect(mapping, page_size, PROT_NONE) != 0) {  // stacks grow down: the guard page is the lowest one
+      ::munmap(mapping, stack_size + page_size);
+      throw std::system_error{errno, std::generic_category(), "mprotect guard page"};
+    }
+    return {static_cast<char*>(mapping) + page_size, stack_size};
+  }
+
+  void release(stack s) {
+    void* mapping = static_cast<char*>(s.base) - page_size;
+    {
+      std::lock_guard<std::mutex> lck{mtx};
+      if (free_stacks.size() < max_cached) {
+        free_stacks.push_back(mapping);
+        return;
+      }
+    }
+    ::munmap(mapping, stack_size + page_size);
+  }
+};
+
+
+class fiber_scheduler;
+
+namespace detail {
+
+struct fiber {
+  ucontext_t ctx{};
+  stack_pool::stack stack{};
+  std::function<void()> body{};
+  fiber_scheduler* scheduler{nullptr};
+  ucontext_t* worker_ctx{nullptr};  // where the worker running the fiber waits for it to park or finish
+  std::function<void()> on_park{};  // run by the worker once the fiber is switched out (registers the wake-up)
+  bool finished{false};
+};
+
+// not inlined, so the thread_local address is recomputed after a fiber migrates to another worker
+[[gnu::noinline]] inline fiber*& current_fiber() {
+  thread_local fiber* f{nullptr};
+  return f;
+}
+
+}  // namespace detail
+
+
+/*!
+ * Runs fibers on the workers of a pool. A fiber that awaits a `tp::future` or an fd readiness event parks, and its
+ * worker goes on with other tasks and fibers; the fiber is posted back to the pool when the event happens.
+ * Usage:
+ *   tp::SteadyThreadPool pool{4};
+ *   tp::fiber_scheduler fibers{pool};
+ *   auto f = fibers.spawn([&] { return tp::this_fiber::await(pool.async(work)) + 1; });
+ */
+class fiber_scheduler {
+ private:
+  void* pool;
+  void (*post_to_pool)(void* pool, std::function<void()>&& task);
+  stack_pool stacks;
+  // fibers spawned and not finished
+  std::atomic<std::size_t> num_fibers{0};
+  std::mutex mtx{};
+  std::condition_variable cv_fibers_done{};
+
+  // fd readiness, polled by one thread created on first use
+  int epoll_fd{-1};
+  int wake_fd{-1};
+  std::thread poller{};
+  std::once_flag poller_started{};
+
+ public:
+  /*!
+   * @param pool any tp pool; fibers run as its tasks
+   * @param stack_size usable bytes per fiber stack
+   */
+  template <typename Pool>
+  explicit fiber_scheduler(Pool& p, std::size_t stack_size = 64 * 1024)
+      : pool(&p),
+        post_to_pool([](void* pl, std::function<void()>&& task) { static_cast<Pool*>(pl)->post(std::move(task)); }),
+        stacks(stack_size) {}
+
+  /*!
+   * Waits for every fiber to finish; a fiber parked forever (e.g. on an fd that never becomes ready) blocks this.
+   */
+  ~fiber_scheduler() {
+    wait_for_fibers();
+    if (poller.joinable()) {
+      std::uint64_t one{1};
+      [[maybe_unused]] auto n = ::write(wake_fd, &one, sizeof(one));
+      poller.join();
+      ::close(wake_fd);
+      ::close(epoll_fd);
+    }
+  }
+
+  fiber_scheduler(const fiber_scheduler&) = delete;
+  fiber_scheduler& operator=(const fiber_scheduler&) = delete;
+
+  /*!
+   * Start `func(args...)` in a new fiber.
+   * @return a tp::future of its result
+   */
+  template <typename F, typename... Args>
+  auto spawn(F&& func, Args&&... args) {
+    using return_type = std::invoke_result_t<F, Args...>;
+    auto bound = std::bind(std::forward<F>(func), std::forward<Args>(args)...);
+    struct context {
+      promise<return_type> p;
+      decltype(bound) fn;
+    };
+    auto ctx = std::make_shared<context>(context{promise<return_type>{}, std::move(bound)});
+    auto result = ctx->p.get_future();
+
+    auto* f = new detail::fiber{};
+    f->scheduler = this;
+    f->body = [ctx]() { detail::fulfil(ctx->p, ctx->fn); };  // never throws out of the fiber
+    f->stack = stacks.allocate();
+    ::getcontext(&f->ctx);
+    f->ctx.uc_stack.ss_sp = f->stack.base;
+    f->ctx.uc_stack.ss_size = f->stack.size;
+    f->ctx.uc_link = nullptr;
+    ::makecontext(&f->ctx, &fiber_scheduler::trampoline, 0);
+
+    num_fibers.fetch_add(1, std::memory_order_relaxed);
+    schedule(f);
+    return result;
+  }
+
+  void wait_for_fibers() {
+    std::unique_lock<std::mutex> lck{mtx};
+    cv_fibers_done.wait(lck, [this] { return num_fibers.load() == 0; });
+  }
+
+  [[nodiscard]] std::size_t get_num_fibers() const { return num_fibers.load(std::memory_order_relaxed); }
+
+  /// ---- used by tp::this_fiber ----
+
+  // Post the fiber to the pool; a worker resumes it
+  void schedule(detail::fiber* f) {
+    post_to_pool(pool, [this, f]() { run(f); });
+  }
+
+  /*!
+   * Switch out of the running fiber; `on_park` runs on the worker afterwards and must arrange a later `schedule()`.
+   */
+  static void park(std::function<void()>&& on_park) {
+    auto* f = detail::current_fiber();
+    f->on_park = std::move(on_park);
+    ::swapcontext(&f->ctx, f->worker_ctx);
+    // resumed, maybe on another worker
+  }
+
+  /*!
+   * Park the running fiber until `fd` is ready for `events` (EPOLLIN / EPOLLOUT).
+   */
+  void wait_fd(int fd, std::uint32_t events) {
+    std::call_once(poller_started, [this] { start_poller(); });
+    auto* self = detail::current_fiber();
+    int error{0};  // lives on the parked fiber's stack
+    park([this, self, fd, events, &error]() {
+      epoll_event ev{};
+      ev.events = events | EPOLLONESHOT;
+      ev.data.ptr = self;
+      if (::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) != 0 &&
+          (errno != ENOENT || ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)) {
+        error = errno;
+        schedule(self);
+      }
+    });
+    if (error != 0) {
+      throw std::system_error{error, std::generic_category(), "epoll_ctl"};
+    }
+  }
+
+ private:
+  static void trampoline() {
+    auto* f = detail::current_fiber();
+    f->body();
+    f->finished = true;
+    ::swapcontext(&f->ctx, f->worker_ctx);  // never comes back
+  }
+
+  void run(detail::fiber* f) {
+    ucontext_t worker_ctx;
+    f->worker_ctx = &worker_ctx;
+    detail::current_fiber() = f;
+    ::swapcontext(&worker_ctx, &f->ctx);
+    detail::current_fiber() = nullptr;
+
+    if (f->finished) {
+      stacks.release(f->stack);
+      delete f;
+      if (num_fibers.fetch_sub(1) == 1) {
+        { std::lock_guard<std::mutex> lck{mtx}; }
+        cv_fibers_done.notify_all();
+      }
+    } else {
+      auto on_park = std::move(f->on_park);
+      on_park();  // the fiber is fully switched out now, so it may be resumed right away
+    }
+  }
+
+  void start_poller() {
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd < 0 || wake_fd < 0) {
+      throw std::system_error{errno, std::generic_category(), "fiber poller"};
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;  // the stop signal
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+    poller = std::thread{[this]() {
+      epoll_event events[64];
+      while (true) {
+        int n = ::epoll_wait(epoll_fd, events, 64, -1);
+        for (int i = 0; i < n; ++i) {
+          if (events[i].data.ptr == nullptr) {
+            return;
+          }
+          schedule(static_cast<detail::fiber*>(events[i].data.ptr));
+        }
+      }
+    }};
+  }
+};
+
+
+namespace this_fiber {
+
+[[nodiscard]] inline bool in_fiber() { return detail::current_fiber() != nullptr; }
+
+/*!
+ * Wait for a tp::future: parks the fiber (the worker runs other tasks meanwhile); outside a fiber it just blocks.
+ */
+template <typename T>
+T await(future<T> f) {
+  if (auto* self = detail::current_fiber(); self != nullptr) {
+    auto state = detail::future_access::state(f);
+    if (!state->is_ready()) {
+      fiber_scheduler::park([self, state]() { state->set_continuation([self] { self->scheduler->schedule(self); }); });
+    }
+  }
+  return f.get();
+}
+
+/*!
+ * Give the worker to the other queued tasks and fibers.
+ */
+inline void yield() {
+  if (auto* self = detail::current_fiber(); self != nullptr) {
+    fiber_scheduler::park([self]() { self->scheduler->schedule(self); });
+  } else {
+    std::this_thread::yield();
+  }
+}
+
+/*!
+ * Park until `fd` is readable; must be called from a fiber.
+ */
+inline void wait_readable(int fd) { detail::current_fiber()->scheduler->wait_fd(fd, EPOLLIN); }
+
+/*!
+ * Park until `fd` is writable; must be called from a fiber.
+ */
+inline void wait_writable(int fd) { detail::current_fiber()->scheduler->wait_fd(fd, EPOLLOUT); }
+
+}  // namespace this_fiber
+
+}  // namespace tp
@@ -0,0 +1,354 @@
+/** @file    future.h
+ *  @time    2026/10/18 ~ 下午4:05
+ *  @author  Leon
+ *
+ *  @note    A future with continuations, and when_all / when_any that never park a thread
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <variant>
+#include <exception>
+#include <condition_variable>
+#include <functional>
+#include <future>  // std::future_error
+
+
+namespace tp {  // thread pool
+
+template <typename T>
+class future;
+
+template <typename T>
+class promise;
+
+namespace detail {
+
+/*!
+ * The state shared by a promise and its future. It holds at most one continuation, run by whichever thread
+ * completes the state (or immediately by the registering thread if it is complete already).
+ */
+template <typename T>
+class shared_state {
+ public:
+  using storage_type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+ private:
+  std::mutex mtx{};
+  std::condition_variable cv{};
+  bool ready{false};
+  std::optional<storage_type> value{};
+  std::exception_ptr error{};
+  std::function<void()> continuation{};
+
+  template <typename Set>
+  void complete(Set&& set) {
+    std::function<void()> cont;
+    {
+      std::lock_guard<std::mutex> lck{mtx};
+      if (ready) {
+        throw std::future_error{std::future_errc::promise_already_satisfied};
+      }
+      set();
+      ready = true;
+      cont = std::move(continuation);
+    }
+    cv.notify_all();
+    if (cont) {
+      cont();  // outside the lock: it may complete other states
+    }
+  }
+
+ public:
+  template <typename... V>
+  void set_value(V&&... v) {
+    complete([&] { value.emplace(std::forward<V>(v)...); });
+  }
+
+  void set_exception(std::exception_ptr e) {
+    complete([&] { error = std::move(e); });
+  }
+
+  void set_continuation(std::function<void()>&& f) {
+    {
+      std::lock_guard<std::mutex> lck{mtx};
+      if (!ready) {
+        continuation = std::move(f);
+        return;
+      }
+    }
+    f();
+  }
+
+  [[nodiscard]] bool is_ready() {
+    std::lock_guard<std::mutex> lck{mtx};
+    return ready;
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lck{mtx};
+    cv.wait(lck, [this] { return ready; });
+  }
+
+  // only after completion, from the single consumer
+  [[nodiscard]] bool has_error() const { return error != nullptr; }
+
+  [[nodiscard]] std::exception_ptr get_error() const { return error; }
+
+  storage_type take() {
+    wait();
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return std::move(*value);
+  }
+};
+
+struct future_access {
+  template <typename T>
+  static const std::shared_ptr<shared_state<T>>& state(const future<T>& f) {
+    return f.state;
+  }
+};
+
+/*!
+ * Complete `p` with the result of `f(args...)`, or with the exception it throws
+ */
+template <typename T, typename F, typename... Args>
+void fulfil(promise<T>& p, F& f, Args&&... args) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      f(std::forward<Args>(args)...);
+      p.set_value();
+    } else {
+      p.set_value(f(std::forward<Args>(args)...));
+    }
+  } catch (...) {
+    p.set_exception(std::current_exception());
+  }
+}
+
+}  // namespace detail
+
+
+/*!
+ * Like std::future, plus `then()` continuations. Not copyable; `get()` and `then()` consume it.
+ * @tparam T
+ */
+template <typename T>
+class future {
+  friend struct detail::future_access;
+  friend class promise<T>;
+
+ private:
+  std::shared_ptr<detail::shared_state<T>> state{};
+
+  explicit future(std::shared_ptr<detail::shared_state<T>> s) : state(std::move(s)) {}
+
+ public:
+  future() = default;
+  future(future&&) noexcept = default;
+  future& operator=(future&&) noexcept = default;
+  future(const future&) = delete;
+  future& operator=(const future&) = delete;
+
+  [[nodiscard]] bool valid() const { return state != nullptr; }
+
+  [[nodiscard]] bool is_ready() const { return state->is_ready(); }
+
+  void wait() const { state->wait(); }
+
+  T get() {
+    auto s = std::move(state);
+    if constexpr (std::is_void_v<T>) {
+      s->take();
+    } else {
+      return s->take();
+    }
+  }
+
+  /*!
+   * Run `f(future<T>)` once this future is ready, on the thread that completes it.
+   * @return a future of what `f` returns
+   */
+  template <typename F>
+  auto then(F&& f) {
+    using return_type = std::invoke_result_t<std::decay_t<F>, future<T>>;
+    struct context {
+      promise<return_type> p;
+      std::decay_t<F> fn;
+    };
+    auto ctx = std::make_shared<context>(context{promise<return_type>{}, std::forward<F>(f)});
+    auto result = ctx->p.get_future();
+    auto s = std::move(state);
+    auto* raw = s.get();
+    raw->set_continuation([ctx, s = std::move(s)]() mutable { detail::fulfil(ctx->p, ctx->fn, future<T>{std::move(s)}); });
+    return result;
+  }
+
+  /*!
+   * Like `then(f)`, but `f` is submitted to `pool` instead of running on the completing thread.
+   */
+  template <typename Pool, typename F>
+  auto then(Pool& pool, F&& f) {
+    using return_type = std::invoke_result_t<std::decay_t<F>, future<T>>;
+    struct context {
+      promise<return_type> p;
+      std::decay_t<F> fn;
+    };
+    auto ctx = std::make_shared<context>(context{promise<return_type>{}, std::forward<F>(f)});
+    auto result = ctx->p.get_future();
+    auto s = std::move(state);
+    auto* raw = s.get();
+    raw->set_continuation([&pool, ctx, s = std::move(s)]() mutable {
+      pool.post([ctx, s]() mutable { detail::fulfil(ctx->p, ctx->fn, future<T>{std::move(s)}); });
+    });
+    return result;
+  }
+};
+
+
+/*!
+ * The writing side of a tp::future. Destroying an unsatisfied promise breaks it (std::future_errc::broken_promise).
+ * @tparam T
+ */
+template <typename T>
+class promise {
+ private:
+  std::shared_ptr<detail::shared_state<T>> state{std::make_shared<detail::shared_state<T>>()};
+  bool satisfied{false};
+
+ public:
+  promise() = default;
+  promise(promise&& other) noexcept : state(std::move(other.state)), satisfied(other.satisfied) {}
+  promise& operator=(promise&&) = delete;
+  promise(const promise&) = delete;
+
+  ~promise() {
+    if (state && !satisfied) {
+      state->set_exception(std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+    }
+  }
+
+  future<T> get_future() { return future<T>{state}; }
+
+  template <typename... V>
+  void set_value(V&&... v) {
+    satisfied = true;
+    state->set_value(std::forward<V>(v)...);
+  }
+
+  void set_exception(std::exception_ptr e) {
+    satisfied = true;
+    state->set_exception(std::move(e));
+  }
+};
+
+
+template <typename T>
+struct when_any_result {
+  std::size_t index;  // of the future that completed first
+  T value;
+};
+
+template <>
+struct when_any_result<void> {
+  std::size_t index;
+};
+
+
+/*!
+ * A future that completes when all `futures` have; no thread waits meanwhile. The first exception fails it at once.
+ * @return tp::future<std::vector<T>>, or tp::future<void> for T = void
+ */
+template <typename T>
+auto when_all(std::vector<future<T>> futures) {
+  using result_type = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+  using storage_type = typename detail::shared_state<T>::storage_type;
+  struct context {
+    promise<result_type> p;
+    std::vector<std::optional<storage_type>> results;
+    std::atomic<std::size_t> remaining;
+    std::atomic<bool> failed{false};
+  };
+
+  auto ctx = std::make_shared<context>();
+  ctx->results.resize(futures.size());
+  ctx->remaining.store(futures.size());
+  auto result = ctx->p.get_future();
+
+  auto finish = [](context& c) {
+    if constexpr (std::is_void_v<T>) {
+      c.p.set_value();
+    } else {
+      std::vector<T> values;
+      values.reserve(c.results.size());
+      for (auto& r : c.results) {
+        values.emplace_back(std::move(*r));
+      }
+      c.p.set_value(std::move(values));
+    }
+  };
+
+  if (futures.empty()) {
+    finish(*ctx);
+    return result;
+  }
+  for (std::size_t i = 0; i < futures.size(); ++i) {
+    auto s = detail::future_access::state(futures[i]);
+    auto* raw = s.get();
+    raw->set_continuation([ctx, s = std::move(s), i, finish]() {
+      if (s->has_error()) {
+        if (!ctx->failed.exchange(true)) {
+          ctx->p.set_exception(s->get_error());
+        }
+        return;
+      }
+      ctx->results[i].emplace(s->take());  // each slot is written by one thread only
+      if (ctx->remaining.fetch_sub(1) == 1 && !ctx->failed.load()) {
+        finish(*ctx);
+      }
+    });
+  }
+  return result;
+}
+
+/*!
+ * A future that completes with the index (and value) of the first of `futures` to complete, or with its exception.
+ * @return tp::future<tp::when_any_result<T>>
+ */
+template <typename T>
+auto when_any(std::vector<future<T>> futures) {
+  struct context {
+    promise<when_any_result<T>> p;
+    std::atomic<bool> done{false};
+  };
+
+  auto ctx = std::make_shared<context>();
+  auto result = ctx->p.get_future();
+  for (std::size_t i = 0; i < futures.size(); ++i) {
+    auto s = detail::future_access::state(futures[i]);
+    auto* raw = s.get();
+    raw->set_continuation([ctx, s = std::move(s), i]() {
+      if (ctx->done.exchange(true)) {
+        return;  // lost the race; the others keep `ctx` alive until they complete
+      }
+      if (s->has_error()) {
+        ctx->p.set_exception(s->get_error());
+      } else if constexpr (std::is_void_v<T>) {
+        ctx->p.set_value(when_any_result<void>{i});
+      } else {
+        ctx->p.set_value(when_any_result<T>{i, s->take()});
+      }
+    });
+  }
+  return result;
+}
+
+}  // namespace tp
@@ -0,0 +1,454 @@
+/** @file    pool_policies.h
+ *  @time    2026/10/18 ~ 下午1:30
+ *  @author  Leon
+ *
+ *  @note    Queue, idle and stats policies composing a `tp::basic_pool`
+ *
+ */
+
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <queue>
+#include <iterator>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+
+
+namespace tp {  // thread pool
+
+/*!
+ * Returned by a queue policy when the tasks may be run by any worker (or went to several workers)
+ */
+inline constexpr std::size_t any_worker = static_cast<std::size_t>(-1);
+
+
+/// ---------------------------------------- Placement policies ----------------------------------------
+/// Which worker a `double_queue` hands a task to:
+///   explicit Placement(std::size_t num_workers);
+///   template <typename Load> std::size_t pick(std::size_t num_workers, Load&& load);  // load(i): tasks of worker i
+
+namespace detail {
+
+/*!
+ * xorshift64, one state per thread: no shared cache line, no lock
+ */
+inline std::uint64_t fast_random() {
+  thread_local std::uint64_t state{std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1};
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+// uniform in [0, n) without a division
+inline std::size_t random_below(std::size_t n) { return static_cast<std::size_t>(((fast_random() >> 32) * n) >> 32); }
+
+}  // namespace detail
+
+/*!
+ * Scan every worker and take the least loaded one: best balance, O(N) counter reads per task
+ */
+struct least_busy {
+  explicit least_busy(std::size_t /*num_workers*/) {}
+
+  template <typename Load>
+  std::size_t pick(std::size_t num_workers, Load&& load) {
+    std::size_t best{0};
+    auto best_load = load(0);
+    for (std::size_t i = 1; i < num_workers && best_load != 0; ++i) {
+      if (auto l = load(i); l < best_load) {
+        best = i;
+        best_load = l;
+      }
+    }
+    return best;
+  }
+};
+
+/*!
+ * Power of two choices: sample two workers, take the less loaded one. O(1), and the maximum load stays within
+ * O(log log N) of the mean, close to least_busy.
+ */
+struct two_choices {
+  explicit two_choices(std::size_t /*num_workers*/) {}
+
+  template <typename Load>
+  std::size_t pick(std::size_t num_workers, Load&& load) {
+    if (num_workers == 1) {
+      return 0;
+    }
+    auto a = detail::random_below(num_workers);
+    auto b = detail::random_below(num_workers - 1);
+    b += b >= a ? 1 : 0;  // distinct from a
+    return load(b) < load(a) ? b : a;
+  }
+};
+
+/*!
+ * Each producer thread cycles through the workers from its own cursor; no counter reads at all, but blind to load
+ */
+struct round_robin {
+  explicit round_robin(std::size_t /*num_workers*/) {}
+
+  template <typename Load>
+  std::size_t pick(std::size_t num_workers, Load&& /*load*/) {
+    thread_local std::size_t cursor{detail::random_below(1u << 16)};  // producers start apart
+    return cursor++ % num_workers;
+  }
+};
+
+/*!
+ * Each producer thread keeps feeding the same worker (warm caches, no counter reads) and re-picks it by two
+ * choices every `period` tasks, so a busy producer cannot pile everything onto one worker for long.
+ */
+struct sticky_producer {
+  static constexpr std::size_t period{64};
+
+  explicit sticky_producer(std::size_t /*num_workers*/) {}
+
+  template <typename Load>
+  std::size_t pick(std::size_t num_workers, Load&& load) {
+    thread_local std::size_t home{static_cast<std::size_t>(-1)};
+    thread_local std::size_t uses{0};
+    if (home >= num_workers || ++uses % period == 0) {
+      home = two_choices{num_workers}.pick(num_workers, load);
+    }
+    return home;
+  }
+};
+
+
+/// ---------------------------------------- Queue policies ----------------------------------------
+/// A queue policy is a template over the lock type and provides:
+///   explicit Queue(std::size_t num_workers);
+///   std::size_t push(std::function<void()>&& task);          // returns the worker to wake, or any_worker
+///   template <typename Itr> std::size_t push(Itr begin, Itr end);   // moves the tasks out, one handoff
+///   template <typename Run> std::size_t consume(std::size_t index, Run&& run);  // run tasks for worker `index`
+///   template <typename Run> std::size_t steal(std::size_t index, Run&& run);    // run them while it is blocked
+///   bool has_tasks(std::size_t index) const;
+
+/*!
+ * One queue shared by all workers (DynamicThreadPool)
+ * @tparam Lock
+ */
+template <typename Lock>
+class shared_queue {
+ private:
+  std::queue<std::function<void()>> tasks{};
+  Lock lock{};
+  std::atomic<std::size_t> size{0};  // readable without the lock
+
+ public:
+  explicit shared_queue(std::size_t /*num_workers*/) {}
+
+  std::size_t push(std::function<void()>&& task) {
+    std::unique_lock<Lock> lck{lock};
+    tasks.emplace(std::move(task));
+    size.fetch_add(1, std::memory_order_relaxed);
+    return any_worker;
+  }
+
+  template <typename Itr>
+  std::size_t push(Itr begin, Itr end) {
+    std::size_t n{0};
+    std::unique_lock<Lock> lck{lock};
+    for (; begin != end; ++begin, ++n) {
+      tasks.emplace(std::move(*begin));
+    }
+    size.fetch_add(n, std::memory_order_relaxed);
+    return any_worker;
+  }
+
+  template <typename Run>
+  std::size_t consume(std::size_t /*index*/, Run&& run) {
+    std::function<void()> task;
+    {
+      std::unique_lock<Lock> lck{lock};
+      if (tasks.empty()) {
+        return 0;
+      }
+      task = std::move(tasks.front());
+      tasks.pop();
+      size.fetch_sub(1, std::memory_order_relaxed);
+    }
+    run(task);
+    return 1;
+  }
+
+  // a compensating thread simply acts as one more consumer
+  template <typename Run>
+  std::size_t steal(std::size_t index, Run&& run) {
+    return consume(index, std::forward<Run>(run));
+  }
+
+  [[nodiscard]] bool has_tasks(std::size_t /*index*/) const { return size.load(std::memory_order_relaxed) != 0; }
+};
+
+
+/*!
+ * Two queues per worker (SteadyThreadPool): producers fill the buffer queue under the lock, the worker swaps it with
+ * its working queue and runs that without any lock.
+ * @tparam Lock
+ * @tparam Placement which worker gets a task, see the placement policies above
+ */
+template <typename Lock, typename Placement = least_busy>
+class double_queue {
+ private:
+  struct alignas(64) worker_queues {  // one cache line set per worker, so counters do not false-share
+    std::queue<std::function<void()>> tq_work{};
+    std::queue<std::function<void()>> tq_buffer{};
+    Lock lock{};
+    // tasks in both queues, including the one running
+    std::atomic<std::size_t> num_tasks{0};
+  };
+
+  std::vector<worker_queues> workers;  // not movable, so constructed once with its final size
+  Placement placement;
+  // a bulk push is split over several workers only if every part gets at least this many tasks
+  static constexpr std::size_t min_chunk{64};
+
+  std::size_t pick_worker() {
+    return placement.pick(workers.size(),
+                          [this](std::size_t i) { return workers[i].num_tasks.load(std::memory_order_relaxed); });
+  }
+
+ public:
+  explicit double_queue(std::size_t num_workers) : workers(num_workers), placement(num_workers) {}
+
+  std::size_t push(std::function<void()>&& task) {
+    auto index = pick_worker();
+    auto& w = workers[index];
+    std::unique_lock<Lock> lck{w.lock};
+    w.tq_buffer.emplace(std::move(task));
+    w.num_tasks.fetch_add(1, std::memory_order_relaxed);  // ++num_tasks
+    return index;
+  }
+
+  template <typename Itr>
+  std::size_t push(Itr begin, Itr end) {
+    auto remaining = static_cast<std::size_t>(std::distance(begin, end));
+    auto chunk = std::max(min_chunk, (remaining + workers.size() - 1) / workers.size());
+    std::size_t index{any_worker};
+    std::size_t num_chunks{0};
+    while (remaining != 0) {
+      auto n = std::min(chunk, remaining);
+      index = pick_worker();
+      auto& w = workers[index];
+      std::unique_lock<Lock> lck{w.lock};  // one lock per chunk
+      for (std::size_t i = 0; i < n; ++i, ++begin) {
+        w.tq_buffer.emplace(std::move(*begin));
+      }
+      w.num_tasks.fetch_add(n, std::memory_order_relaxed);
+      remaining -= n;
+      ++num_chunks;
+    }
+    return num_chunks == 1 ? index : any_worker;
+  }
+
+  template <typename Run>
+  std::size_t consume(std::size_t index, Run&& run) {
+    auto& w = workers[index];
+    {
+      std::unique_lock<Lock> lck{w.lock};
+      if (w.tq_buffer.empty()) {  // no more work to do in the buffer queue
+        return 0;
+      }
+      using std::swap;
+      swap(w.tq_work, w.tq_buffer);  // ADL
+    }
+    std::size_t n{0};
+    while (!w.tq_work.empty()) {
+      run(w.tq_work.front());  // run the task directly in the working queue
+      w.tq_work.pop();
+      w.num_tasks.fetch_sub(1, std::memory_order_relaxed);  // --num_tasks
+      ++n;
+    }
+    return n;
+  }
+
+  // The blocked worker still owns its working queue, so only the buffer queue can be taken
+  template <typename Run>
+  std::size_t steal(std::size_t index, Run&& run) {
+    auto& w = workers[index];
+    std::queue<std::function<void()>> stolen;
+    {
+      std::unique_lock<Lock> lck{w.lock};
+      using std::swap;
+      swap(stolen, w.tq_buffer);
+    }
+    std::size_t n{0};
+    while (!stolen.empty()) {
+      run(stolen.front());
+      stolen.pop();
+      w.num_tasks.fetch_sub(1, std::memory_order_relaxed);  // --num_tasks
+      ++n;
+    }
+    return n;
+  }
+
+  [[nodiscard]] bool has_tasks(std::size_t index) const {
+    return workers[index].num_tasks.load(std::memory_order_relaxed) != 0;
+  }
+
+  [[nodiscard]] std::size_t get_num_tasks(std::size_t index) const {
+    return workers[index].num_tasks.load(std::memory_order_acquire);
+  }
+};
+
+/*!
+ * Binds a placement to `double_queue`, as `basic_pool` takes a queue template over the lock only.
+ * Usage: `basic_pool<double_queue_with<two_choices>::type, atomic_spinlock, spin_idle, no_stats>`
+ */
+template <typename Placement>
+struct double_queue_with {
+  template <typename Lock>
+  using type = double_queue<Lock, Placement>;
+};
+
+
+/// ---------------------------------------- Idle policies ----------------------------------------
+/// What a worker does when its queue is empty:
+///   explicit Idle(std::size_t num_workers);
+///   template <typename Ready> void wait(Ready&& ready);   // may return spuriously
+///   template <typename Ready> void wait_until(Ready&& ready, std::chrono::steady_clock::time_point deadline);
+///   void notify(std::size_t index, std::size_t num_tasks);  // after a push
+///   void notify_all();
+
+/*!
+ * Give up the time slice and poll again: lowest latency, burns the CPU while idle (SteadyThreadPool)
+ */
+struct spin_idle {
+  explicit spin_idle(std::size_t /*num_workers*/) {}
+
+  template <typename Ready>
+  void wait(Ready&& ready) {
+    if (!ready()) {
+      std::this_thread::yield();
+    }
+  }
+
+  template <typename Ready>
+  void wait_until(Ready&& ready, std::chrono::steady_clock::time_point /*deadline*/) {
+    wait(std::forward<Ready>(ready));
+  }
+
+  void notify(std::size_t /*index*/, std::size_t /*num_tasks*/) {}
+
+  void notify_all() {}
+};
+
+/*!
+ * Park on a condition variable (DynamicThreadPool); producers only touch the mutex when somebody sleeps.
+ */
+class sleep_idle {
+ private:
+  std::mutex mtx{};
+  std::condition_variable cv{};
+  std::atomic<std::size_t> sleepers{0};
+
+ public:
+  explicit sleep_idle(std::size_t /*num_workers*/) {}
+
+  template <typename Ready>
+  void wait(Ready&& ready) {
+    std::unique_lock<std::mutex> lck{mtx};
+    sleepers.fetch_add(1, std::memory_order_relaxed);
+    // pairs with the fence in notify(): either we see the new task or the producer sees us sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cv.wait(lck, std::forward<Ready>(ready));
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  template <typename Ready>
+  void wait_until(Ready&& ready, std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lck{mtx};
+    sleepers.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cv.wait_until(lck, deadline, std::forward<Ready>(ready));
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void notify(std::size_t index, std::size_t num_tasks) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    { std::lock_guard<std::mutex> lck{mtx}; }  // a sleeper is either waiting already or will see the task
+    if (index == any_worker && num_tasks == 1) {
+      cv.notify_one();
+    } else {  // a specific worker (only it can run the task) or many tasks
+      cv.notify_all();
+    }
+  }
+
+  void notify_all() {
+    { std::lock_guard<std::mutex> lck{mtx}; }
+    cv.notify_all();
+  }
+};
+
+
+/// ---------------------------------------- Stats policies ----------------------------------------
+/// Hooks called by the pool; with `no_stats` they are empty inline functions and compile away entirely:
+///   explicit Stats(std::size_t num_workers);
+///   void on_submit(std::size_t num_tasks);
+///   void on_task_begin(std::size_t index);
+///   void on_task_end(std::size_t index);
+///   void on_idle(std::size_t index);
+
+struct no_stats {
+  explicit no_stats(std::size_t /*num_workers*/) {}
+  void on_submit(std::size_t /*num_tasks*/) {}
+  void on_task_begin(std::size_t /*index*/) {}
+  void on_task_end(std::size_t /*index*/) {}
+  void on_idle(std::size_t /*index*/) {}
+};
+
+/*!
+ * Counts submitted tasks, and executed tasks and idle rounds per worker
+ */
+class counting_stats {
+ private:
+  struct alignas(64) worker_counters {
+    std::atomic<std::uint64_t> executed{0};
+    std::atomic<std::uint64_t> idle{0};
+  };
+
+  std::atomic<std::uint64_t> submitted{0};
+  std::vector<worker_counters> workers;
+
+ public:
+  struct snapshot {
+    std::uint64_t submitted;
+    std::vector<std::uint64_t> executed;  // per worker
+    std::vector<std::uint64_t> idle;      // idle rounds per worker
+  };
+
+  explicit counting_stats(std::size_t num_workers) : workers(num_workers) {}
+
+  void on_submit(std::size_t num_tasks) { submitted.fetch_add(num_tasks, std::memory_order_relaxed); }
+
+  void on_task_begin(std::size_t /*index*/) {}
+
+  // a compensating thread reports with the index of the worker it covers, hence the atomic add
+  void on_task_end(std::size_t index) { workers[index].executed.fetch_add(1, std::memory_order_relaxed); }
+
+  void on_idle(std::size_t index) { workers[index].idle.fetch_add(1, std::memory_order_relaxed); }
+
+  [[nodiscard]] snapshot get_snapshot() const {
+    snapshot s{submitted.load(std::memory_order_relaxed), {}, {}};
+    for (const auto& w : workers) {
+      s.executed.push_back(w.executed.load(std::memory_order_relaxed));
+      s.idle.push_back(w.idle.load(std::memory_order_relaxed));
+    }
+    return s;
+  }
+};
+
+}  // namespace tp
@@ -0,0 +1,98 @@
+/** @file    rw_spin_lock.h
+ *  @time    2026/10/18 ~ 下午7:40
+ *  @author  Leon
+ *
+ *  @note    A big-reader lock: readers only touch their own cache line, writers pay for scanning all of them
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <thread>
+#include <functional>
+#include <threadpool/atomic_spin_lock.h>
+
+namespace tp {
+
+/*!
+ * Reader-writer spin lock for read-mostly data (routing table, config, cache index). Each reader increments a
+ * counter in one of `Slots` cache-line padded slots picked by its thread, so concurrent readers never share a
+ * cache line; a writer raises its flag and waits for every slot to drain. Writers are preferred: new readers
+ * back off while a writer waits.
+ * Works with `std::shared_lock` / `std::unique_lock` (`lock_shared()` / `lock()` and friends).
+ * @tparam Slots reader slots; more than the number of cores gains nothing
+ */
+template <std::size_t Slots = 64>
+class brw_spinlock {
+ private:
+  struct alignas(64) reader_slot {
+    std::atomic<std::uint32_t> readers{0};
+  };
+
+  std::array<reader_slot, Slots> slots_{};
+  alignas(64) std::atomic<bool> writer_{false};
+
+  static reader_slot& slot_of(std::array<reader_slot, Slots>& slots) {
+    thread_local std::size_t index{std::hash<std::thread::id>{}(std::this_thread::get_id()) % Slots};
+    return slots[index];
+  }
+
+ public:
+  void lock_shared() {
+    auto& slot = slot_of(slots_);
+    spin_backoff backoff;
+    while (true) {
+      slot.readers.fetch_add(1);  // seq_cst: pairs with the writer's exchange then scan
+      if (!writer_.load()) {
+        return;
+      }
+      slot.readers.fetch_sub(1, std::memory_order_relaxed);  // let the writer in
+      while (writer_.load(std::memory_order_relaxed)) {
+        backoff.pause();
+      }
+    }
+  }
+
+  bool try_lock_shared() {
+    auto& slot = slot_of(slots_);
+    slot.readers.fetch_add(1);
+    if (!writer_.load()) {
+      return true;
+    }
+    slot.readers.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  void unlock_shared() { slot_of(slots_).readers.fetch_sub(1, std::memory_order_release); }
+
+  void lock() {
+    spin_backoff backoff;
+    while (writer_.exchange(true)) {  // one writer at a time
+      backoff.pause();
+    }
+    for (auto& slot : slots_) {
+      while (slot.readers.load(std::memory_order_acquire) != 0) {
+        backoff.pause();
+      }
+    }
+  }
+
+  bool try_lock() {
+    if (writer_.exchange(true)) {
+      return false;
+    }
+    for (auto& slot : slots_) {
+      if (slot.readers.load(std::memory_order_acquire) != 0) {
+        writer_.store(false, std::memory_order_release);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void unlock() { writer_.store(false, std::memory_order_release); }
+};
+
+}  // namespace tp
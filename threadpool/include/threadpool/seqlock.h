@@ -0,0 +1,95 @@
+/** @file    seqlock.h
+ *  @time    2026/10/18 ~ 下午7:55
+ *  @author  Leon
+ *
+ *  @note    A sequence lock for small trivially copyable snapshots: readers never write shared memory
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include <threadpool/atomic_spin_lock.h>
+
+namespace tp {
+
+/*!
+ * Readers copy the value and retry if a writer was active meanwhile, so reads scale with any number of cores
+ * (they only read the sequence counter's cache line). Best for small values read far more often than written.
+ * The value is kept in relaxed atomic words, so a torn copy read during a write is never a data race.
+ * @tparam T trivially copyable
+ */
+template <typename T>
+class seqlock {
+  static_assert(std::is_trivially_copyable_v<T>, "seqlock copies the value bytewise");
+
+ private:
+  static constexpr std::size_t num_words = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+  alignas(64) std::atomic<std::uint64_t> seq_{0};  // odd while a write is in progress
+  std::array<std::atomic<std::uint64_t>, num_words> words_{};
+  atomic_spinlock writer_lock_{};  // writers serialize among themselves
+
+  void read_words(T& out) const {
+    std::array<std::uint64_t, num_words> buf;
+    for (std::size_t i = 0; i < num_words; ++i) {
+      buf[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(static_cast<void*>(&out), buf.data(), sizeof(T));  // trivially copyable, asserted above
+  }
+
+  void write_locked(const T& value) {
+    std::array<std::uint64_t, num_words> buf{};
+    std::memcpy(buf.data(), &value, sizeof(T));
+    auto s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);  // the odd counter is visible before any word
+    for (std::size_t i = 0; i < num_words; ++i) {
+      words_[i].store(buf[i], std::memory_order_relaxed);
+    }
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+ public:
+  seqlock() { write_locked(T{}); }
+
+  explicit seqlock(const T& value) { write_locked(value); }
+
+  [[nodiscard]] T load() const {
+    T out;
+    spin_backoff backoff;
+    while (true) {
+      auto before = seq_.load(std::memory_order_acquire);
+      if ((before & 1) == 0) {
+        read_words(out);
+        std::atomic_thread_fence(std::memory_order_acquire);  // the words are read before the counter again
+        if (seq_.load(std::memory_order_relaxed) == before) {
+          return out;
+        }
+      }
+      backoff.pause();
+    }
+  }
+
+  void store(const T& value) {
+    unique_spinlock lck(writer_lock_);
+    write_locked(value);
+  }
+
+  /*!
+   * Read-modify-write under the writer lock: `func(T&)` edits a copy of the current value, which is then stored.
+   */
+  template <typename F>
+  void update(F&& func) {
+    unique_spinlock lck(writer_lock_);
+    T value;
+    read_words(value);  // no writer can interfere, no retry needed
+    func(value);
+    write_locked(value);
+  }
+};
+
+}  // namespace tp
@@ -0,0 +1,208 @@
+/** @file    logger.h
+ *  @time    2026/10/21 ~ 上午10:00
+ *  @author  Leon
+ *
+ *  @note    An asynchronous logger: each thread encodes records (format string pointer + raw argument bytes) into its
+ *           own lock-free SPSC ring; one background thread formats them with fmt and writes in batches.
+ *
+ *  Usage:
+ *    utils::logger::start({"/var/log/webserver.log"});   // empty path: stderr
+ *    LOG_INFO("{} {} -> {}", method, target, status);      // the format must be a string literal
+ *    utils::logger::stop();                                 // drains and joins
+ *
+ *  Levels below LOG_ACTIVE_LEVEL (CMake cache variable LOG_LEVEL) compile to nothing, arguments included. Before
+ *  start() and after stop() records are dropped. Arithmetic values, pointers and strings are copied as they are and
+ *  formatted later; any other type is formatted with "{}" on the calling thread, so keep specs like {:x} for the
+ *  former.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <fmt/format.h>
+
+#ifndef LOG_ACTIVE_LEVEL
+#define LOG_ACTIVE_LEVEL 2  // info
+#endif
+
+namespace utils::logger {
+
+enum class level : std::uint8_t { trace, debug, info, warn, error, off };
+
+enum class overflow : std::uint8_t {
+  drop,   // a full ring loses the record (counted, see get_dropped()): the caller never waits
+  block,  // the caller spins until the writer makes room
+};
+
+struct config {
+  std::string path{};  // appended to; empty: stderr
+  overflow policy{overflow::drop};
+  std::size_t ring_bytes{1 << 20};  // per thread, rounded up to a power of two
+  std::chrono::milliseconds interval{1};  // the writer's pause between passes, unless a ring is half full
+};
+
+/*!
+ * Open the output and start the writer thread; does nothing if already started
+ * @return false if the file cannot be opened
+ */
+bool start(const config& cfg = {});
+
+/*!
+ * Write what is queued, then stop the writer and close the output
+ */
+void stop();
+
+/*!
+ * Wait until every record logged before the call is written
+ */
+void flush();
+
+/*!
+ * @return records lost to full rings (overflow::drop) or too large for one, since start()
+ */
+std::uint64_t get_dropped();
+
+namespace detail {
+
+/*!
+ * Every record starts with this; `decode` is nullptr for the padding that skips the end of the ring
+ */
+struct record_header {
+  void (*decode)(fmt::memory_buffer& out, std::string_view format, const char* args);
+  const char* format;
+  std::uint32_t format_size;
+  std::uint32_t size;  // of the whole record, header included, a multiple of 8
+  std::int64_t time_ns;  // since the epoch
+  level lvl;
+};
+
+inline std::atomic<bool>& running_flag() {
+  static std::atomic<bool> running{false};
+  return running;
+}
+
+/*!
+ * @return `size` bytes in the calling thread's ring (the record header first), or nullptr if the record is dropped
+ */
+char* reserve(std::size_t size);
+
+/*!
+ * Publish the record reserve() returned
+ */
+void commit();
+
+// how an argument of type T travels through the ring
+template <typename T>
+using stored_t = std::conditional_t<
+    std::is_arithmetic_v<T>, T,
+    std::conditional_t<std::is_pointer_v<T> && !std::is_convertible_v<T, const char*>, const void*, std::string_view>>;
+
+template <typename T>
+constexpr bool is_raw_v = std::is_arithmetic_v<T> || (std::is_pointer_v<T> && !std::is_convertible_v<T, const char*>);
+
+template <typename T>
+constexpr bool is_string_v = std::is_convertible_v<const T&, std::string_view>;
+
+template <typename T>
+std::size_t encoded_size(const T& arg) {
+  if constexpr (is_raw_v<T>) {
+    return sizeof(stored_t<T>);
+  } else if constexpr (is_string_v<T>) {
+    return sizeof(std::uint32_t) + std::string_view{arg}.size();
+  } else {
+    return sizeof(std::uint32_t) + fmt::formatted_size("{}", arg);
+  }
+}
+
+template <typename T>
+char* encode(char* at, const T& arg) {
+  if constexpr (is_raw_v<T>) {
+    auto value = static_cast<stored_t<T>>(arg);
+    std::memcpy(at, &value, sizeof(value));
+    return at + sizeof(value);
+  } else {
+    std::uint32_t size;
+    if constexpr (is_string_v<T>) {
+      std::string_view s{arg};
+      size = static_cast<std::uint32_t>(s.size());
+      std::memcpy(at + sizeof(size), s.data(), s.size());
+    } else {
+      size = static_cast<std::uint32_t>(fmt::format_to(at + sizeof(size), "{}", arg) - (at + sizeof(size)));
+    }
+    std::memcpy(at, &size, sizeof(size));
+    return at + sizeof(size) + size;
+  }
+}
+
+template <typename T>
+T decode_one(const char*& at) {
+  if constexpr (std::is_same_v<T, std::string_view>) {
+    std::uint32_t size;
+    std::memcpy(&size, at, sizeof(size));
+    std::string_view s{at + sizeof(size), size};
+    at += sizeof(size) + size;
+    return s;
+  } else {
+    T value;
+    std::memcpy(&value, at, sizeof(value));
+    at += sizeof(value);
+    return value;
+  }
+}
+
+// runs on the writer thread, instantiated per list of argument types
+template <typename... Stored>
+void decode(fmt::memory_buffer& out, std::string_view format, [[maybe_unused]] const char* args) {
+  // braces: the arguments are read left to right
+  std::tuple<Stored...> values{decode_one<Stored>(args)...};
+  std::apply([&](const auto&... v) { fmt::vformat_to(std::back_inserter(out), format, fmt::make_format_args(v...)); },
+             values);
+}
+
+template <typename... Args>
+void log(level lvl, fmt::format_string<Args...> format, const Args&... args) {
+  if (!running_flag().load(std::memory_order_relaxed)) {
+    return;
+  }
+  auto size = sizeof(record_header) + (std::size_t{0} + ... + encoded_size(args));
+  size = (size + 7) & ~std::size_t{7};
+  char* at = reserve(size);
+  if (at == nullptr) {
+    return;
+  }
+  fmt::string_view sv = format;
+  record_header h{&decode<stored_t<std::decay_t<Args>>...>, sv.data(), static_cast<std::uint32_t>(sv.size()),
+                  static_cast<std::uint32_t>(size),
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+                      .count(),
+                  lvl};
+  std::memcpy(at, &h, sizeof(h));
+  at += sizeof(h);
+  ((at = encode(at, args)), ...);
+  commit();
+}
+
+}  // namespace detail
+
+}  // namespace utils::logger
+
+
+#define LOG_AT(lvl, ...)                                                  \
+  do {                                                                    \
+    if constexpr (static_cast<int>(lvl) >= LOG_ACTIVE_LEVEL) {            \
+      utils::logger::detail::log(lvl, __VA_ARGS__);                       \
+    }                                                                     \
+  } while (false)
+
+#define LOG_TRACE(...) LOG_AT(utils::logger::level::trace, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(utils::logger::level::debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(utils::logger::level::info, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(utils::logger::level::warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(utils::logger::level::error, __VA_ARGS__)
@@ -0,0 +1,308 @@
+/** @file    logger.cpp
+ *  @time    2026/10/21 ~ 上午10:00
+ *  @author  Leon
+ *
+ *  @note    Per-thread rings, the writer thread and the line layout of utils/logger.h
+ *
+ */
+
+#include <utils/logger.h>
+#include <fmt/compile.h>
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace utils::logger {
+
+namespace {
+
+/*!
+ * Single producer (its thread), single consumer (the writer). Positions only grow; a record never wraps: the tail
+ * of the buffer is skipped with a padding header instead.
+ */
+struct ring {
+  std::unique_ptr<char[]> buf;
+  std::size_t capacity;
+  std::uint32_t tid;
+  alignas(64) std::atomic<std::uint64_t> tail{0};  // written by the producer
+  std::uint64_t cached_head{0};                    // the producer's last look at `head`
+  std::uint64_t reserved{0};                       // where the record being written ends
+  alignas(64) std::atomic<std::uint64_t> head{0};  // written by the consumer
+  std::atomic<bool> orphaned{false};               // its thread exited: removed once drained
+
+  // zeroed: the pages fault in here, on the thread's first record, rather than one by one on the hot path
+  ring(std::size_t cap, std::uint32_t id) : buf(new char[cap]()), capacity(cap), tid(id) {}
+};
+
+struct logger_state {
+  std::mutex mtx;  // guards `rings` and the writer's lifetime
+  std::condition_variable wake;
+  std::vector<std::shared_ptr<ring>> rings;
+  std::uint32_t next_tid{1};
+  config cfg{};
+  std::size_t ring_bytes{0};
+  int fd{-1};
+  std::thread writer{};
+  std::atomic<bool> stopping{false};
+  std::atomic<std::uint64_t> sweeps{0};  // completed passes of the writer over every ring
+  std::atomic<std::uint64_t> dropped{0};
+};
+
+logger_state& get_state() {
+  static logger_state s;
+  return s;
+}
+
+// owned by its thread; leaves the ring to the writer on exit
+struct local_ring {
+  std::shared_ptr<ring> r{};
+
+  ~local_ring() {
+    if (r != nullptr) {
+      r->orphaned.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local local_ring local{};
+
+ring& local_ring_of(logger_state& s) {
+  if (local.r == nullptr || local.r->capacity != s.ring_bytes) {
+    std::lock_guard<std::mutex> lck{s.mtx};
+    if (local.r != nullptr) {
+      local.r->orphaned.store(true, std::memory_order_release);  // from a previous start()
+    }
+    local.r = std::make_shared<ring>(s.ring_bytes, s.next_tid++);
+    s.rings.push_back(local.r);
+  }
+  return *local.r;
+}
+
+constexpr std::string_view LEVEL_NAMES[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "OFF  "};
+
+/*!
+ * "2026-10-21 10:00:00.123456 INFO  [3] ", with the part down to the second rendered once per second
+ */
+class line_prefix {
+ private:
+  std::int64_t second{-1};
+  char text[32]{};
+  std::size_t size{0};
+
+ public:
+  void append(fmt::memory_buffer& out, std::int64_t time_ns, level lvl, std::uint32_t tid) {
+    auto s = time_ns / 1'000'000'000;
+    if (s != second) {
+      std::time_t t = s;
+      std::tm tm{};
+      ::localtime_r(&t, &tm);
+      size = std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &tm);
+      second = s;
+    }
+    char micros[8] = {'.'};
+    auto us = (time_ns % 1'000'000'000) / 1000;
+    for (int i = 6; i >= 1; --i, us /= 10) {
+      micros[i] = static_cast<char>('0' + us % 10);
+    }
+    micros[7] = ' ';
+    out.append(text, text + size);
+    out.append(micros, micros + sizeof(micros));
+    auto name = LEVEL_NAMES[static_cast<std::size_t>(lvl)];
+    out.append(name.data(), name.data() + name.size());
+    fmt::format_to(std::back_inserter(out), FMT_COMPILE(" [{}] "), tid);
+  }
+};
+
+void write_all(int fd, const fmt::memory_buffer& out) {
+  const char* data = out.data();
+  auto left = out.size();
+  while (left > 0) {
+    auto n = ::write(fd, data, left);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      return;  // nowhere to complain to
+    }
+    data += n;
+    left -= static_cast<std::size_t>(n);
+  }
+}
+
+// format what `r` holds
+// @return the bytes it held
+std::size_t drain(ring& r, fmt::memory_buffer& out, line_prefix& prefix, int fd) {
+  auto head = r.head.load(std::memory_order_relaxed);
+  auto tail = r.tail.load(std::memory_order_acquire);
+  auto held = static_cast<std::size_t>(tail - head);
+  while (head != tail) {
+    auto offset = head & (r.capacity - 1);
+    if (r.capacity - offset < sizeof(detail::record_header)) {
+      head += r.capacity - offset;  // padding too short for a header
+      continue;
+    }
+    const char* at = r.buf.get() + offset;
+    detail::record_header h;
+    std::memcpy(&h, at, sizeof(h));
+    if (h.decode != nullptr) {
+      prefix.append(out, h.time_ns, h.lvl, r.tid);
+      try {
+        h.decode(out, {h.format, h.format_size}, at + sizeof(h));
+      } catch (const fmt::format_error& e) {
+        fmt::format_to(std::back_inserter(out), "<{}: {}>", e.what(), std::string_view{h.format, h.format_size});
+      }
+      out.push_back('\n');
+    }
+    head += h.size;
+    if (out.size() > (64 << 10)) {  // batch, but keep the buffer in cache
+      write_all(fd, out);
+      out.clear();
+    }
+  }
+  r.head.store(head, std::memory_order_release);
+  return held;
+}
+
+void run_writer(logger_state& s) {
+  fmt::memory_buffer out{};
+  line_prefix prefix{};
+  std::vector<std::shared_ptr<ring>> rings{};
+  for (;;) {
+    bool stopping = s.stopping.load(std::memory_order_acquire);
+    {
+      std::lock_guard<std::mutex> lck{s.mtx};
+      // drop rings whose thread exited and that are drained
+      s.rings.erase(std::remove_if(s.rings.begin(), s.rings.end(),
+                                   [](const auto& r) {
+                                     return r->orphaned.load(std::memory_order_acquire) &&
+                                            r->head.load(std::memory_order_relaxed) == r->tail.load(std::memory_order_acquire);
+                                   }),
+                    s.rings.end());
+      rings = s.rings;
+    }
+    bool busy{false};  // a ring was half full: come back at once
+    for (auto& r : rings) {
+      busy = drain(*r, out, prefix, s.fd) > r->capacity / 2 || busy;
+    }
+    if (out.size() > 0) {
+      write_all(s.fd, out);
+      out.clear();
+    }
+    s.sweeps.fetch_add(1, std::memory_order_release);
+    if (stopping) {
+      return;  // this sweep started after the flag: everything logged before stop() is out
+    }
+    if (!busy) {  // let records pile up: one write per interval rather than one per handful of records
+      std::unique_lock<std::mutex> lck{s.mtx};
+      s.wake.wait_for(lck, s.cfg.interval);
+    }
+  }
+}
+
+}  // namespace
+
+
+char* detail::reserve(std::size_t size) {
+  auto& s = get_state();
+  auto& r = local_ring_of(s);
+  if (size > r.capacity / 4) {
+    s.dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  auto tail = r.tail.load(std::memory_order_relaxed);
+  auto offset = tail & (r.capacity - 1);
+  auto pad = offset + size > r.capacity ? r.capacity - offset : 0;  // records never wrap
+  while (tail + pad + size - r.cached_head > r.capacity) {
+    r.cached_head = r.head.load(std::memory_order_acquire);
+    if (tail + pad + size - r.cached_head <= r.capacity) {
+      break;
+    }
+    if (s.cfg.policy == overflow::drop || !running_flag().load(std::memory_order_relaxed)) {
+      s.dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    s.wake.notify_one();
+    std::this_thread::yield();
+  }
+  if (pad >= sizeof(record_header)) {
+    record_header h{};
+    h.size = static_cast<std::uint32_t>(pad);
+    std::memcpy(r.buf.get() + offset, &h, sizeof(h));
+  }
+  if (pad > 0) {  // a shorter one is recognized by its length: no record is that short
+    tail += pad;
+    offset = 0;
+  }
+  r.reserved = tail + size;  // the padding is published with the record, by commit()
+  return r.buf.get() + offset;
+}
+
+void detail::commit() {
+  auto& r = *local.r;
+  r.tail.store(r.reserved, std::memory_order_release);
+}
+
+bool start(const config& cfg) {
+  auto& s = get_state();
+  std::lock_guard<std::mutex> lck{s.mtx};
+  if (s.writer.joinable()) {
+    return true;
+  }
+  int fd = cfg.path.empty() ? STDERR_FILENO : ::open(cfg.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  s.cfg = cfg;
+  s.ring_bytes = std::max<std::size_t>(4096, std::size_t{1} << (64 - __builtin_clzll(cfg.ring_bytes - 1)));
+  s.fd = fd;
+  s.stopping.store(false, std::memory_order_relaxed);
+  s.dropped.store(0, std::memory_order_relaxed);
+  s.writer = std::thread{run_writer, std::ref(s)};
+  detail::running_flag().store(true, std::memory_order_release);
+  return true;
+}
+
+void stop() {
+  auto& s = get_state();
+  detail::running_flag().store(false, std::memory_order_release);
+  std::thread writer{};
+  {
+    std::lock_guard<std::mutex> lck{s.mtx};
+    writer = std::move(s.writer);
+    s.stopping.store(true, std::memory_order_release);
+  }
+  if (!writer.joinable()) {
+    return;
+  }
+  s.wake.notify_one();
+  writer.join();
+  std::lock_guard<std::mutex> lck{s.mtx};
+  if (s.fd != STDERR_FILENO) {
+    ::close(s.fd);
+  }
+  s.fd = -1;
+}
+
+void flush() {
+  auto& s = get_state();
+  if (!detail::running_flag().load(std::memory_order_acquire)) {
+    return;
+  }
+  // a sweep that starts after this call sees every record committed before it
+  auto target = s.sweeps.load(std::memory_order_acquire) + 2;
+  while (s.sweeps.load(std::memory_order_acquire) < target && detail::running_flag().load(std::memory_order_relaxed)) {
+    s.wake.notify_one();
+    std::this_thread::yield();
+  }
+}
+
+std::uint64_t get_dropped() { return get_state().dropped.load(std::memory_order_relaxed); }
+
+}  // namespace utils::logger
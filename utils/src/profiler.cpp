@@ -0,0 +1,267 @@
+/** @file    profiler.cpp
+ *  @time    2026/10/18 ~ 下午9:30
+ *  @author  Leon
+ *
+ *  @note    Thread-local storage, calibration and reports of utils/profiler.h
+ *
+ */
+
+#include <utils/profiler.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace utils::profiler {
+
+namespace {
+
+constexpr std::size_t RING_SIZE = 1 << 16;  // events kept per thread for the trace
+constexpr std::size_t TABLE_SIZE = 256;     // distinct labels per thread
+constexpr std::size_t NUM_BUCKETS = 64;     // log2 histogram of durations in ticks
+
+struct event {
+  const char* label;
+  std::uint64_t start;
+  std::uint64_t end;
+};
+
+struct aggregate {
+  const char* label{nullptr};
+  std::uint64_t count{0};
+  std::uint64_t sum{0};
+  std::uint64_t min{~std::uint64_t{0}};
+  std::uint64_t max{0};
+  std::array<std::uint64_t, NUM_BUCKETS> histogram{};
+};
+
+/*!
+ * Written by its thread only; the flag is taken by the owner on every record (uncontended) and by a report
+ */
+struct thread_state {
+  std::atomic_flag busy = ATOMIC_FLAG_INIT;
+  std::uint32_t tid{0};
+  std::uint64_t written{0};  // events ever written; the ring holds the last RING_SIZE
+  std::unique_ptr<event[]> ring{new event[RING_SIZE]};
+  std::array<aggregate, TABLE_SIZE> table{};
+  std::uint64_t dropped{0};  // events of labels that did not fit in the table
+
+  void lock() {
+    while (busy.test_and_set(std::memory_order_acquire)) {
+    }
+  }
+
+  void unlock() { busy.clear(std::memory_order_release); }
+};
+
+struct registry {
+  std::mutex mtx;
+  std::vector<thread_state*> threads;  // the live ones
+  // the aggregates of exited threads, by label address; their rings are freed, so a pool starting and ending
+  // threads does not grow the profiler
+  std::unordered_map<const char*, aggregate> retired;
+  std::uint32_t next_tid{1};
+  // calibration origin
+  std::uint64_t origin_ticks{detail::now_ticks()};
+  std::chrono::steady_clock::time_point origin_time{std::chrono::steady_clock::now()};
+};
+
+registry& get_registry() {
+  static registry r;
+  return r;
+}
+
+void merge(aggregate& into, const aggregate& a) {
+  into.count += a.count;
+  into.sum += a.sum;
+  into.min = std::min(into.min, a.min);
+  into.max = std::max(into.max, a.max);
+  for (std::size_t b = 0; b < NUM_BUCKETS; ++b) {
+    into.histogram[b] += a.histogram[b];
+  }
+}
+
+// A thread's state, registered on its first record and folded into the retired aggregates when the thread exits
+struct local_holder {
+  std::unique_ptr<thread_state> state{std::make_unique<thread_state>()};
+
+  local_holder() {
+    auto& r = get_registry();
+    std::lock_guard<std::mutex> lck{r.mtx};
+    state->tid = r.next_tid++;
+    r.threads.push_back(state.get());
+  }
+
+  ~local_holder() {
+    auto& r = get_registry();
+    std::lock_guard<std::mutex> lck{r.mtx};  // a report holds it while reading the state
+    for (const auto& a : state->table) {
+      if (a.label != nullptr) {
+        merge(r.retired[a.label], a);
+      }
+    }
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), state.get()));
+  }
+
+  local_holder(const local_holder&) = delete;
+  local_holder& operator=(const local_holder&) = delete;
+};
+
+thread_state& local_state() {
+  thread_local local_holder holder{};
+  return *holder.state;
+}
+
+std::size_t log2_bucket(std::uint64_t ticks) {
+  return ticks == 0 ? 0 : static_cast<std::size_t>(63 - __builtin_clzll(ticks));
+}
+
+// upper bound (in ticks) of the bucket holding the q-th quantile
+std::uint64_t quantile(const std::array<std::uint64_t, NUM_BUCKETS>& histogram, std::uint64_t count, double q) {
+  auto target = static_cast<std::uint64_t>(q * static_cast<double>(count));
+  std::uint64_t seen{0};
+  for (std::size_t b = 0; b < NUM_BUCKETS; ++b) {
+    seen += histogram[b];
+    if (seen > target) {
+      return b >= 63 ? ~std::uint64_t{0} : (std::uint64_t{2} << b);
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+
+void detail::record(const char* label, std::uint64_t start, std::uint64_t end) {
+  auto& s = local_state();
+  auto ticks = end - start;
+  s.lock();
+  s.ring[s.written++ & (RING_SIZE - 1)] = {label, start, end};
+
+  // open addressing on the label's address
+  auto h = (reinterpret_cast<std::uintptr_t>(label) >> 3) * 0x9E3779B97F4A7C15ULL;
+  for (std::size_t probe = 0; probe < TABLE_SIZE; ++probe) {
+    auto& a = s.table[(h + probe) & (TABLE_SIZE - 1)];
+    if (a.label == label || a.label == nullptr) {
+      a.label = label;
+      ++a.count;
+      a.sum += ticks;
+      a.min = std::min(a.min, ticks);
+      a.max = std::max(a.max, ticks);
+      ++a.histogram[log2_bucket(ticks)];
+      s.unlock();
+      return;
+    }
+  }
+  ++s.dropped;
+  s.unlock();
+}
+
+double ns_per_tick() {
+  auto& r = get_registry();
+  auto ticks = detail::now_ticks() - r.origin_ticks;
+  auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - r.origin_time).count();
+  return ticks == 0 ? 1.0 : ns / static_cast<double>(ticks);
+}
+
+std::vector<label_stats> report() {
+  // merge by label text: the same literal may have several addresses across translation units
+  std::unordered_map<std::string, aggregate> merged;
+  auto& r = get_registry();
+  {
+    std::lock_guard<std::mutex> lck{r.mtx};
+    for (auto* s : r.threads) {
+      s->lock();
+      for (const auto& a : s->table) {
+        if (a.label != nullptr) {
+          merge(merged[a.label], a);
+        }
+      }
+      s->unlock();
+    }
+    for (const auto& [label, a] : r.retired) {
+      merge(merged[label], a);
+    }
+  }
+
+  auto scale = ns_per_tick();
+  std::vector<label_stats> stats;
+  stats.reserve(merged.size());
+  for (const auto& [label, m] : merged) {
+    stats.push_back({label, m.count, static_cast<double>(m.sum) * scale, static_cast<double>(m.min) * scale,
+                     static_cast<double>(m.max) * scale, static_cast<double>(quantile(m.histogram, m.count, 0.5)) * scale,
+                     static_cast<double>(quantile(m.histogram, m.count, 0.99)) * scale});
+  }
+  std::sort(stats.begin(), stats.end(), [](const auto& lhs, const auto& rhs) { return lhs.total_ns > rhs.total_ns; });
+  return stats;
+}
+
+void print_report() {
+  fmt::print("{:<32} {:>10} {:>12} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "label", "count", "total(ms)", "mean(ns)",
+             "min(ns)", "p50(ns)", "p99(ns)", "max(ns)");
+  for (const auto& s : report()) {
+    fmt::print("{:<32} {:>10} {:>12.3f} {:>10.0f} {:>10.0f} {:>10.0f} {:>10.0f} {:>10.0f}\n", s.label, s.count,
+               s.total_ns / 1e6, s.total_ns / static_cast<double>(s.count), s.min_ns, s.p50_ns, s.p99_ns, s.max_ns);
+  }
+}
+
+bool dump_chrome_trace(const std::string& path) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+
+  auto& r = get_registry();
+  auto scale = ns_per_tick() / 1000.0;  // trace_event wants microseconds
+  fmt::memory_buffer out;
+  fmt::format_to(std::back_inserter(out), "{{\"traceEvents\":[\n");
+  bool first{true};
+  {
+    std::lock_guard<std::mutex> lck{r.mtx};
+    for (auto* s : r.threads) {
+      s->lock();
+      auto n = std::min<std::uint64_t>(s->written, RING_SIZE);
+      for (auto i = s->written - n; i < s->written; ++i) {
+        const auto& e = s->ring[i & (RING_SIZE - 1)];
+        fmt::format_to(std::back_inserter(out), "{}{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                       first ? "" : ",\n", e.label, s->tid,
+                       static_cast<double>(e.start - r.origin_ticks) * scale,
+                       static_cast<double>(e.end - e.start) * scale);
+        first = false;
+        if (out.size() > (1 << 20)) {  // write in chunks instead of holding the whole trace
+          std::fwrite(out.data(), 1, out.size(), file);
+          out.clear();
+        }
+      }
+      s->unlock();
+    }
+  }
+  fmt::format_to(std::back_inserter(out), "\n]}}\n");
+  std::fwrite(out.data(), 1, out.size(), file);
+  return std::fclose(file) == 0;
+}
+
+void reset() {
+  auto& r = get_registry();
+  std::lock_guard<std::mutex> lck{r.mtx};
+  for (auto* s : r.threads) {
+    s->lock();
+    s->written = 0;
+    s->dropped = 0;
+    s->table.fill(aggregate{});
+    s->unlock();
+  }
+  r.retired.clear();
+}
+
+std::size_t get_num_threads() {
+  auto& r = get_registry();
+  std::lock_guard<std::mutex> lck{r.mtx};
+  return r.threads.size();
+}
+
+}  // namespace utils::profiler
@@ -0,0 +1,62 @@
+/** @file    acceptor.h
+ *  @time    2026/10/21 ~ 下午7:30
+ *  @author  Leon
+ *
+ *  @note    One thread accepting on one listener and handing the sockets round-robin to the loops' inboxes
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <webserver/io_loop.h>
+
+namespace ws {
+
+/*!
+ * The alternative to a SO_REUSEPORT listener per loop: the kernel spreads connections over reuseport listeners by
+ * hash, this spreads them evenly, and a loop that is busy serving does not also take accept wakeups. A burst of
+ * accepts reaches a loop as one inbox batch behind one eventfd write.
+ * Usage:
+ *   ws::acceptor a{listen_fd, {loop0, loop1}};
+ *   a.start();
+ *   ...
+ *   a.stop();  // before the loops go
+ */
+class acceptor {
+ private:
+  int listen_fd;
+  int wake_fd{-1};
+  std::vector<io_loop*> loops;
+  std::size_t next{0};
+  std::thread thread{};
+  std::atomic<std::size_t> num_accepted{0};
+
+ public:
+  /*!
+   * Throws std::system_error if its eventfd cannot be made
+   * @param listen_fd a non-blocking listening socket, closed by the acceptor
+   * @param loops where the sockets go; not empty, and they outlive the acceptor's thread
+   */
+  acceptor(int listen_fd, std::vector<io_loop*> loops);
+  ~acceptor();
+
+  acceptor(const acceptor&) = delete;
+  acceptor& operator=(const acceptor&) = delete;
+
+  void start();
+
+  /*!
+   * Stop accepting and join the thread
+   */
+  void stop();
+
+  [[nodiscard]] std::size_t get_num_accepted() const { return num_accepted.load(std::memory_order_relaxed); }
+
+ private:
+  void run();
+};
+
+}  // namespace ws
@@ -0,0 +1,32 @@
+/** @file    access_log.h
+ *  @time    2026/10/21 ~ 上午11:30
+ *  @author  Leon
+ *
+ *  @note    A handler wrapper writing one line per request through the asynchronous utils::logger
+ *
+ */
+
+#pragma once
+
+#include <webserver/http.h>
+
+namespace ws {
+
+/*!
+ * Log "<method> <target> <status> <body bytes>" at info level after `inner` ran, on the reactor thread; the line is
+ * formatted and written by the logger's thread:
+ *   utils::logger::start({"access.log"});
+ *   ws::server srv{config, ws::access_log{ws::static_files{files}}};
+ * The size is that of the body before any content coding.
+ */
+class access_log {
+ private:
+  handler inner;
+
+ public:
+  explicit access_log(handler h) : inner(std::move(h)) {}
+
+  void operator()(const request& req, response& resp) const;
+};
+
+}  // namespace ws
@@ -0,0 +1,60 @@
+/** @file    arena.h
+ *  @time    2026/10/19 ~ 下午3:50
+ *  @author  Leon
+ *
+ *  @note    Request-scoped bump allocator over pooled buffers, usable by std::pmr containers
+ *
+ */
+
+#pragma once
+
+#include <memory_resource>
+#include <webserver/buffer_pool.h>
+
+namespace ws {
+
+/*!
+ * Allocation is a pointer bump; deallocation is a no-op; `reset()` gives every block back to the reactor's cache at
+ * once. Containers using the arena must drop their storage (not just clear()) before the reset.
+ * Usage:
+ *   ws::arena a{cache};
+ *   std::pmr::vector<ws::header> headers{&a};
+ *   ...
+ *   headers = std::pmr::vector<ws::header>{&a};
+ *   a.reset();
+ */
+class arena : public std::pmr::memory_resource {
+ private:
+  static constexpr std::size_t MIN_BLOCK = buffer_pool::MIN_SIZE;
+
+  // each block starts with the previous one, so the chain needs no container of its own
+  struct block_header {
+    pooled_buffer prev;
+  };
+
+  buffer_cache* cache;
+  pooled_buffer current{};
+  std::size_t used{0};       // bytes used in `current`
+  std::size_t allocated{0};  // bytes of all blocks held
+
+ public:
+  explicit arena(buffer_cache& c) : cache(&c) {}
+  ~arena() override { reset(); }
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  /*!
+   * Release every block
+   */
+  void reset();
+
+  [[nodiscard]] std::size_t get_allocated() const { return allocated; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+  [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+}  // namespace ws
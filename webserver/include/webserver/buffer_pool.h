@@ -0,0 +1,106 @@
+/** @file    buffer_pool.h
+ *  @time    2026/10/19 ~ 下午3:30
+ *  @author  Leon
+ *
+ *  @note    Size-classed I/O buffers: a global pool behind per-reactor caches, so connections borrow buffers only while
+ *           data is in flight
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+
+namespace ws {
+
+struct pooled_buffer {
+  char* data{nullptr};
+  std::size_t capacity{0};
+
+  explicit operator bool() const { return data != nullptr; }
+};
+
+/*!
+ * Free lists per size class (4K, 16K, 64K, 256K, 1M), shared by all reactors. Reactors move buffers in and out in
+ * batches through their buffer_cache, so the lock is taken once per batch, not per buffer.
+ */
+class buffer_pool {
+ public:
+  static constexpr std::size_t NUM_CLASSES = 5;
+  static constexpr std::size_t MIN_SIZE = 4 * 1024;
+
+  // the class whose buffers hold `size` bytes; NUM_CLASSES if no class is large enough
+  static std::size_t class_of(std::size_t size);
+  static std::size_t class_size(std::size_t cls) { return MIN_SIZE << (2 * cls); }
+
+ private:
+  struct central {
+    std::mutex mtx{};
+    std::vector<char*> free{};
+  };
+
+  std::array<central, NUM_CLASSES> classes{};
+  std::size_t max_cached_bytes;  // per class; beyond it, returned buffers are freed
+
+ public:
+  explicit buffer_pool(std::size_t max_cached_bytes_per_class = 64 * 1024 * 1024);
+  ~buffer_pool();
+
+  buffer_pool(const buffer_pool&) = delete;
+  buffer_pool& operator=(const buffer_pool&) = delete;
+
+  /*!
+   * Move up to `n` free buffers of class `cls` to `out` (allocating new ones if the pool has too few)
+   */
+  void take(std::size_t cls, std::vector<char*>& out, std::size_t n);
+
+  /*!
+   * Move the last `n` buffers of `in` back to the pool
+   */
+  void give(std::size_t cls, std::vector<char*>& in, std::size_t n);
+
+  [[nodiscard]] std::size_t get_num_free(std::size_t cls);
+};
+
+/*!
+ * One reactor's view of the pool: lock-free, touched by the reactor thread only.
+ */
+class buffer_cache {
+ private:
+  static constexpr std::size_t BATCH = 16;
+  static constexpr std::size_t MAX_LOCAL = 2 * BATCH;
+
+  buffer_pool& pool;
+  std::array<std::vector<char*>, buffer_pool::NUM_CLASSES> local{};
+  std::atomic<std::size_t> bytes_in_use{0};  // handed out and not released; read by other threads for stats
+
+ public:
+  explicit buffer_cache(buffer_pool& p) : pool(p) {}
+  ~buffer_cache();
+
+  buffer_cache(const buffer_cache&) = delete;
+  buffer_cache& operator=(const buffer_cache&) = delete;
+
+  /*!
+   * A buffer of at least `min_size` bytes; sizes above the largest class come straight from the heap
+   */
+  pooled_buffer acquire(std::size_t min_size);
+
+  /*!
+   * Give `buf` back and empty it; a no-op on an empty buffer
+   */
+  void release(pooled_buffer& buf);
+
+  [[nodiscard]] std::size_t get_bytes_in_use() const { return bytes_in_use.load(std::memory_order_relaxed); }
+
+ private:
+  void add_in_use(std::ptrdiff_t delta) {
+    bytes_in_use.store(bytes_in_use.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+  }
+};
+
+}  // namespace ws
@@ -0,0 +1,54 @@
+/** @file    byte_ranges.h
+ *  @time    2026/10/22 ~ 下午8:00
+ *  @author  Leon
+ *
+ *  @note    Range and If-Range for file bodies, and the multipart/byteranges framing around several parts
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <webserver/http.h>
+#include <webserver/file_cache.h>
+
+namespace ws {
+
+/*!
+ * Parse the value of a Range header against a body of `size` bytes (RFC 9110 14.1.2)
+ * @param out the satisfiable ranges, in the order asked for; empty if none is (to be answered with 416)
+ * @return false if the header is to be ignored and the whole body sent: another unit than bytes, a malformed range,
+ *         more than 16 ranges, or ranges adding up to more than the body (overlaps asking for it many times over)
+ */
+bool parse_ranges(std::string_view value, std::int64_t size, std::vector<byte_range>& out);
+
+/*!
+ * @param value an If-Range header: an entity tag or an HTTP-date
+ * @return whether it names `file` as it is now; a weak tag never does
+ */
+bool if_range_matches(std::string_view value, const open_file& file);
+
+/*!
+ * @return bytes of the body of a 206 sending `ranges` of `file`: the parts, and their framing if there are several
+ */
+std::int64_t ranges_length(const open_file& file, const std::vector<byte_range>& ranges);
+
+/*!
+ * @return "multipart/byteranges; boundary=...", the Content-Type of a response with several parts
+ */
+std::string_view multipart_type();
+
+/*!
+ * @return what precedes a part of `file` in a multipart/byteranges body: the delimiter and the part's headers
+ */
+std::string part_head(const open_file& file, const byte_range& r);
+
+/*!
+ * @return the closing delimiter of a multipart/byteranges body
+ */
+std::string_view multipart_tail();
+
+}  // namespace ws
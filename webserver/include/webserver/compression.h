@@ -0,0 +1,105 @@
+/** @file    compression.h
+ *  @time    2026/10/20 ~ 上午10:00
+ *  @author  Leon
+ *
+ *  @note    gzip / brotli content coding: negotiation, one-shot encoders, and the worker pool that keeps compression
+ *           off the reactor threads
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <threadpool/steady_pool.h>
+#include <webserver/http.h>
+
+namespace ws {
+
+/*!
+ * @return "gzip", "br", or "identity"
+ */
+std::string_view encoding_name(encoding e);
+
+/*!
+ * @return whether this build can produce `e` (gzip needs zlib, br the brotli encoder)
+ */
+bool is_available(encoding e);
+
+/*!
+ * @param accept_encoding the request's Accept-Encoding value
+ * @return the available coding the client accepts (q > 0), br before gzip; identity if none
+ */
+encoding negotiate(std::string_view accept_encoding);
+
+/*!
+ * @return whether bodies of this type shrink enough to be worth encoding (text, JSON, JS, XML, SVG, wasm)
+ */
+bool is_compressible(std::string_view content_type);
+
+/*!
+ * Encode `in` in one shot
+ * @param level zlib level 1..9, or brotli quality 0..11
+ * @return false if `e` is not available or the encoder failed
+ */
+bool compress(std::string_view in, encoding e, int level, std::string& out);
+
+struct compression_config {
+  bool enabled{false};  // off by default: the workers spin while idle (tp::SteadyThreadPool)
+  std::size_t num_workers{2};
+  std::size_t min_size{1024};                   // smaller bodies go out as they are
+  std::size_t max_file_size{16 * 1024 * 1024};  // larger static files are sent unencoded
+  int gzip_level{6};
+  int brotli_quality{5};
+};
+
+/*!
+ * Decides, after the handler ran, whether a response goes out encoded. A static file or a cached (prepared) response
+ * is encoded once, on a worker, and the copy is kept next to the original for every later request; until it is ready
+ * the original is sent. Any other body is encoded per response, also on a worker, and handed back through `done`.
+ * Responses below `min_size`, replies to HEAD and clients without a matching Accept-Encoding are never held up.
+ */
+class compressor {
+ private:
+  compression_config config;
+  tp::SteadyThreadPool workers;
+
+ public:
+  explicit compressor(const compression_config& cfg);
+
+  compressor(const compressor&) = delete;
+  compressor& operator=(const compressor&) = delete;
+
+  /*!
+   * Called after the handler: switch `resp` to a ready encoded copy, or start encoding a file / prepared response in
+   * the background (sending the original meanwhile), or pick an encoding for a body only this response has
+   * @return the encoding to give the body with encode_async(); identity if `resp` can be sent as it is now
+   */
+  encoding prepare(const request& req, response& resp);
+
+  /*!
+   * Encode the body of `resp` with `e` on a worker, then call `done` there with the response (sent unencoded if that
+   * did not make it smaller)
+   */
+  void encode_async(response&& resp, encoding e, std::function<void(response&&)> done);
+
+  /*!
+   * encode_async() on the calling thread, for one that is a worker already (see handler_pool)
+   */
+  void encode_body(response& resp, encoding e) const;
+
+  /*!
+   * Wait until no encoding is in flight
+   */
+  void wait() { workers.wait_for_tasks(); }
+
+  [[nodiscard]] const compression_config& get_config() const { return config; }
+
+ private:
+  int level_of(encoding e) const { return e == encoding::br ? config.brotli_quality : config.gzip_level; }
+  void encode_prepared(std::shared_ptr<const prepared_response> original, encoding e);
+  void encode_file(std::shared_ptr<const open_file> file, encoding e);
+};
+
+}  // namespace ws
@@ -0,0 +1,105 @@
+/** @file    connection.h
+ *  @time    2026/10/18 ~ 下午10:40
+ *  @author  Leon
+ *
+ *  @note    One client socket, owned by exactly one reactor: every member is touched by that reactor's thread only
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <event2/event.h>
+#include <webserver/http.h>
+#include <webserver/http_parser.h>
+#include <webserver/socket.h>
+#include <webserver/arena.h>
+#include <webserver/buffer_pool.h>
+#include <webserver/timing_wheel.h>
+#include <webserver/output_chain.h>
+
+namespace ws {
+
+class reactor;
+
+/*!
+ * Persistent and pipelined: every complete request in the read buffer is answered in order, and the responses of
+ * one read leave together in a single flush of the output chain.
+ * Buffers are borrowed from the reactor's cache while bytes are in flight and per-request state lives in an arena
+ * that is reset once the connection is quiescent, so an idle keep-alive connection holds no memory beyond itself.
+ * One wheel timer covers the idle, read-header and write timeouts: whichever applies to the current state.
+ */
+class connection {
+ private:
+  enum class wait : std::uint8_t { idle, header, write };
+
+  reactor& owner;
+  int fd;
+  std::uint64_t id;
+  net::ip_address peer;  // what the rate limiter knows the client by
+  event* read_ev{nullptr};
+  event* write_ev{nullptr};
+  arena mem;  // parser offsets, header views, output segment list; declared first, destroyed last
+  pooled_buffer in{};  // bytes received and not yet consumed by a complete request ...
+  std::size_t in_len{0};  // ... the first `in_len` of it
+  output_chain out;
+  bool writing{false};  // blocked on a full socket: waiting for EV_WRITE, reading paused
+  bool closing{false};  // close once `out` is flushed
+  bool offloaded{false};  // a worker is finishing the next response: reading and answering paused
+  bool admitted{false};  // the request at the front of `in` passed the rate limiter
+  http_parser parser;  // keeps its progress on the partial request at the front of `in`
+  request req;
+  wheel_timer timer;
+  wait waiting{wait::idle};  // what `timer` currently times
+
+ public:
+  /*!
+   * Takes ownership of `fd`, which must be non-blocking
+   * @param id unique within the reactor
+   * @param peer the client's address, if the reactor limits rates
+   */
+  connection(reactor& r, int fd, std::uint64_t id, const net::ip_address& peer = {});
+  ~connection();
+
+  connection(const connection&) = delete;
+  connection& operator=(const connection&) = delete;
+
+  void start();
+
+  [[nodiscard]] int get_fd() const { return fd; }
+  [[nodiscard]] std::uint64_t get_id() const { return id; }
+
+  /*!
+   * The response a worker finished (see reactor::offload) is back: send it and go on with the requests behind it
+   */
+  void resume(response& resp);
+
+ private:
+  static void on_readable(evutil_socket_t fd, short what, void* arg);
+  static void on_writable(evutil_socket_t fd, short what, void* arg);
+  static void on_timeout(void* arg);
+
+  // Each of these returns false when the connection was closed (and `this` destroyed)
+  bool handle_read();
+  bool handle_write();
+  bool process_requests();
+  bool flush_output();
+
+  void append_response(response& resp, bool head_only);
+  void respond_error(int status);
+
+  // once the request at the front of `in` has its head: false if the rate limiter refused it (answered with 429)
+  bool admit(std::string_view buf);
+
+  // make room for at least one more read in `in`
+  void reserve_input();
+
+  // give back the read buffer and the arena if nothing is in flight
+  void release_idle();
+
+  // (re)schedule the timeout for the current state; a request head's deadline is not extended by more bytes
+  void arm_timer();
+};
+
+}  // namespace ws
@@ -0,0 +1,113 @@
+/** @file    file_cache.h
+ *  @time    2026/10/19 ~ 上午11:00
+ *  @author  Leon
+ *
+ *  @note    Sharded LRU cache of open static files: fd, size, mtime and the pre-rendered entity headers
+ *
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <string_view>
+#include <unordered_map>
+#include <sys/types.h>
+#include <webserver/http.h>
+
+namespace ws {
+
+/*!
+ * An open file; the fd stays open while anyone (e.g. a connection still sending it) holds the pointer, even after
+ * the cache evicted or replaced it.
+ */
+struct open_file {
+  int fd{-1};
+  off_t size{0};
+  timespec mtime{};
+  ino_t inode{0};
+  std::string content_type{};
+  std::string last_modified{};  // an HTTP-date
+  std::string etag{};  // strong, from the modification time and size
+  // "Content-Type: ...\r\nLast-Modified: ...\r\nAccept-Ranges: bytes\r\n", ready to copy into a response; Content-Type
+  // comes first, so a multipart response can leave it out. The ETag is not among them: an encoded copy sends it weak
+  std::string headers{};
+  encoded_variants<std::string> encoded{};  // the content compressed, filled in by a compressor
+
+  open_file() = default;
+  ~open_file();
+  open_file(const open_file&) = delete;
+  open_file& operator=(const open_file&) = delete;
+};
+
+struct file_cache_config {
+  std::string root{"."};
+  std::size_t num_shards{16};
+  std::size_t max_fds{1024};  // open files kept by the cache in total
+  std::chrono::milliseconds revalidate_after{1000};  // a hit older than this is checked with one stat()
+};
+
+/*!
+ * `lookup` costs a hash, one shard lock and, at most once per `revalidate_after`, a stat(): the open() and fstat()
+ * of a plain static server are gone from the hot path. Shards keep reactors from contending on one lock.
+ */
+class file_cache {
+ private:
+  struct entry {
+    std::string path;
+    std::shared_ptr<const open_file> file;
+    std::chrono::steady_clock::time_point validated_at;
+  };
+
+  struct shard {
+    std::mutex mtx{};
+    std::list<entry> lru{};  // most recently used first
+    std::unordered_map<std::string_view, std::list<entry>::iterator> index{};  // keys view entry::path
+  };
+
+  file_cache_config config;
+  std::size_t max_per_shard;
+  std::vector<std::unique_ptr<shard>> shards;
+
+ public:
+  explicit file_cache(file_cache_config cfg = {});
+
+  file_cache(const file_cache&) = delete;
+  file_cache& operator=(const file_cache&) = delete;
+
+  /*!
+   * @param path the request path ("/" means "/index.html"); ".." segments are refused
+   * @return the file under the root, or nullptr if there is no regular file there
+   */
+  std::shared_ptr<const open_file> lookup(std::string_view path);
+
+  /*!
+   * Drop every cached entry (their fds close once no response uses them)
+   */
+  void clear();
+
+  [[nodiscard]] std::size_t get_num_open() const;
+
+  [[nodiscard]] const std::string& get_root() const { return config.root; }
+
+ private:
+  shard& shard_of(std::string_view path);
+  std::shared_ptr<const open_file> open(const std::string& full_path) const;
+};
+
+/*!
+ * Read all of `file` into `out` with pread(2)
+ * @return false on an error or if the file is shorter than when it was opened
+ */
+bool read_all(const open_file& file, std::string& out);
+
+/*!
+ * @return the MIME type for the extension of `path`, "application/octet-stream" if unknown
+ */
+std::string_view mime_type(std::string_view path);
+
+}  // namespace ws
@@ -0,0 +1,74 @@
+/** @file    handler_pool.h
+ *  @time    2026/10/21 ~ 下午10:00
+ *  @author  Leon
+ *
+ *  @note    CPU-heavy handlers off the event loops: a worker pool finishing deferred responses, and ws::offload
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <threadpool/dynamic_pool.h>
+#include <webserver/http.h>
+#include <webserver/io_loop.h>
+#include <webserver/compression.h>
+
+namespace ws {
+
+/*!
+ * Finishes the responses a handler deferred (response::deferred) so that an expensive endpoint - an image resize, a
+ * template render - does not stall the thousands of connections sharing its loop. The connection stays with its
+ * loop, paused after that request. A worker runs the deferred part with a copy of the request, then does what the
+ * loop would do next: picks and applies the content coding and renders the response into one prepared buffer, so the
+ * loop is left with appending it to the connection's output. Responses come back through the loop's inbox; those
+ * finished while the loop was busy are taken in one batch, behind one wakeup.
+ * Idle workers sleep (tp::DynamicThreadPool): a server whose handlers never defer pays nothing for them.
+ */
+class handler_pool {
+ private:
+  tp::DynamicThreadPool workers;
+  compressor* compression;  // null: no content coding
+
+ public:
+  handler_pool(std::size_t num_threads, compressor* c);
+
+  handler_pool(const handler_pool&) = delete;
+  handler_pool& operator=(const handler_pool&) = delete;
+
+  /*!
+   * Finish `resp` on a worker, then call `done` with it on `loop`'s thread
+   * @param req copied before this returns
+   */
+  void run(io_loop& loop, const request& req, response&& resp, std::function<void(response&)> done);
+
+  /*!
+   * Wait until no response is being finished
+   */
+  void wait() { workers.wait_for_tasks(); }
+
+  /*!
+   * Run the deferred part of `resp` and prepare it for sending, on the calling thread
+   */
+  static void finish(const request& req, response& resp, compressor* c);
+};
+
+/*!
+ * Run `inner` on the server's handler pool rather than on the reactor:
+ *   ws::server srv{config, ws::offload{render_report}};
+ * For a router, mark the heavy routes instead (router::add(..., ws::run_on::pool)).
+ */
+class offload {
+ private:
+  std::shared_ptr<const handler> inner;
+
+ public:
+  explicit offload(handler h) : inner(std::make_shared<const handler>(std::move(h))) {}
+
+  void operator()(const request&, response& resp) const {
+    resp.deferred = [h = inner](const request& req, response& r) { (*h)(req, r); };
+  }
+};
+
+}  // namespace ws
@@ -0,0 +1,69 @@
+/** @file    header_builder.h
+ *  @time    2026/10/20 ~ 下午8:00
+ *  @author  Leon
+ *
+ *  @note    Response heads rendered with compile-time format strings into a reused buffer, from pre-serialized status
+ *           lines, with a per-reactor Date line re-rendered once a second
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <ctime>
+#include <string_view>
+#include <fmt/format.h>
+#include <webserver/http.h>
+
+namespace ws {
+
+/*!
+ * @return "HTTP/1.1 <status> <reason>\r\n", rendered once at startup for every status status_reason() knows; an empty
+ *         view for the others
+ */
+std::string_view status_line(int status);
+
+/*!
+ * Append the head of `resp` to `out`: status line, Content-Type / the file's entity headers, Content-Length, the
+ * handler's headers, `date` (a whole "Date: ...\r\n" line, or empty), Connection and the empty line
+ */
+void render_head(fmt::memory_buffer& out, const response& resp, std::string_view date);
+
+/*!
+ * One per reactor, so nothing here is shared: the head of each response is rendered into the same buffer, and the
+ * Date line is rendered by the reactor's tick when the second changes rather than per response.
+ */
+class header_builder {
+ private:
+  fmt::memory_buffer buf{};
+  std::array<char, 64> date{};  // "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+  std::size_t date_size{0};
+  std::time_t date_time{-1};
+
+ public:
+  header_builder() { update_date(std::time(nullptr)); }
+
+  header_builder(const header_builder&) = delete;
+  header_builder& operator=(const header_builder&) = delete;
+
+  /*!
+   * Re-render the Date line if `now` is another second than the last one
+   */
+  void update_date(std::time_t now);
+
+  /*!
+   * @return the Date line, "\r\n" included
+   */
+  [[nodiscard]] std::string_view get_date() const { return {date.data(), date_size}; }
+
+  /*!
+   * @return the rendered head of `resp`, valid until the next build()
+   */
+  std::string_view build(const response& resp) {
+    buf.clear();
+    render_head(buf, resp, get_date());
+    return {buf.data(), buf.size()};
+  }
+};
+
+}  // namespace ws
@@ -0,0 +1,160 @@
+/** @file    http.h
+ *  @time    2026/10/18 ~ 下午10:10
+ *  @author  Leon
+ *
+ *  @note    HTTP/1.1 request and response types shared by the reactors and the handlers
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <functional>
+
+namespace ws {  // web server
+
+struct header {
+  std::string_view name;
+  std::string_view value;
+};
+
+/*!
+ * A parsed request. Every view points into the connection's read buffer and is valid only while the handler runs;
+ * the header list lives in the connection's arena.
+ */
+struct request {
+  std::string_view method{};
+  std::string_view target{};  // as sent: path + query
+  std::string_view path{};
+  std::string_view query{};
+  int version_minor{1};  // HTTP/1.<minor>
+  std::pmr::vector<header> headers{};
+  std::string_view body{};
+  bool keep_alive{true};
+
+  request() = default;
+  explicit request(std::pmr::memory_resource* resource) : headers(resource) {}
+
+  /*!
+   * @return the value of the first header named `name` (case-insensitive), or an empty view
+   */
+  [[nodiscard]] std::string_view get_header(std::string_view name) const;
+};
+
+/*!
+ * @return a copy of `req` owning everything it views, for work that outlives the connection's buffers (a deferred
+ * handler, see response::deferred)
+ */
+std::shared_ptr<const request> copy_request(const request& req);
+
+struct open_file;
+
+enum class encoding : std::uint8_t { identity, gzip, br };
+
+/*!
+ * Bytes `first` to `last` of a body, both included, as a Range header counts them
+ */
+struct byte_range {
+  std::int64_t first;
+  std::int64_t last;
+
+  [[nodiscard]] std::int64_t length() const { return last - first + 1; }
+};
+
+/*!
+ * Compressed copies of an immutable body, attached by whichever worker encoded it first and shared from then on. An
+ * empty copy records that the encoding did not pay off.
+ */
+template <typename T>
+class encoded_variants {
+ private:
+  mutable std::array<std::shared_ptr<const T>, 3> copies{};  // by encoding; only through std::atomic_load/store
+  mutable std::atomic<std::uint8_t> started{0};              // a bit per encoding
+
+ public:
+  [[nodiscard]] std::shared_ptr<const T> get(encoding e) const {
+    return std::atomic_load(&copies[static_cast<std::size_t>(e)]);
+  }
+
+  void set(encoding e, std::shared_ptr<const T> copy) const {
+    std::atomic_store(&copies[static_cast<std::size_t>(e)], std::move(copy));
+  }
+
+  /*!
+   * @return true for the first caller only: that one encodes, the others send the original meanwhile
+   */
+  bool try_start(encoding e) const {
+    auto bit = static_cast<std::uint8_t>(1U << static_cast<unsigned>(e));
+    return (started.fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+  }
+};
+
+/*!
+ * A response rendered once and shared, immutable, by every connection sending it. `bytes` holds the head without the
+ * Connection header, then "Connection: keep-alive\r\n\r\n", then the body: a keep-alive answer is one contiguous run.
+ */
+struct prepared_response {
+  std::string bytes{};
+  std::size_t head_size{0};    // up to the Connection header
+  std::size_t body_offset{0};  // the body runs from here to the end
+  bool compressible{false};    // a text body worth encoding
+  encoded_variants<prepared_response> encoded{};
+
+  /*!
+   * @param head the status line and headers, without the Connection header and the empty line
+   */
+  void assign(std::string head, std::string_view body);
+
+  [[nodiscard]] std::string_view get_body() const { return std::string_view{bytes}.substr(body_offset); }
+};
+
+struct response {
+  int status{200};
+  std::string content_type{"text/plain"};
+  std::vector<std::pair<std::string, std::string>> headers{};
+  std::string body{};
+  std::shared_ptr<const open_file> file{};  // if set, the body is this file, sent with sendfile(2)
+  // with `file`: only these parts of it are sent, in a 206; several as multipart/byteranges (see byte_ranges.h)
+  std::vector<byte_range> ranges{};
+  std::shared_ptr<const std::string> shared_body{};  // if set, the body in place of `body` or the file's content
+  std::shared_ptr<const prepared_response> prepared{};  // if set, sent as is: status, headers and body are ignored
+  // if set, nothing is sent yet: this runs on the server's handler pool with a copy of the request and finishes the
+  // response there (see handler_pool); what a CPU-heavy route or ws::offload leaves behind
+  std::function<void(const request&, response&)> deferred{};
+  bool keep_alive{true};
+
+  /*!
+   * Append the status line and headers, up to and including the empty line, to `out`; without a Date line, which the
+   * reactors add as they send (see header_builder)
+   */
+  void serialize_head(std::string& out) const;
+
+  /*!
+   * serialize_head() and (unless `head_only`) the in-memory body; a `file` body is left to the caller
+   */
+  void serialize(std::string& out, bool head_only = false) const;
+};
+
+using handler = std::function<void(const request&, response&)>;
+
+/*!
+ * @return the reason phrase of `status`, e.g. "Not Found" for 404
+ */
+std::string_view status_reason(int status);
+
+/*!
+ * ASCII case-insensitive comparison, as header names require
+ */
+bool iequals(std::string_view lhs, std::string_view rhs);
+
+enum class parse_status { complete, incomplete, error };
+
+}  // namespace ws
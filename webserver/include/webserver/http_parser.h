@@ -0,0 +1,115 @@
+/** @file    http_parser.h
+ *  @time    2026/10/19 ~ 上午9:30
+ *  @author  Leon
+ *
+ *  @note    Incremental, zero-copy HTTP/1.1 request parser
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <memory_resource>
+#include <string_view>
+#include <webserver/http.h>
+
+namespace ws {
+
+struct parser_limits {
+  std::size_t max_request_line{8 * 1024};   // 414 beyond
+  std::size_t max_header_bytes{64 * 1024};  // request line + headers; 431 beyond
+  std::size_t max_headers{64};              // 431 beyond
+  std::size_t max_body{8 * 1024 * 1024};    // 413 beyond
+};
+
+/*!
+ * Parses one request at a time from the front of a buffer that only grows between calls (the connection's read
+ * buffer, which may be reallocated: the parser keeps offsets, not pointers). Scanning resumes where the previous
+ * call stopped, so a request arriving in many fragments is scanned once. The request's views are built on
+ * completion and point into the buffer.
+ * Usage:
+ *   auto status = parser.parse(std::string_view{buf}.substr(start), req);
+ *   if (status == ws::parse_status::complete) { handle(req); start += parser.get_consumed(); parser.reset(); }
+ */
+class http_parser {
+ private:
+  enum class state : std::uint8_t { request_line, headers, body, done, error };
+
+  struct field {
+    std::uint32_t name_off;
+    std::uint32_t name_len;
+    std::uint32_t value_off;
+    std::uint32_t value_len;
+  };
+
+  parser_limits limits;
+  state st{state::request_line};
+  std::size_t pos{0};         // next byte to scan
+  std::size_t line_start{0};  // first byte of the line being scanned
+  std::size_t name_end{0};    // offset of the current header line's ':' (0 if not seen yet)
+  // request line
+  std::uint32_t method_off{0};
+  std::uint32_t method_len{0};
+  std::uint32_t target_off{0};
+  std::uint32_t target_len{0};
+  int version_minor{1};
+  std::pmr::vector<field> fields;  // reused across requests until release()
+  // framing, decided from the headers
+  std::size_t header_size{0};
+  std::size_t content_length{0};
+  bool has_content_length{false};
+  bool has_transfer_encoding{false};
+  bool connection_close{false};
+  bool connection_keep_alive{false};
+  int error_status{0};
+
+ public:
+  /*!
+   * @param resource where the header offsets live (the connection's arena)
+   */
+  explicit http_parser(parser_limits l = {}, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : limits(l), fields(resource) {}
+
+  /*!
+   * Continue parsing `buf`, which starts at the request's first byte and holds at least what the previous call saw.
+   * @return complete: `req` is filled and get_consumed() bytes belong to it; error: see get_error_status()
+   */
+  parse_status parse(std::string_view buf, request& req);
+
+  /*!
+   * Start over for the next request
+   */
+  void reset();
+
+  /*!
+   * reset() and drop the header offsets' storage, before the arena under it is reset
+   */
+  void release();
+
+  [[nodiscard]] std::size_t get_consumed() const { return header_size + content_length; }
+
+  /*!
+   * @return whether the request line and headers are parsed, even if the body has not all arrived
+   */
+  [[nodiscard]] bool has_head() const { return st == state::body || st == state::done; }
+
+  /*!
+   * @param buf what the last parse() call was given
+   * @return the request target, once has_head()
+   */
+  [[nodiscard]] std::string_view get_target(std::string_view buf) const { return buf.substr(target_off, target_len); }
+
+  /*!
+   * @return the status to answer a malformed request with: 400, 413, 414, 431 or 501
+   */
+  [[nodiscard]] int get_error_status() const { return error_status; }
+
+ private:
+  parse_status fail(int status);
+  bool parse_request_line(std::string_view buf, std::size_t start, std::size_t end);
+  bool add_field(std::string_view buf, std::size_t start, std::size_t colon, std::size_t end);
+  void build(std::string_view buf, request& req) const;
+};
+
+}  // namespace ws
@@ -0,0 +1,104 @@
+/** @file    inbox.h
+ *  @time    2026/10/21 ~ 下午7:00
+ *  @author  Leon
+ *
+ *  @note    A loop's lock-free multi-producer inbox with an eventfd doorbell: accepted sockets handed over by another
+ *           thread, and work posted back to the loop (e.g. results of thread pool tasks)
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace ws {
+
+/*!
+ * Producers push onto a lock-free stack; the loop takes the whole stack with one exchange and runs it oldest first.
+ * Only a push onto an empty inbox rings the doorbell: the pushes after it ride along until the loop takes the batch,
+ * so one eventfd write (and one wakeup of the loop) covers all of them. No lock is shared with the loop, hence none
+ * inside libevent either.
+ * Usage:
+ *   ws::inbox in{};                       // watch in.get_fd() for reads in the loop
+ *   in.post([] { ... });                  // any thread
+ *   in.post_fd(fd);
+ *   in.run([&](int fd) { adopt(fd); });   // the loop, once the doorbell rang (after reading the eventfd)
+ */
+class inbox {
+ private:
+  struct message {
+    message* next;
+    int fd;  // >= 0: a socket to adopt, else run `fn`
+    std::function<void()> fn;
+  };
+
+  std::atomic<message*> top{nullptr};
+  int bell{-1};  // eventfd
+  std::atomic<std::uint64_t> num_rings{0};
+
+ public:
+  /*!
+   * Throws std::system_error if the eventfd cannot be made
+   */
+  inbox();
+
+  /*!
+   * Closes the sockets nobody took; drops the work
+   */
+  ~inbox();
+
+  inbox(const inbox&) = delete;
+  inbox& operator=(const inbox&) = delete;
+
+  /*!
+   * @return the doorbell, readable while the inbox holds messages; the loop reads (resets) it before run()
+   */
+  [[nodiscard]] int get_fd() const { return bell; }
+
+  /*!
+   * Any thread
+   */
+  void post(std::function<void()> fn) { push(new message{nullptr, -1, std::move(fn)}); }
+
+  /*!
+   * Any thread; the inbox owns `fd` from here on
+   */
+  void post_fd(int fd) { push(new message{nullptr, fd, {}}); }
+
+  /*!
+   * The consumer only: deliver what arrived, each producer's messages in the order it posted them
+   * @return messages delivered
+   */
+  template <typename OnFd>
+  std::size_t run(OnFd&& on_fd) {
+    message* m = take();
+    std::size_t n{0};
+    while (m != nullptr) {
+      auto* next = m->next;
+      if (m->fd >= 0) {
+        on_fd(m->fd);
+      } else {
+        m->fn();
+      }
+      delete m;
+      m = next;
+      ++n;
+    }
+    return n;
+  }
+
+  /*!
+   * @return eventfd writes so far; against the messages posted, how well wakeups coalesce
+   */
+  [[nodiscard]] std::uint64_t get_num_rings() const { return num_rings.load(std::memory_order_relaxed); }
+
+ private:
+  void push(message* m);
+
+  // the whole stack, reversed into posting order
+  message* take();
+};
+
+}  // namespace ws
@@ -0,0 +1,70 @@
+/** @file    io_loop.h
+ *  @time    2026/10/19 ~ 下午7:00
+ *  @author  Leon
+ *
+ *  @note    What the server needs from an event loop thread, whichever I/O backend drives it
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace ws {
+
+enum class backend { libevent, io_uring };
+
+/*!
+ * One loop per core, each serving the connections it accepted on its own SO_REUSEPORT listener, or, without a listener
+ * of its own, those an acceptor thread hands it with adopt(). Everything here may be called from any thread.
+ */
+class io_loop {
+ public:
+  virtual ~io_loop() = default;
+
+  virtual void start() = 0;
+
+  /*!
+   * Break the loop; open connections are closed when the loop is destroyed
+   */
+  virtual void stop() = 0;
+
+  virtual void join() = 0;
+
+  /*!
+   * Run `fn` on the loop's thread, soon; how work done elsewhere (e.g. on a thread pool) comes back to a connection.
+   * Dropped if the loop is destroyed first.
+   */
+  virtual void post(std::function<void()> fn) = 0;
+
+  /*!
+   * Serve the accepted, non-blocking socket `fd`; the loop owns it from here on (closed if the loop stops first)
+   */
+  virtual void adopt(int fd) = 0;
+
+  [[nodiscard]] virtual std::size_t get_num_requests() const = 0;
+  [[nodiscard]] virtual std::size_t get_num_connections() const = 0;
+  [[nodiscard]] virtual std::size_t get_buffer_bytes_in_use() const = 0;
+};
+
+/*!
+ * Run `work` on `pool` (a tp:: pool), then `done(result)` - or `done()` for a void `work` - on `loop`'s thread
+ * Usage:
+ *   ws::run_then(pool, loop, [] { return render(); }, [](std::string&& page) { ... });
+ */
+template <typename Pool, typename Work, typename Done>
+void run_then(Pool& pool, io_loop& loop, Work work, Done done) {
+  pool.post([&loop, work = std::move(work), done = std::move(done)]() mutable {
+    if constexpr (std::is_void_v<std::invoke_result_t<Work&>>) {
+      work();
+      loop.post(std::move(done));
+    } else {
+      loop.post([result = work(), done = std::move(done)]() mutable { done(std::move(result)); });
+    }
+  });
+}
+
+}  // namespace ws
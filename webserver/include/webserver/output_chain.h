@@ -0,0 +1,137 @@
+/** @file    output_chain.h
+ *  @time    2026/10/19 ~ 下午2:00
+ *  @author  Leon
+ *
+ *  @note    Pending output of a connection: memory and file segments, flushed with writev(2) and sendfile(2)
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <memory_resource>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <webserver/http.h>
+#include <webserver/file_cache.h>
+#include <webserver/buffer_pool.h>
+#include <webserver/header_builder.h>
+
+namespace ws {
+
+/*!
+ * Responses are appended as they are produced; `flush` sends as much as the socket takes, gathering every run of
+ * memory segments into one writev, and resumes from the exact byte where a partial write stopped. When file
+ * segments are involved the socket is corked, so headers and file data leave in full frames.
+ * Copied bytes live in pooled buffers that go back to the reactor's cache as soon as they are sent.
+ */
+class output_chain {
+ private:
+  struct segment {
+    pooled_buffer buf{};  // memory segment: copied bytes ...
+    std::string owned{};  // ... or a body moved in ...
+    std::shared_ptr<const char> shared{};  // ... or immutable bytes shared with other connections
+    std::size_t size{0};
+    std::size_t sent{0};
+    std::shared_ptr<const open_file> file{};  // file segment: [offset, end) of the file
+    off_t offset{0};
+    off_t end{0};
+
+    [[nodiscard]] const char* data() const { return buf ? buf.data : shared ? shared.get() : owned.data(); }
+  };
+
+  buffer_cache* cache;
+  std::pmr::vector<segment> segments;
+  std::size_t head{0};  // first segment not fully sent
+  bool corked{false};
+
+ public:
+  enum class flush_result { done, blocked, error };
+
+  struct file_range {
+    int fd;
+    off_t offset;
+    off_t length;
+  };
+
+  /*!
+   * @param resource where the segment list lives (the connection's arena)
+   */
+  output_chain(buffer_cache& c, std::pmr::memory_resource* resource) : cache(&c), segments(resource) {}
+  ~output_chain() { clear(); }
+
+  output_chain(const output_chain&) = delete;
+  output_chain& operator=(const output_chain&) = delete;
+
+  /*!
+   * Copy `data` to the tail; small writes share pooled buffers
+   */
+  void write(std::string_view data);
+
+  /*!
+   * Queue `data` as its own segment (no copy), for large bodies
+   */
+  void append(std::string&& data);
+
+  /*!
+   * Queue `size` immutable bytes at `data` as their own segment (no copy); the pointer keeps them alive until sent
+   */
+  void append(std::shared_ptr<const char> data, std::size_t size);
+
+  void append_file(std::shared_ptr<const open_file> file, off_t offset, off_t length);
+
+  /*!
+   * Write to the non-blocking socket `fd` until the chain is empty (done) or the socket is full (blocked)
+   */
+  flush_result flush(int fd);
+
+  /// ---- for asynchronous senders, which issue the writes themselves ----
+
+  /*!
+   * Describe the run of memory segments at the front
+   * @return the number of iovecs filled (0 if a file segment is at the front)
+   */
+  std::size_t gather(iovec* iov, std::size_t max) const;
+
+  /*!
+   * `n` bytes of the memory run at the front were sent
+   */
+  void consume(std::size_t n);
+
+  /*!
+   * @return false if no file segment directly follows the memory run at the front
+   */
+  bool peek_file(file_range& range) const;
+
+  /*!
+   * `n` bytes of the file segment found by peek_file() were sent
+   */
+  void advance_file(std::size_t n);
+
+  /*!
+   * Drop everything queued and the segment list's storage (before the arena under it is reset)
+   */
+  void clear();
+
+  [[nodiscard]] bool empty() const { return head == segments.size(); }
+
+  /*!
+   * @return bytes not sent yet
+   */
+  [[nodiscard]] std::size_t get_pending() const;
+
+ private:
+  void set_cork(int fd, bool on);
+  void pop_front();
+  void pop_finished();
+};
+
+/*!
+ * Queue `resp` on `out`: the head rendered by `headers` (with its Date line), small bodies copied next to it, large ones
+ * moved, a file body, a large shared body or prepared response by reference
+ */
+void append_response(output_chain& out, response& resp, bool head_only, header_builder& headers);
+
+}  // namespace ws
@@ -0,0 +1,121 @@
+/** @file    rate_limiter.h
+ *  @time    2026/10/22 ~ 下午3:00
+ *  @author  Leon
+ *
+ *  @note    Per-client and per-route token buckets in a sharded open-addressing table, answered with 429 by the loops
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <threadpool/atomic_spin_lock.h>
+#include <webserver/http.h>
+#include <webserver/socket.h>
+
+namespace ws {
+
+struct rate_limit {
+  double rate{0};   // requests per second, refilled continuously; 0: unlimited
+  double burst{1};  // the bucket's size: requests allowed at once after a quiet period
+};
+
+struct route_limit {
+  std::string prefix;  // of the request path
+  rate_limit limit{};
+};
+
+struct rate_limit_config {
+  rate_limit per_client{};  // over all of a client's requests
+  std::vector<route_limit> routes{};  // in addition, per client under the first matching prefix
+  std::size_t num_shards{16};
+  std::size_t max_buckets{1 << 16};  // over all shards; a client arriving at a full shard is not limited
+};
+
+/*!
+ * A client is its IP address: each one has a bucket for all its requests and one per limited route it uses. Buckets
+ * hold no timer: they are refilled when next taken from, by the time since they last were, read from the coarse
+ * monotonic clock (a jiffy's resolution, no syscall). A request takes one token from each of its buckets, or from
+ * none if either is empty.
+ * The table is open-addressed with linear probing, in power-of-two shards under a spin lock each; a client's buckets
+ * share its shard, so one lookup takes the lock once. A bucket refilled to its burst is the same as none, and
+ * sweep() drops those, one shard per call, with backward-shift deletion (no tombstones to degrade the probes).
+ * Usage:
+ *   ws::rate_limiter limiter{{{100, 200}, {{"/login", {1, 5}}}}};
+ *   if (auto wait = limiter.admit(ip, path); wait != 0) { answer 429 with Retry-After: wait }
+ */
+class rate_limiter {
+ private:
+  struct bucket {
+    net::ip_address ip;
+    std::uint32_t limit;  // 0: per client, i + 1: routes[i]; EMPTY: a free slot
+    float tokens;
+    std::uint64_t stamp;  // ms of the last refill
+  };
+
+  struct alignas(64) shard {
+    tp::atomic_spinlock lock{};
+    std::vector<bucket> slots{};
+    std::size_t size{0};
+  };
+
+  static constexpr std::uint32_t EMPTY = ~std::uint32_t{0};
+
+  rate_limit_config config;
+  std::size_t mask;  // slots per shard - 1
+  std::size_t max_per_shard;
+  std::vector<std::unique_ptr<shard>> shards;
+  std::atomic<std::size_t> next_sweep{0};
+  std::atomic<std::size_t> num_limited{0};
+
+ public:
+  explicit rate_limiter(rate_limit_config cfg);
+
+  rate_limiter(const rate_limiter&) = delete;
+  rate_limiter& operator=(const rate_limiter&) = delete;
+
+  /*!
+   * Take a token for a request of `ip` to `path`
+   * @return 0 if admitted, else the seconds until it would be (for Retry-After)
+   */
+  std::uint32_t admit(const net::ip_address& ip, std::string_view path);
+
+  /*!
+   * Drop the buckets of one shard that have refilled, the next shard on the next call
+   * @return buckets dropped
+   */
+  std::size_t sweep();
+
+  /*!
+   * @return requests refused so far
+   */
+  [[nodiscard]] std::size_t get_num_limited() const { return num_limited.load(std::memory_order_relaxed); }
+
+  [[nodiscard]] std::size_t get_num_buckets() const;
+
+  /*!
+   * @return milliseconds of the coarse monotonic clock the buckets are refilled by
+   */
+  static std::uint64_t now_ms();
+
+ private:
+  // the bucket of (`ip`, `limit`), refilled to `now`; a new one is full; null if the shard is full
+  bucket* find(shard& s, const net::ip_address& ip, std::uint32_t limit, std::uint64_t now);
+  void refill(bucket& b, std::uint64_t now) const;
+  [[nodiscard]] const rate_limit& limit_of(std::uint32_t limit) const;
+  void erase(shard& s, std::size_t pos) const;
+  [[nodiscard]] std::size_t home(const net::ip_address& ip, std::uint32_t limit) const;
+};
+
+/*!
+ * @return the 429 a loop answers a refused request with, closing the connection: the body was not read
+ */
+response too_many_requests(std::uint32_t retry_after);
+
+}  // namespace ws
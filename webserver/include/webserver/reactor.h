@@ -0,0 +1,131 @@
+/** @file    reactor.h
+ *  @time    2026/10/18 ~ 下午10:50
+ *  @author  Leon
+ *
+ *  @note    One event loop on one thread, with its own listener (or an acceptor's handoffs) and its connections
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <event2/event.h>
+#include <webserver/http.h>
+#include <webserver/io_loop.h>
+#include <webserver/inbox.h>
+#include <webserver/buffer_pool.h>
+#include <webserver/timing_wheel.h>
+#include <webserver/connection.h>
+#include <webserver/compression.h>
+#include <webserver/handler_pool.h>
+#include <webserver/rate_limiter.h>
+#include <webserver/header_builder.h>
+
+namespace ws {
+
+struct connection_timeouts {
+  std::chrono::milliseconds idle{60000};         // keep-alive with no request in progress
+  std::chrono::milliseconds read_header{10000};  // from a request's first byte until all of it arrived; 408 beyond
+  std::chrono::milliseconds write{30000};        // blocked on a full socket without progress
+};
+
+/*!
+ * A reactor accepts on its own SO_REUSEPORT listener - or is handed sockets through its inbox by an acceptor - and
+ * serves its connections until they close, so the I/O path never shares state with another thread. Only `start`,
+ * `stop`, `join`, `post`, `adopt` and the counters are called from outside.
+ */
+class reactor : public io_loop {
+ private:
+  std::size_t index;
+  const handler& on_request;
+  event_base* base{nullptr};
+  int listen_fd;  // -1: sockets come through adopt()
+  event* accept_ev{nullptr};
+  int wake_fd{-1};  // eventfd: asks the loop to stop
+  event* wake_ev{nullptr};
+  ws::inbox mailbox{};  // posted work and adopted sockets from other threads, taken by on_inbox
+  event* inbox_ev{nullptr};
+  compressor* compression;  // null: responses go out unencoded
+  handler_pool* workers;  // null: deferred handlers run on the loop
+  rate_limiter* limiter;  // null: requests are not limited
+  connection_timeouts timeouts;
+  timing_wheel wheel;  // every connection's timeout, advanced by one periodic event
+  event* tick_ev{nullptr};
+  buffer_cache cache;  // outlives the connections, which give their buffers back on destruction
+  header_builder headers{};  // response heads are rendered here, then copied into pooled buffers
+  std::unordered_map<int, std::unique_ptr<connection>> connections{};
+  std::uint64_t next_connection_id{0};  // tells a connection from a later one on the same fd
+  std::thread thread{};
+
+  std::atomic<std::size_t> num_requests{0};
+  std::atomic<std::size_t> num_connections{0};
+
+ public:
+  /*!
+   * @param listen_fd a non-blocking listening socket, closed by the reactor; -1 for none
+   * @param pool the global buffer pool behind this reactor's cache
+   * @param c encodes response bodies; may be null
+   * @param w finishes deferred responses; may be null
+   * @param l refuses requests over their rate with 429, and is swept on every tick; may be null
+   */
+  reactor(std::size_t idx, int listen_fd, const handler& h, buffer_pool& pool, const connection_timeouts& t = {},
+          compressor* c = nullptr, handler_pool* w = nullptr, rate_limiter* l = nullptr);
+  ~reactor() override;
+
+  reactor(const reactor&) = delete;
+  reactor& operator=(const reactor&) = delete;
+
+  void start() override;
+  void stop() override;
+  void join() override;
+  void post(std::function<void()> fn) override;
+  void adopt(int fd) override;
+
+  [[nodiscard]] std::size_t get_index() const { return index; }
+  [[nodiscard]] std::size_t get_num_requests() const override { return num_requests.load(std::memory_order_relaxed); }
+  [[nodiscard]] std::size_t get_num_connections() const override {
+    return num_connections.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::size_t get_buffer_bytes_in_use() const override { return cache.get_bytes_in_use(); }
+
+  /// ---- reactor thread only ----
+
+  [[nodiscard]] event_base* get_base() const { return base; }
+  [[nodiscard]] const handler& get_handler() const { return on_request; }
+  [[nodiscard]] buffer_cache& get_buffer_cache() { return cache; }
+  [[nodiscard]] timing_wheel& get_wheel() { return wheel; }
+  [[nodiscard]] const connection_timeouts& get_timeouts() const { return timeouts; }
+  [[nodiscard]] rate_limiter* get_limiter() const { return limiter; }
+
+  [[nodiscard]] header_builder& get_headers() { return headers; }
+
+  // a single writer: no locked instruction needed
+  void count_request() { num_requests.store(num_requests.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+  /*!
+   * Hand what is left of `resp`, which `c` is about to send, to a worker: its deferred part to the handler pool, or
+   * its body to the compressor
+   * @return false if a worker took the response over; it comes back through connection::resume()
+   */
+  bool offload(connection& c, const request& req, response& resp);
+
+  /*!
+   * Destroy the connection on `fd` (closes the socket)
+   */
+  void close_connection(int fd);
+
+ private:
+  void add_connection(int fd);
+  static void on_accept(evutil_socket_t fd, short what, void* arg);
+  static void on_wake(evutil_socket_t fd, short what, void* arg);
+  static void on_tick(evutil_socket_t fd, short what, void* arg);
+  static void on_inbox(evutil_socket_t fd, short what, void* arg);
+};
+
+}  // namespace ws
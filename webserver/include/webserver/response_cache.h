@@ -0,0 +1,129 @@
+/** @file    response_cache.h
+ *  @time    2026/10/19 ~ 下午10:30
+ *  @author  Leon
+ *
+ *  @note    Sharded cache of serialized responses with strong ETags, CLOCK eviction under a byte budget, and a handler
+ *           wrapper answering hits (and If-None-Match with 304) without calling the handler
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <threadpool/rw_spin_lock.h>
+#include <webserver/http.h>
+
+namespace ws {
+
+/*!
+ * One cached entity: the 200 with its body and the matching 304, both rendered at insert
+ */
+struct cached_response {
+  std::string etag{};  // quoted, as sent
+  prepared_response full{};
+  prepared_response not_modified{};
+};
+
+struct response_cache_config {
+  std::size_t max_bytes{64 * 1024 * 1024};  // over all shards
+  std::size_t max_entry{1024 * 1024};       // larger responses are passed through
+  std::size_t num_shards{16};
+  std::chrono::milliseconds max_age{1000};  // an entry older than this is a miss, so the handler is asked again
+};
+
+/*!
+ * A hit takes its shard's lock shared and sets the entry's reference bit, nothing more: eviction is CLOCK (an entry
+ * referenced since the hand last passed gets a second chance), so hits never reorder a list under an exclusive lock.
+ * Inserts render and hash outside the lock and only link the entry in.
+ */
+class response_cache {
+ private:
+  struct entry {
+    std::string key;
+    std::shared_ptr<const cached_response> value;
+    std::chrono::steady_clock::time_point expires_at;
+    std::size_t charge;  // bytes accounted against the budget
+    std::atomic<bool> referenced{false};
+  };
+
+  struct shard {
+    tp::brw_spinlock<16> lock{};
+    std::vector<std::unique_ptr<entry>> ring{};  // the clock; the hand sweeps it
+    std::unordered_map<std::string_view, std::size_t> index{};  // keys view entry::key, values are ring positions
+    std::size_t hand{0};
+    std::size_t bytes{0};
+  };
+
+  response_cache_config config;
+  std::size_t max_per_shard;
+  std::vector<std::unique_ptr<shard>> shards;
+
+ public:
+  explicit response_cache(response_cache_config cfg = {});
+
+  response_cache(const response_cache&) = delete;
+  response_cache& operator=(const response_cache&) = delete;
+
+  /*!
+   * @return the live entry for `key` (the request target), or nullptr
+   */
+  std::shared_ptr<const cached_response> lookup(std::string_view key);
+
+  /*!
+   * Render `resp` and store it under `key`, if it is cacheable: a 200 without Set-Cookie or Cache-Control
+   * no-store/private, and a body (in memory or a file, read here once) of at most `max_entry` bytes
+   * @return the rendered entry (not stored if it alone exceeds a shard's budget), or nullptr if `resp` was not cacheable
+   */
+  std::shared_ptr<const cached_response> insert(std::string_view key, const response& resp);
+
+  void erase(std::string_view key);
+
+  void clear();
+
+  [[nodiscard]] std::size_t get_num_entries() const;
+
+  /*!
+   * @return bytes accounted against `max_bytes`
+   */
+  [[nodiscard]] std::size_t get_bytes() const;
+
+ private:
+  shard& shard_of(std::string_view key);
+  static void remove_at(shard& s, std::size_t pos);
+};
+
+/*!
+ * Serve GET/HEAD from a response_cache, calling `inner` only on a miss:
+ *   ws::response_cache cache{};
+ *   ws::server srv{config, ws::caching_handler{cache, ws::static_files{files}}};
+ * Requests with an Authorization or a Range header are passed through. A response `inner` defers to the handler pool
+ * (ws::offload, run_on::pool) is cached once the worker has made it.
+ */
+class caching_handler {
+ private:
+  response_cache* cache;
+  handler inner;
+
+ public:
+  caching_handler(response_cache& c, handler h) : cache(&c), inner(std::move(h)) {}
+
+  void operator()(const request& req, response& resp) const;
+
+ private:
+  static void insert_and_answer(response_cache& c, const request& req, response& resp);
+  static void answer(const request& req, response& resp, const std::shared_ptr<const cached_response>& hit);
+};
+
+/*!
+ * @param list the value of If-None-Match: "*" or entity tags separated by commas
+ * @return whether `etag` is in `list`, by weak comparison (a W/ prefix is ignored)
+ */
+bool etag_matches(std::string_view list, std::string_view etag);
+
+}  // namespace ws
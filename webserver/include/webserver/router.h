@@ -0,0 +1,129 @@
+/** @file    router.h
+ *  @time    2026/10/20 ~ 下午3:00
+ *  @author  Leon
+ *
+ *  @note    Request routing on method + path: a compressed radix tree built at startup, with `:param` and `*wildcard`
+ *           segments captured as views into the request
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <webserver/http.h>
+
+namespace ws {
+
+/*!
+ * The segments a route captured, in pattern order. Values view the request's path (valid while the handler runs),
+ * names view the route; nothing is allocated.
+ */
+class route_params {
+ public:
+  static constexpr std::size_t MAX_PARAMS{16};  // per pattern
+
+ private:
+  std::array<std::string_view, MAX_PARAMS> values{};
+  std::size_t count{0};
+  const std::vector<std::string>* names{nullptr};
+
+  friend class router;
+
+ public:
+  /*!
+   * @return the value captured for `:name` or `*name`, or an empty view
+   */
+  [[nodiscard]] std::string_view get(std::string_view name) const;
+
+  [[nodiscard]] std::string_view operator[](std::size_t i) const { return values[i]; }
+  [[nodiscard]] std::string_view name_of(std::size_t i) const { return (*names)[i]; }
+  [[nodiscard]] std::size_t size() const { return count; }
+};
+
+using route_handler = std::function<void(const request&, const route_params&, response&)>;
+
+/*!
+ * Where a route's handler runs: on the reactor that parsed the request, or - for CPU-heavy endpoints, so they do not
+ * stall the reactor's other connections - on the server's handler pool (see handler_pool)
+ */
+enum class run_on : std::uint8_t { reactor, pool };
+
+/*!
+ * Patterns are matched against the path (without the query), segment by segment:
+ *   /users/new         static
+ *   /users/:id         one non-empty segment, up to the next '/'
+ *   *path              the rest of the path, possibly empty (as in "/static/" then "*path"); only last
+ * Static text wins over a parameter, a parameter over a wildcard, with backtracking: "/users/newton" still reaches
+ * "/users/:id", and so does "DELETE /users/new" if only GET has "/users/new". Shared prefixes are stored once, so a lookup costs one pass over the path whatever the number of routes.
+ * Usage:
+ *   ws::router routes{};
+ *   routes.add("GET", "/users/:id", [](const ws::request&, const ws::route_params& p, ws::response& resp) {
+ *     resp.body = fmt::format("user {}", p.get("id"));
+ *   });
+ *   routes.add("GET", "/thumbnails/:id", make_thumbnail, ws::run_on::pool);  // CPU-heavy
+ *   ws::server srv{config, routes};
+ * Build it before the server starts: lookups are const and lock-free, adds are not synchronized with them.
+ */
+class router {
+ private:
+  struct route {
+    std::string method;
+    std::string pattern;
+    std::vector<std::string> names;  // of the captures, in order
+    route_handler handler;
+    run_on where;
+  };
+
+  static constexpr std::uint32_t NONE{~std::uint32_t{0}};
+
+  struct node {
+    std::string prefix{};                // static text matched on entering the node
+    std::string indices{};               // first byte of each static child's prefix, for a memchr
+    std::vector<std::uint32_t> children{};
+    std::uint32_t param{NONE};           // the ":name" child
+    std::uint32_t wildcard{NONE};        // the "*name" child, a leaf
+    std::vector<std::pair<std::string, std::uint32_t>> endpoints{};  // method -> route, for paths ending here
+  };
+
+  std::vector<node> nodes{};  // [0] is the root, with an empty prefix
+  std::vector<route> routes{};
+
+ public:
+  router() { nodes.emplace_back(); }
+
+  /*!
+   * @param pattern starts with '/'; see the class comment
+   * @param where run_on::pool for a CPU-heavy handler: it then runs on a worker, after the route is matched again on
+   *              a copy of the request
+   * @throw std::invalid_argument on a malformed pattern, or if `method` `pattern` is already routed
+   */
+  void add(std::string_view method, std::string_view pattern, route_handler h, run_on where = run_on::reactor);
+
+  /*!
+   * Find the route for `method` (HEAD falls back to GET) and `path`, filling `params`
+   * @return its handler, or nullptr
+   */
+  const route_handler* match(std::string_view method, std::string_view path, route_params& params) const;
+
+  /*!
+   * Dispatch `req` to its route, or answer 404 (no pattern matches the path) / 405 with Allow (other methods do)
+   */
+  void operator()(const request& req, response& resp) const;
+
+  [[nodiscard]] std::size_t get_num_routes() const { return routes.size(); }
+
+ private:
+  std::uint32_t insert_static(std::uint32_t n, std::string_view text);
+  // the node below `n` routing `path` for `method`, or NONE
+  std::uint32_t find(std::uint32_t n, std::string_view method, std::string_view path, route_params& params) const;
+  const route* route_of(const node& nd, std::string_view method) const;
+  const route* match_route(std::string_view method, std::string_view path, route_params& params) const;
+};
+
+}  // namespace ws
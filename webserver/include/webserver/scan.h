@@ -0,0 +1,35 @@
+/** @file    scan.h
+ *  @time    2026/10/19 ~ 上午9:10
+ *  @author  Leon
+ *
+ *  @note    Delimiter scanning for the HTTP parser: AVX2 / SSE4.2 / scalar, picked at runtime by CPU support
+ *
+ */
+
+#pragma once
+
+namespace ws::scan {
+
+enum class isa { scalar, sse42, avx2 };
+
+/*!
+ * @return the widest instruction set this CPU supports
+ */
+isa best_isa();
+
+/*!
+ * Force an implementation (tests and benchmarks); falls back to the best supported one if `level` is not
+ */
+void use_isa(isa level);
+
+isa current_isa();
+
+const char* isa_name(isa level);
+
+/*!
+ * First byte in [p, end) equal to `a` or `b`
+ * @return `end` if there is none
+ */
+const char* find_either(const char* p, const char* end, char a, char b);
+
+}  // namespace ws::scan
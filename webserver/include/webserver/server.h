@@ -0,0 +1,98 @@
+/** @file    server.h
+ *  @time    2026/10/18 ~ 下午11:00
+ *  @author  Leon
+ *
+ *  @note    The multi-reactor HTTP/1.1 server: one reactor per core, each with its own SO_REUSEPORT listener or fed by
+ *           one acceptor thread
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <webserver/http.h>
+#include <webserver/io_loop.h>
+#include <webserver/buffer_pool.h>
+#include <webserver/reactor.h>
+#include <webserver/acceptor.h>
+#include <webserver/compression.h>
+#include <webserver/handler_pool.h>
+#include <webserver/rate_limiter.h>
+
+namespace ws {
+
+struct server_config {
+  std::string host{"0.0.0.0"};
+  std::uint16_t port{8080};  // 0 picks a free port, see server::get_port()
+  std::size_t num_reactors{std::thread::hardware_concurrency()};
+  int backlog{4096};
+  connection_timeouts timeouts{};
+  compression_config compression{};
+  std::size_t handler_threads{std::thread::hardware_concurrency()};  // for deferred responses, see handler_pool; 0: none
+  rate_limit_config rate_limits{};  // off unless a client or route rate is set, see ws::rate_limiter
+  ws::backend backend{backend::libevent};  // io_uring needs a kernel with it enabled, see server::start()
+  bool single_acceptor{false};  // one listener and an acceptor thread handing sockets out round-robin, see ws::acceptor
+};
+
+/*!
+ * Usage:
+ *   ws::server srv{{"0.0.0.0", 8080}, [](const ws::request& req, ws::response& resp) { resp.body = "hello"; }};
+ *   srv.start();
+ *   ...
+ *   srv.stop();
+ */
+class server {
+ private:
+  server_config config;
+  handler on_request;
+  buffer_pool pool{};  // declared before the reactors, whose caches return buffers to it
+  std::unique_ptr<compressor> encoder{};  // if enabled; its workers post results into the reactors
+  std::unique_ptr<handler_pool> workers{};  // the same, for deferred handlers; without, they run on the reactors
+  std::unique_ptr<rate_limiter> limiter{};  // shared by the reactors, if any rate is set
+  std::vector<std::unique_ptr<io_loop>> reactors{};
+  std::unique_ptr<acceptor> accept_loop{};  // single_acceptor only; stopped before the reactors
+  std::uint16_t port{0};
+
+ public:
+  server(server_config cfg, handler h);
+  ~server();
+
+  server(const server&) = delete;
+  server& operator=(const server&) = delete;
+
+  /*!
+   * Bind the listeners and start the reactor threads; throws std::system_error if a listener cannot be bound, or if
+   * the io_uring backend was asked for and the kernel (or the build) has none
+   */
+  void start();
+
+  /*!
+   * Stop the reactors and close every connection
+   */
+  void stop();
+
+  [[nodiscard]] std::uint16_t get_port() const { return port; }
+  [[nodiscard]] std::size_t get_num_reactors() const { return reactors.size(); }
+  [[nodiscard]] std::size_t get_num_requests() const;
+  [[nodiscard]] std::size_t get_num_connections() const;
+
+  /*!
+   * @return requests refused with 429 so far
+   */
+  [[nodiscard]] std::size_t get_num_limited() const { return limiter != nullptr ? limiter->get_num_limited() : 0; }
+
+  /*!
+   * @return bytes of I/O buffers and arena blocks currently held by connections
+   */
+  [[nodiscard]] std::size_t get_buffer_bytes_in_use() const;
+
+ private:
+  // takes `listen_fd` (-1: sockets come from the acceptor)
+  std::unique_ptr<io_loop> make_reactor(std::size_t index, int listen_fd);
+};
+
+}  // namespace ws
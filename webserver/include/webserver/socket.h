@@ -0,0 +1,40 @@
+/** @file    socket.h
+ *  @time    2026/10/18 ~ 下午10:30
+ *  @author  Leon
+ *
+ *  @note    Thin wrappers over the BSD socket calls the reactors need; errors are thrown as std::system_error
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace ws::net {
+
+/*!
+ * A non-blocking listening TCP socket
+ * @param reuse_port set SO_REUSEPORT, so every reactor can bind its own listener and the kernel balances accepts
+ */
+int listen_tcp(const std::string& host, std::uint16_t port, int backlog, bool reuse_port);
+
+/*!
+ * @return the port a socket is bound to (useful after binding port 0)
+ */
+std::uint16_t local_port(int fd);
+
+void set_nodelay(int fd, bool on);
+
+/*!
+ * A peer's address as a map key: IPv6, with IPv4 mapped into it (::ffff:a.b.c.d)
+ */
+using ip_address = std::array<std::uint8_t, 16>;
+
+/*!
+ * @return the address of the other end of a connected socket; all zeros if it has none (or is not IP)
+ */
+ip_address peer_address(int fd);
+
+}  // namespace ws::net
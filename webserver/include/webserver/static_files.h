@@ -0,0 +1,43 @@
+/** @file    static_files.h
+ *  @time    2026/10/19 ~ 上午11:40
+ *  @author  Leon
+ *
+ *  @note    A handler serving GET/HEAD from a file_cache, with byte ranges; the body goes out with sendfile(2)
+ *
+ */
+
+#pragma once
+
+#include <webserver/http.h>
+#include <webserver/file_cache.h>
+
+namespace ws {
+
+/*!
+ * A GET with a Range header (and an If-Range naming the file as it is, if any) is answered with 206 and only the
+ * ranges asked for, several as multipart/byteranges, or 416 if none is satisfiable. The file is never read into
+ * memory: every part is a sendfile(2) from its offset, so a download costs its connection the same few buffers
+ * whatever the file's size.
+ * Usage:
+ *   ws::file_cache files{{"/var/www"}};
+ *   ws::server srv{config, ws::static_files{files}};
+ */
+class static_files {
+ private:
+  file_cache* cache;
+
+ public:
+  explicit static_files(file_cache& c) : cache(&c) {}
+
+  /*!
+   * @return false (leaving `resp` alone) if this is not a GET/HEAD of an existing file
+   */
+  bool serve(const request& req, response& resp) const;
+
+  /*!
+   * serve(), or answer 404 / 405
+   */
+  void operator()(const request& req, response& resp) const;
+};
+
+}  // namespace ws
@@ -0,0 +1,86 @@
+/** @file    timing_wheel.h
+ *  @time    2026/10/19 ~ 下午5:10
+ *  @author  Leon
+ *
+ *  @note    Hashed timing wheel with coarse ticks, for per-connection timeouts of one reactor
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+namespace ws {
+
+/*!
+ * Intrusive timer, embedded in its owner; the owner must cancel it (or let it fire) before it is destroyed.
+ */
+struct wheel_timer {
+  wheel_timer* prev{nullptr};
+  wheel_timer* next{nullptr};
+  std::uint64_t deadline{0};  // in ticks
+  void (*fn)(void* arg){nullptr};
+  void* arg{nullptr};
+
+  wheel_timer() = default;
+  wheel_timer(void (*f)(void*), void* a) : fn(f), arg(a) {}
+  wheel_timer(const wheel_timer&) = delete;
+  wheel_timer& operator=(const wheel_timer&) = delete;
+
+  [[nodiscard]] bool is_armed() const { return next != nullptr; }
+};
+
+/*!
+ * Timers hash into `num_slots` lists by deadline tick; each tick expires one slot. Scheduling is O(1) and moving a
+ * deadline later - what activity on a connection does - only stores the new deadline: the timer stays where it is
+ * and is moved to its new slot when its old one comes round. Deadlines further than one revolution away wait in
+ * their slot for the revolutions in between the same way.
+ * Not thread-safe: a wheel belongs to one reactor.
+ * Usage:
+ *   ws::timing_wheel wheel{std::chrono::milliseconds(100)};
+ *   ws::wheel_timer t{&on_timeout, this};
+ *   wheel.schedule(t, std::chrono::seconds(30));  // again on every activity
+ *   wheel.advance(now);                           // from a periodic tick event
+ */
+class timing_wheel {
+ private:
+  using clock = std::chrono::steady_clock;
+
+  std::chrono::milliseconds tick;
+  std::vector<wheel_timer> slots;  // list heads (sentinels)
+  clock::time_point origin;
+  std::uint64_t current{0};  // last tick expired
+  std::size_t num_armed{0};
+
+ public:
+  explicit timing_wheel(std::chrono::milliseconds tick_length = std::chrono::milliseconds(100), std::size_t num_slots = 512,
+                        clock::time_point start = clock::now());
+  ~timing_wheel();
+
+  timing_wheel(const timing_wheel&) = delete;
+  timing_wheel& operator=(const timing_wheel&) = delete;
+
+  /*!
+   * Fire `t` after `timeout` (rounded up to whole ticks), replacing its previous deadline if armed
+   */
+  void schedule(wheel_timer& t, std::chrono::milliseconds timeout);
+
+  void cancel(wheel_timer& t);
+
+  /*!
+   * Expire every timer due at `now`. Callbacks may schedule or cancel any timer, including the one firing.
+   * @return the number of timers fired
+   */
+  std::size_t advance(clock::time_point now = clock::now());
+
+  [[nodiscard]] std::chrono::milliseconds get_tick() const { return tick; }
+  [[nodiscard]] std::size_t get_num_armed() const { return num_armed; }
+
+ private:
+  void link(wheel_timer& head, wheel_timer& t);
+  static void unlink(wheel_timer& t);
+};
+
+}  // namespace ws
@@ -0,0 +1,157 @@
+/** @file    uring.h
+ *  @time    2026/10/19 ~ 下午7:10
+ *  @author  Leon
+ *
+ *  @note    Minimal io_uring wrapper over the raw syscalls: rings, batched submission, registered files and provided
+ *           buffer rings
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+
+namespace ws {
+
+/*!
+ * One submission/completion queue pair, used by a single thread. SQEs are only queued by `get_sqe`; `submit_and_wait`
+ * hands all of them to the kernel and waits for completions in one io_uring_enter(2).
+ * The ring may be created and registered on one thread and then `enable`d by the thread that submits: the kernel
+ * binds a single-issuer ring to that thread.
+ * Usage:
+ *   ws::uring ring{1024};
+ *   ring.enable();  // on the submitting thread
+ *   auto* sqe = ring.get_sqe();  // zeroed
+ *   sqe->opcode = IORING_OP_NOP;
+ *   ring.submit_and_wait(1);
+ *   ring.for_each_cqe([](const io_uring_cqe& cqe) { ... });
+ */
+class uring {
+ private:
+  int ring_fd{-1};
+  // submission queue
+  unsigned* sq_head{nullptr};
+  unsigned* sq_tail{nullptr};
+  unsigned* sq_array{nullptr};
+  unsigned sq_mask{0};
+  unsigned sq_entries{0};
+  io_uring_sqe* sqes{nullptr};
+  unsigned sq_local_tail{0};  // SQEs queued but not yet published to the kernel
+  // completion queue
+  unsigned* cq_head{nullptr};
+  unsigned* cq_tail{nullptr};
+  unsigned cq_mask{0};
+  io_uring_cqe* cqes{nullptr};
+  // mappings
+  void* sq_map{nullptr};
+  std::size_t sq_map_size{0};
+  void* cq_map{nullptr};
+  std::size_t cq_map_size{0};
+  std::size_t sqes_size{0};
+  std::size_t num_enters{0};
+  bool disabled{false};  // created with IORING_SETUP_R_DISABLED, see enable()
+
+ public:
+  /*!
+   * Throws std::system_error if the kernel has no io_uring (or it is disabled)
+   * @param cq_entries completion queue size; 0 for 4 * `entries`
+   */
+  explicit uring(unsigned entries, unsigned cq_entries = 0);
+  ~uring();
+
+  uring(const uring&) = delete;
+  uring& operator=(const uring&) = delete;
+
+  /*!
+   * A zeroed SQE to fill; when the queue is full, what is queued is submitted first
+   */
+  io_uring_sqe* get_sqe();
+
+  /*!
+   * Submit every queued SQE and wait until at least `wait_nr` completions are ready
+   * @return the number of SQEs the kernel consumed
+   */
+  unsigned submit_and_wait(unsigned wait_nr);
+
+  /*!
+   * Call `fn(const io_uring_cqe&)` for every ready completion and release them
+   * @return the number of completions seen
+   */
+  template <typename F>
+  unsigned for_each_cqe(F&& fn) {
+    unsigned seen{0};
+    auto head = *cq_head;
+    while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+      fn(cqes[head & cq_mask]);
+      ++head;
+      ++seen;
+      __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);  // the callback may queue SQEs that complete into this slot
+    }
+    return seen;
+  }
+
+  /*!
+   * Register a table of `n` empty file slots, for direct accept and IOSQE_FIXED_FILE
+   */
+  void register_files_sparse(unsigned n);
+
+  /*!
+   * Register `entries` buffer descriptors at `ring` as provided buffer group `group`
+   */
+  void register_buf_ring(io_uring_buf_ring* ring, unsigned entries, std::uint16_t group);
+
+  void unregister_buf_ring(std::uint16_t group);
+
+  /*!
+   * Make the calling thread the ring's submitter; call before the first submission
+   */
+  void enable();
+
+  [[nodiscard]] int get_fd() const { return ring_fd; }
+  [[nodiscard]] std::size_t get_num_enters() const { return num_enters; }
+
+ private:
+  unsigned flush_sq();
+};
+
+/*!
+ * A provided buffer ring: `count` equal buffers the kernel picks from for IOSQE_BUFFER_SELECT receives, so a
+ * connection waiting for data holds no buffer. Buffers given back are published together by `publish`.
+ */
+class provided_buffers {
+ private:
+  uring& owner;
+  io_uring_buf_ring* ring{nullptr};
+  std::size_t ring_size{0};
+  char* base{nullptr};
+  unsigned count;
+  std::size_t size;
+  std::uint16_t group;
+  std::uint16_t tail{0};
+  std::uint16_t published{0};
+
+ public:
+  /*!
+   * @param count a power of two, at most 32768
+   */
+  provided_buffers(uring& r, std::uint16_t group_id, unsigned count, std::size_t size);
+  ~provided_buffers();
+
+  provided_buffers(const provided_buffers&) = delete;
+  provided_buffers& operator=(const provided_buffers&) = delete;
+
+  [[nodiscard]] char* get(unsigned id) const { return base + id * size; }
+  [[nodiscard]] std::uint16_t get_group() const { return group; }
+  [[nodiscard]] std::size_t get_size() const { return size; }
+
+  /*!
+   * Hand buffer `id` back to the kernel (visible after the next `publish`)
+   */
+  void give_back(unsigned id);
+
+  void publish();
+};
+
+}  // namespace ws
@@ -0,0 +1,153 @@
+/** @file    uring_reactor.h
+ *  @time    2026/10/19 ~ 下午7:40
+ *  @author  Leon
+ *
+ *  @note    The io_uring backend: one completion loop on one thread, serving what it accepted on its own listener
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <linux/time_types.h>
+#include <webserver/http.h>
+#include <webserver/io_loop.h>
+#include <webserver/inbox.h>
+#include <webserver/uring.h>
+#include <webserver/buffer_pool.h>
+#include <webserver/timing_wheel.h>
+#include <webserver/reactor.h>
+#include <webserver/compression.h>
+#include <webserver/handler_pool.h>
+#include <webserver/rate_limiter.h>
+#include <webserver/header_builder.h>
+
+namespace ws {
+
+/*!
+ * Same contract as `reactor`, driven by completions instead of readiness:
+ *   - one multishot accept installs sockets straight into the ring's registered file table (no fd per connection in
+ *     the process table, IOSQE_FIXED_FILE everywhere after); sockets handed over by an acceptor go into the table
+ *     in batches, one IORING_OP_FILES_UPDATE per inbox batch, and their plain fds are closed;
+ *   - one multishot recv per connection picks buffers from a provided buffer ring, so waiting connections hold none;
+ *     whole requests are parsed in place, only a partial tail is copied out;
+ *   - responses leave as one sendmsg of the gathered memory segments, linked to a splice file -> pipe -> socket pair
+ *     when a file body follows (the sendfile of this backend);
+ *   - SQEs of every connection queue up during a pass over the completions and go to the kernel in one
+ *     io_uring_enter, which also waits for the next ones.
+ */
+class uring_reactor : public io_loop {
+ private:
+  struct conn;
+
+  struct pending {
+    int fd;
+    net::ip_address peer;
+  };
+
+  std::size_t index;
+  const handler& on_request;
+  int listen_fd;  // -1: sockets come through adopt()
+  int wake_fd{-1};
+  ws::inbox mailbox{};
+  compressor* compression;
+  handler_pool* workers;
+  rate_limiter* limiter;
+  connection_timeouts timeouts;
+  uring ring;
+  provided_buffers buffers;
+  timing_wheel wheel;
+  buffer_cache cache;
+  header_builder headers{};
+  std::unordered_map<unsigned, std::unique_ptr<conn>> connections;  // by registered file slot
+  std::uint64_t next_connection_id{0};
+  std::thread thread{};
+  // loop state, reactor thread only
+  bool running{true};
+  bool accepting{false};
+  bool tick_armed{false};
+  bool inbox_armed{false};
+  bool adopt_armed{false};
+  std::vector<pending> to_adopt{};  // adopted sockets waiting for the next files update
+  std::vector<pending> adopting{};  // ... and those of the update in flight
+  std::vector<int> adopt_slots{};  // its array: the fds in, the registered slots out
+  std::uint64_t wake_value{0};
+  std::uint64_t inbox_value{0};
+  __kernel_timespec tick{};
+
+  std::atomic<std::size_t> num_requests{0};
+  std::atomic<std::size_t> num_connections{0};
+  std::atomic<std::size_t> num_enters{0};
+
+ public:
+  /*!
+   * Throws std::system_error if io_uring is not available
+   * @param listen_fd a non-blocking listening socket, closed by the reactor; -1 for none
+   * @param c encodes response bodies; may be null
+   * @param w finishes deferred responses; may be null
+   * @param l refuses requests over their rate with 429; may be null. With one, accepted sockets get a plain fd
+   *          first, to learn the peer's address, and go into the file table like adopted ones
+   */
+  uring_reactor(std::size_t idx, int listen_fd, const handler& h, buffer_pool& pool, const connection_timeouts& t = {},
+                compressor* c = nullptr, handler_pool* w = nullptr, rate_limiter* l = nullptr);
+  ~uring_reactor() override;
+
+  uring_reactor(const uring_reactor&) = delete;
+  uring_reactor& operator=(const uring_reactor&) = delete;
+
+  void start() override;
+  void stop() override;
+  void join() override;
+  void post(std::function<void()> fn) override;
+  void adopt(int fd) override;
+
+  [[nodiscard]] std::size_t get_num_requests() const override { return num_requests.load(std::memory_order_relaxed); }
+  [[nodiscard]] std::size_t get_num_connections() const override {
+    return num_connections.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::size_t get_buffer_bytes_in_use() const override { return cache.get_bytes_in_use(); }
+
+  /*!
+   * @return io_uring_enter(2) calls so far: the syscalls of this loop, apart from pipe setup
+   */
+  [[nodiscard]] std::size_t get_num_enters() const { return num_enters.load(std::memory_order_relaxed); }
+
+ private:
+  void run();
+  void on_cqe(const io_uring_cqe& cqe);
+  void arm_accept();
+  void arm_tick();
+  void arm_wake();
+  void arm_inbox();
+  void run_inbox();
+  void arm_adopt();
+  void on_adopt(const io_uring_cqe& cqe);
+  void add_connection(unsigned slot, const net::ip_address& peer);
+  void cancel(std::uint64_t user_data);
+  void on_accept(const io_uring_cqe& cqe);
+
+  void arm_recv(conn& c);
+  void on_recv(conn& c, const io_uring_cqe& cqe);
+  void receive(conn& c, std::string_view data);
+  std::size_t answer(conn& c, std::string_view buf);
+  bool admit(conn& c, std::string_view buf);
+  void answer_buffered(conn& c);
+  void stash(conn& c, std::string_view data);
+  bool offload(conn& c, response& resp);
+  void resume(conn& c, response& resp);
+  void send_output(conn& c);
+  void on_sent(conn& c, std::uint64_t op, int res);
+  void after_send(conn& c);
+  void release_idle(conn& c);
+  void arm_timer(conn& c);
+  static void on_timeout(void* arg);
+  void kill(conn& c);
+  void reap(conn& c);
+};
+
+}  // namespace ws
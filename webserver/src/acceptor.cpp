@@ -0,0 +1,83 @@
+/** @file    acceptor.cpp
+ *  @time    2026/10/21 ~ 下午7:30
+ *  @author  Leon
+ *
+ *  @note    The accept loop: poll the listener and the stop eventfd, accept in bursts, hand over
+ *
+ */
+
+#include <webserver/acceptor.h>
+#include <webserver/socket.h>
+#include <system_error>
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ws {
+
+namespace {
+
+constexpr int MAX_ACCEPTS_PER_WAKEUP = 256;
+
+}  // namespace
+
+
+acceptor::acceptor(int lfd, std::vector<io_loop*> l) : listen_fd(lfd), loops(std::move(l)) {
+  wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd < 0) {
+    auto err = errno;
+    ::close(listen_fd);
+    throw std::system_error{err, std::generic_category(), "acceptor eventfd"};
+  }
+}
+
+acceptor::~acceptor() {
+  stop();
+  ::close(listen_fd);
+  ::close(wake_fd);
+}
+
+void acceptor::start() {
+  thread = std::thread{[this]() { run(); }};
+}
+
+void acceptor::stop() {
+  std::uint64_t one{1};
+  [[maybe_unused]] auto n = ::write(wake_fd, &one, sizeof(one));
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void acceptor::run() {
+  pollfd fds[2] = {{listen_fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+  for (;;) {
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (fds[1].revents != 0) {
+      return;
+    }
+    int i = 0;
+    for (; i < MAX_ACCEPTS_PER_WAKEUP; ++i) {
+      int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+        break;  // EAGAIN, or a transient error (EMFILE, ECONNABORTED ...)
+      }
+      net::set_nodelay(fd, true);
+      loops[next]->adopt(fd);
+      next = next + 1 == loops.size() ? 0 : next + 1;
+    }
+    num_accepted.fetch_add(static_cast<std::size_t>(i), std::memory_order_relaxed);
+    if (i == 0 && errno != EAGAIN && errno != EINTR && errno != ECONNABORTED) {
+      ::poll(nullptr, 0, 100);  // out of fds or memory: the listener stays readable, do not spin on it
+    }
+  }
+}
+
+}  // namespace ws
@@ -0,0 +1,29 @@
+/** @file    access_log.cpp
+ *  @time    2026/10/21 ~ 上午11:30
+ *  @author  Leon
+ *
+ *  @note    Access log lines
+ *
+ */
+
+#include <webserver/access_log.h>
+#include <webserver/file_cache.h>
+#include <webserver/byte_ranges.h>
+#include <utils/logger.h>
+
+namespace ws {
+
+void access_log::operator()(const request& req, response& resp) const {
+  inner(req, resp);
+  std::size_t size;
+  if (resp.prepared != nullptr) {
+    size = resp.prepared->get_body().size();
+  } else if (resp.file != nullptr) {
+    size = static_cast<std::size_t>(resp.ranges.empty() ? resp.file->size : ranges_length(*resp.file, resp.ranges));
+  } else {
+    size = resp.body.size();
+  }
+  LOG_INFO("{} {} {} {}", req.method, req.target, resp.status, size);
+}
+
+}  // namespace ws
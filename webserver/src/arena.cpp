@@ -0,0 +1,50 @@
+/** @file    arena.cpp
+ *  @time    2026/10/19 ~ 下午3:50
+ *  @author  Leon
+ *
+ *  @note    Arena blocks come from, and go back to, the reactor's buffer_cache
+ *
+ */
+
+#include <webserver/arena.h>
+#include <algorithm>
+#include <new>
+#include <cstdint>
+
+namespace ws {
+
+void arena::reset() {
+  while (current) {
+    auto prev = reinterpret_cast<block_header*>(current.data)->prev;
+    cache->release(current);
+    current = prev;
+  }
+  used = 0;
+  allocated = 0;
+}
+
+namespace {
+
+// offset of the first `alignment`-aligned address at or after base + used (alignments are powers of two)
+std::size_t align_up(const char* base, std::size_t used, std::size_t alignment) {
+  auto addr = reinterpret_cast<std::uintptr_t>(base) + used;
+  return used + (((addr + alignment - 1) & ~(alignment - 1)) - addr);
+}
+
+}  // namespace
+
+
+void* arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  auto offset = current ? align_up(current.data, used, alignment) : 0;
+  if (!current || offset + bytes > current.capacity) {
+    auto block = cache->acquire(std::max(MIN_BLOCK, sizeof(block_header) + bytes + alignment));
+    new (block.data) block_header{current};
+    current = block;
+    allocated += block.capacity;
+    offset = align_up(current.data, sizeof(block_header), alignment);
+  }
+  used = offset + bytes;
+  return current.data + offset;
+}
+
+}  // namespace ws
@@ -0,0 +1,108 @@
+/** @file    buffer_pool.cpp
+ *  @time    2026/10/19 ~ 下午3:30
+ *  @author  Leon
+ *
+ *  @note    Global free lists and the per-reactor caches in front of them
+ *
+ */
+
+#include <webserver/buffer_pool.h>
+#include <new>
+
+namespace ws {
+
+std::size_t buffer_pool::class_of(std::size_t size) {
+  std::size_t cls{0};
+  while (cls < NUM_CLASSES && class_size(cls) < size) {
+    ++cls;
+  }
+  return cls;
+}
+
+buffer_pool::buffer_pool(std::size_t max_cached_bytes_per_class) : max_cached_bytes(max_cached_bytes_per_class) {}
+
+buffer_pool::~buffer_pool() {
+  for (auto& c : classes) {
+    for (auto* p : c.free) {
+      ::operator delete(p);
+    }
+  }
+}
+
+void buffer_pool::take(std::size_t cls, std::vector<char*>& out, std::size_t n) {
+  {
+    std::lock_guard<std::mutex> lck{classes[cls].mtx};
+    auto& free = classes[cls].free;
+    while (n > 0 && !free.empty()) {
+      out.push_back(free.back());
+      free.pop_back();
+      --n;
+    }
+  }
+  for (; n > 0; --n) {
+    out.push_back(static_cast<char*>(::operator new(class_size(cls))));
+  }
+}
+
+void buffer_pool::give(std::size_t cls, std::vector<char*>& in, std::size_t n) {
+  std::size_t max_free = max_cached_bytes / class_size(cls);
+  std::vector<char*> excess;
+  {
+    std::lock_guard<std::mutex> lck{classes[cls].mtx};
+    auto& free = classes[cls].free;
+    for (; n > 0 && !in.empty(); --n) {
+      (free.size() < max_free ? free : excess).push_back(in.back());
+      in.pop_back();
+    }
+  }
+  for (auto* p : excess) {
+    ::operator delete(p);
+  }
+}
+
+std::size_t buffer_pool::get_num_free(std::size_t cls) {
+  std::lock_guard<std::mutex> lck{classes[cls].mtx};
+  return classes[cls].free.size();
+}
+
+buffer_cache::~buffer_cache() {
+  for (std::size_t cls = 0; cls < buffer_pool::NUM_CLASSES; ++cls) {
+    pool.give(cls, local[cls], local[cls].size());
+  }
+}
+
+pooled_buffer buffer_cache::acquire(std::size_t min_size) {
+  auto cls = buffer_pool::class_of(min_size);
+  if (cls == buffer_pool::NUM_CLASSES) {
+    add_in_use(static_cast<std::ptrdiff_t>(min_size));
+    return {static_cast<char*>(::operator new(min_size)), min_size};
+  }
+  auto& list = local[cls];
+  if (list.empty()) {
+    pool.take(cls, list, BATCH);
+  }
+  auto* p = list.back();
+  list.pop_back();
+  add_in_use(static_cast<std::ptrdiff_t>(buffer_pool::class_size(cls)));
+  return {p, buffer_pool::class_size(cls)};
+}
+
+void buffer_cache::release(pooled_buffer& buf) {
+  if (!buf) {
+    return;
+  }
+  add_in_use(-static_cast<std::ptrdiff_t>(buf.capacity));
+  auto cls = buffer_pool::class_of(buf.capacity);
+  if (cls == buffer_pool::NUM_CLASSES || buffer_pool::class_size(cls) != buf.capacity) {
+    ::operator delete(buf.data);
+  } else {
+    auto& list = local[cls];
+    list.push_back(buf.data);
+    if (list.size() > MAX_LOCAL) {
+      pool.give(cls, list, BATCH);
+    }
+  }
+  buf = {};
+}
+
+}  // namespace ws
@@ -0,0 +1,280 @@
+/** @file    compression.cpp
+ *  @time    2026/10/20 ~ 上午10:00
+ *  @author  Leon
+ *
+ *  @note    Accept-Encoding negotiation, zlib / brotli one-shot encoding, background encoding of shared bodies
+ *
+ */
+
+#include <webserver/compression.h>
+#include <webserver/file_cache.h>
+#include <fmt/format.h>
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WITH_BROTLI
+#include <brotli/encode.h>
+#endif
+
+namespace ws {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+// a qvalue ("0", "0.5", "1.000") in thousandths; malformed ones count as 1
+int parse_qvalue(std::string_view params) {
+  while (!params.empty()) {
+    auto semicolon = params.find(';');
+    auto param = trim(params.substr(0, semicolon));
+    params.remove_prefix(semicolon == std::string_view::npos ? params.size() : semicolon + 1);
+    if (param.size() < 3 || (param[0] | 0x20) != 'q' || param[1] != '=') {
+      continue;
+    }
+    auto value = param.substr(2);
+    if (value[0] == '1') {
+      return 1000;
+    }
+    int q{0};
+    int scale{100};
+    for (std::size_t i = 2; i < value.size() && i < 5 && value[0] == '0' && value[1] == '.'; ++i, scale /= 10) {
+      q += (value[i] - '0') * scale;
+    }
+    return q;
+  }
+  return 1000;
+}
+
+const std::string* find_header(const response& resp, std::string_view name) {
+  for (const auto& [n, value] : resp.headers) {
+    if (iequals(n, name)) {
+      return &value;
+    }
+  }
+  return nullptr;
+}
+
+// the head of a rendered response, for an encoded body of `size` bytes: new Content-Length, weak ETag
+std::string encoded_head(std::string_view head, encoding e, std::size_t size) {
+  std::string out{head};
+  constexpr std::string_view length = "\r\nContent-Length: ";
+  if (auto pos = out.find(length); pos != std::string::npos) {
+    pos += length.size();
+    out.replace(pos, out.find("\r\n", pos) - pos, std::to_string(size));
+  }
+  constexpr std::string_view etag = "\r\nETag: ";
+  if (auto pos = out.find(etag); pos != std::string::npos && out.compare(pos + etag.size(), 2, "W/") != 0) {
+    out.insert(pos + etag.size(), "W/");  // the bytes differ from the identity body the strong tag names
+  }
+  fmt::format_to(std::back_inserter(out), "Content-Encoding: {}\r\n", encoding_name(e));
+  return out;
+}
+
+}  // namespace
+
+
+std::string_view encoding_name(encoding e) {
+  switch (e) {
+    case encoding::gzip: return "gzip";
+    case encoding::br: return "br";
+    default: return "identity";
+  }
+}
+
+bool is_available(encoding e) {
+  switch (e) {
+#ifdef WITH_ZLIB
+    case encoding::gzip: return true;
+#endif
+#ifdef WITH_BROTLI
+    case encoding::br: return true;
+#endif
+    default: return false;
+  }
+}
+
+encoding negotiate(std::string_view accept_encoding) {
+  int q_gzip{-1};
+  int q_br{-1};
+  int q_any{-1};
+  while (!accept_encoding.empty()) {
+    auto comma = accept_encoding.find(',');
+    auto item = trim(accept_encoding.substr(0, comma));
+    accept_encoding.remove_prefix(comma == std::string_view::npos ? accept_encoding.size() : comma + 1);
+    auto semicolon = item.find(';');
+    auto coding = trim(item.substr(0, semicolon));
+    int q = semicolon == std::string_view::npos ? 1000 : parse_qvalue(item.substr(semicolon + 1));
+    if (iequals(coding, "gzip") || iequals(coding, "x-gzip")) {
+      q_gzip = q;
+    } else if (iequals(coding, "br")) {
+      q_br = q;
+    } else if (coding == "*") {
+      q_any = q;
+    }
+  }
+  q_gzip = is_available(encoding::gzip) ? (q_gzip < 0 ? q_any : q_gzip) : -1;
+  q_br = is_available(encoding::br) ? (q_br < 0 ? q_any : q_br) : -1;
+  if (q_br > 0 && q_br >= q_gzip) {
+    return encoding::br;
+  }
+  return q_gzip > 0 ? encoding::gzip : encoding::identity;
+}
+
+bool is_compressible(std::string_view content_type) {
+  auto type = trim(content_type.substr(0, content_type.find(';')));
+  if (type.substr(0, 5) == "text/") {
+    return true;
+  }
+  static constexpr std::string_view types[] = {"application/json", "application/javascript", "application/xml",
+                                               "application/wasm", "image/svg+xml"};
+  for (auto t : types) {
+    if (iequals(type, t)) {
+      return true;
+    }
+  }
+  auto plus = type.rfind('+');
+  return plus != std::string_view::npos && (type.substr(plus) == "+json" || type.substr(plus) == "+xml");
+}
+
+bool compress(std::string_view in, encoding e, int level, std::string& out) {
+#ifdef WITH_ZLIB
+  if (e == encoding::gzip) {
+    z_stream zs{};
+    if (::deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {  // +16: gzip framing
+      return false;
+    }
+    out.resize(::deflateBound(&zs, static_cast<uLong>(in.size())));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    auto status = ::deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    ::deflateEnd(&zs);
+    return status == Z_STREAM_END;
+  }
+#endif
+#ifdef WITH_BROTLI
+  if (e == encoding::br) {
+    auto size = ::BrotliEncoderMaxCompressedSize(in.size());
+    out.resize(size);
+    auto ok = ::BrotliEncoderCompress(level, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, in.size(),
+                                      reinterpret_cast<const std::uint8_t*>(in.data()), &size,
+                                      reinterpret_cast<std::uint8_t*>(out.data()));
+    out.resize(ok ? size : 0);
+    return ok == BROTLI_TRUE;
+  }
+#endif
+  (void)in, (void)level, (void)out;
+  return false;
+}
+
+compressor::compressor(const compression_config& cfg) : config(cfg), workers(std::max<std::size_t>(1, cfg.num_workers)) {}
+
+encoding compressor::prepare(const request& req, response& resp) {
+  if (resp.status != 200) {
+    return encoding::identity;
+  }
+  if (resp.prepared != nullptr) {  // rendered (and Vary-ed) by the response cache
+    const auto& original = *resp.prepared;
+    if (!original.compressible || original.get_body().size() < config.min_size) {
+      return encoding::identity;
+    }
+    auto e = negotiate(req.get_header("Accept-Encoding"));
+    if (e == encoding::identity) {
+      return e;
+    }
+    if (auto copy = original.encoded.get(e); copy != nullptr) {
+      if (!copy->bytes.empty()) {
+        resp.prepared = std::move(copy);
+      }
+    } else if (original.encoded.try_start(e)) {
+      encode_prepared(resp.prepared, e);
+    }
+    return encoding::identity;
+  }
+  if (resp.shared_body != nullptr || !resp.ranges.empty() || find_header(resp, "Content-Encoding") != nullptr) {
+    return encoding::identity;
+  }
+
+  if (resp.file != nullptr) {
+    const auto& file = *resp.file;
+    auto size = static_cast<std::size_t>(file.size);
+    if (!is_compressible(file.content_type) || size < config.min_size || size > config.max_file_size) {
+      return encoding::identity;
+    }
+    resp.headers.emplace_back("Vary", "Accept-Encoding");
+    auto e = negotiate(req.get_header("Accept-Encoding"));
+    if (e == encoding::identity) {
+      return e;
+    }
+    if (auto copy = file.encoded.get(e); copy != nullptr) {
+      if (!copy->empty()) {
+        resp.shared_body = std::move(copy);
+        resp.headers.emplace_back("Content-Encoding", encoding_name(e));
+      }
+    } else if (file.encoded.try_start(e)) {
+      encode_file(resp.file, e);
+    }
+    return encoding::identity;
+  }
+
+  if (!is_compressible(resp.content_type) || resp.body.size() < config.min_size) {
+    return encoding::identity;
+  }
+  resp.headers.emplace_back("Vary", "Accept-Encoding");
+  return req.method == "HEAD" ? encoding::identity : negotiate(req.get_header("Accept-Encoding"));
+}
+
+void compressor::encode_async(response&& resp, encoding e, std::function<void(response&&)> done) {
+  workers.post([this, resp = std::move(resp), e, done = std::move(done)]() mutable {
+    encode_body(resp, e);
+    done(std::move(resp));
+  });
+}
+
+void compressor::encode_body(response& resp, encoding e) const {
+  std::string encoded{};
+  if (compress(resp.body, e, level_of(e), encoded) && encoded.size() < resp.body.size()) {
+    resp.body = std::move(encoded);
+    resp.headers.emplace_back("Content-Encoding", encoding_name(e));
+    for (auto& [name, value] : resp.headers) {
+      if (iequals(name, "ETag") && value.compare(0, 2, "W/") != 0) {
+        value.insert(0, "W/");
+      }
+    }
+  }
+}
+
+void compressor::encode_prepared(std::shared_ptr<const prepared_response> original, encoding e) {
+  workers.post([this, original = std::move(original), e]() {
+    std::string encoded{};
+    auto body = original->get_body();
+    auto copy = std::make_shared<prepared_response>();
+    if (compress(body, e, level_of(e), encoded) && encoded.size() < body.size()) {
+      copy->assign(encoded_head(std::string_view{original->bytes}.substr(0, original->head_size), e, encoded.size()), encoded);
+    }
+    original->encoded.set(e, std::move(copy));  // left empty: not worth it, the original is sent
+  });
+}
+
+void compressor::encode_file(std::shared_ptr<const open_file> file, encoding e) {
+  workers.post([this, file = std::move(file), e]() {
+    std::string content{};
+    auto encoded = std::make_shared<std::string>();
+    if (!read_all(*file, content) || !compress(content, e, level_of(e), *encoded) || encoded->size() >= content.size()) {
+      encoded->clear();
+    }
+    file->encoded.set(e, std::move(encoded));
+  });
+}
+
+}  // namespace ws
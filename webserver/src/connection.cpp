@@ -0,0 +1,286 @@
+/** @file    connection.cpp
+ *  @time    2026/10/18 ~ 下午10:40
+ *  @author  Leon
+ *
+ *  @note    Read → parse → handle → write loop of a connection
+ *
+ */
+
+#include <webserver/connection.h>
+#include <webserver/reactor.h>
+#include <webserver/rate_limiter.h>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ws {
+
+namespace {
+
+constexpr std::size_t READ_CHUNK = 16 * 1024;  // first read buffer; doubled while a request does not fit
+constexpr std::size_t MAX_BATCH = 64;  // pipelined requests answered per flush
+// output queued (file bytes included) beyond which no more pipelined requests are answered, until it drained below the
+// low mark: a client asking for many large responses at once is served as fast as it reads, not as fast as it asks
+constexpr std::size_t HIGH_WATERMARK = 256 * 1024;
+constexpr std::size_t LOW_WATERMARK = 64 * 1024;
+
+}  // namespace
+
+
+connection::connection(reactor& r, int sock, std::uint64_t i, const net::ip_address& p)
+    : owner(r),
+      fd(sock),
+      id(i),
+      peer(p),
+      mem(r.get_buffer_cache()),
+      out(r.get_buffer_cache(), &mem),
+      parser(parser_limits{}, &mem),
+      req(&mem),
+      timer(&connection::on_timeout, this) {
+  read_ev = ::event_new(owner.get_base(), fd, EV_READ | EV_PERSIST, &connection::on_readable, this);
+  write_ev = ::event_new(owner.get_base(), fd, EV_WRITE | EV_PERSIST, &connection::on_writable, this);
+}
+
+connection::~connection() {
+  owner.get_wheel().cancel(timer);
+  ::event_free(read_ev);
+  ::event_free(write_ev);
+  ::close(fd);
+  owner.get_buffer_cache().release(in);
+}
+
+void connection::start() {
+  ::event_add(read_ev, nullptr);
+  arm_timer();
+}
+
+void connection::on_readable(evutil_socket_t, short, void* arg) {
+  auto* self = static_cast<connection*>(arg);
+  if (self->handle_read()) {
+    self->arm_timer();
+  }
+}
+
+void connection::on_writable(evutil_socket_t, short, void* arg) {
+  auto* self = static_cast<connection*>(arg);
+  if (self->handle_write()) {
+    self->arm_timer();
+  }
+}
+
+void connection::on_timeout(void* arg) {
+  auto* self = static_cast<connection*>(arg);
+  if (self->waiting == wait::header && !self->closing) {
+    self->respond_error(408);  // a slow or stalled client gets told, then closed once that is flushed
+    if (self->flush_output()) {
+      self->arm_timer();
+    }
+    return;
+  }
+  self->owner.close_connection(self->fd);
+}
+
+void connection::arm_timer() {
+  const auto& limits = owner.get_timeouts();
+  auto& wheel = owner.get_wheel();
+  if (writing || offloaded) {
+    waiting = wait::write;
+    wheel.schedule(timer, limits.write);
+  } else if (in_len > 0) {
+    if (waiting != wait::header || !timer.is_armed()) {
+      waiting = wait::header;
+      wheel.schedule(timer, limits.read_header);
+    }
+  } else {
+    waiting = wait::idle;
+    wheel.schedule(timer, limits.idle);
+  }
+}
+
+void connection::reserve_input() {
+  auto& cache = owner.get_buffer_cache();
+  if (!in) {
+    in = cache.acquire(READ_CHUNK);
+  } else if (in_len == in.capacity) {
+    auto bigger = cache.acquire(2 * in.capacity);
+    std::memcpy(bigger.data, in.data, in_len);
+    cache.release(in);
+    in = bigger;
+  }
+}
+
+void connection::release_idle() {
+  if (in_len == 0) {
+    owner.get_buffer_cache().release(in);
+  }
+  if (in_len == 0 && out.empty()) {
+    out.clear();
+    parser.release();
+    req.headers = std::pmr::vector<header>{req.headers.get_allocator()};
+    mem.reset();
+  }
+}
+
+bool connection::handle_read() {
+  while (true) {
+    reserve_input();
+    auto space = in.capacity - in_len;
+    auto n = ::recv(fd, in.data + in_len, space, 0);
+    if (n > 0) {
+      in_len += static_cast<std::size_t>(n);
+      if (static_cast<std::size_t>(n) < space) {
+        break;  // drained for now; the next read would most likely return EAGAIN
+      }
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    owner.close_connection(fd);  // EOF or error
+    return false;
+  }
+  return process_requests();
+}
+
+bool connection::handle_write() {
+  if (!flush_output()) {
+    return false;
+  }
+  // below the low mark: answer what arrived meanwhile, queued behind what is still going out
+  return (writing && out.get_pending() >= LOW_WATERMARK) || process_requests();
+}
+
+bool connection::process_requests() {
+  while (true) {
+    std::size_t offset{0};
+    std::size_t batched{0};
+    bool full{false};  // over the high watermark
+    while (!closing && !offloaded && !full && batched < MAX_BATCH) {
+      std::string_view buf{in.data + offset, in_len - offset};
+      auto status = parser.parse(buf, req);
+      if (status != parse_status::error && !admit(buf)) {
+        offset = in_len;  // the body, if any, is not waited for
+        break;
+      }
+      if (status == parse_status::incomplete) {
+        break;
+      }
+      if (status == parse_status::error) {
+        offset = in_len;
+        respond_error(parser.get_error_status());
+        break;
+      }
+
+      response resp{};
+      resp.keep_alive = req.keep_alive;
+      owner.get_handler()(req, resp);
+      owner.count_request();
+      offset += parser.get_consumed();
+      ++batched;
+      if (!owner.offload(*this, req, resp)) {
+        offloaded = true;  // later responses must wait for this one
+        ::event_del(read_ev);
+        parser.reset();
+        admitted = false;
+        break;
+      }
+      closing = !resp.keep_alive;
+      append_response(resp, req.method == "HEAD");
+      parser.reset();
+      admitted = false;
+      full = out.get_pending() >= HIGH_WATERMARK;
+    }
+    if (offset != 0) {
+      std::memmove(in.data, in.data + offset, in_len - offset);
+      in_len -= offset;
+    }
+    if (!flush_output()) {
+      return false;
+    }
+    // a full batch (or output) with more requests buffered: go on if the socket took everything
+    if ((batched < MAX_BATCH && !full) || writing || closing || offloaded) {
+      return true;
+    }
+  }
+}
+
+void connection::append_response(response& resp, bool head_only) {
+  ws::append_response(out, resp, head_only, owner.get_headers());
+}
+
+void connection::resume(response& resp) {
+  offloaded = false;
+  closing = !resp.keep_alive;
+  append_response(resp, false);  // a worker leaves no body in a reply to HEAD
+  if (!flush_output()) {
+    return;
+  }
+  if (!writing) {
+    ::event_add(read_ev, nullptr);
+  }
+  if (writing || process_requests()) {
+    arm_timer();
+  }
+}
+
+bool connection::flush_output() {
+  switch (out.flush(fd)) {
+    case output_chain::flush_result::done:
+      if (closing) {
+        owner.close_connection(fd);
+        return false;
+      }
+      if (writing) {
+        writing = false;
+        ::event_del(write_ev);
+        if (!offloaded) {
+          ::event_add(read_ev, nullptr);
+        }
+      }
+      release_idle();
+      return true;
+    case output_chain::flush_result::blocked:
+      // wait for the socket to drain; stop reading meanwhile, so a client that does not read cannot make us buffer
+      if (!writing) {
+        writing = true;
+        ::event_del(read_ev);
+        ::event_add(write_ev, nullptr);
+      }
+      return true;
+    default:
+      owner.close_connection(fd);
+      return false;
+  }
+}
+
+bool connection::admit(std::string_view buf) {
+  auto* limiter = owner.get_limiter();
+  if (admitted || limiter == nullptr || !parser.has_head()) {
+    return true;
+  }
+  admitted = true;
+  auto target = parser.get_target(buf);
+  auto wait = limiter->admit(peer, target.substr(0, target.find('?')));
+  if (wait == 0) {
+    return true;
+  }
+  auto resp = too_many_requests(wait);
+  closing = true;
+  append_response(resp, false);
+  return false;
+}
+
+void connection::respond_error(int status) {
+  response resp{};
+  resp.status = status;
+  resp.keep_alive = false;
+  resp.body = std::string{status_reason(status)};
+  closing = true;
+  append_response(resp, false);
+}
+
+}  // namespace ws
@@ -0,0 +1,211 @@
+/** @file    file_cache.cpp
+ *  @time    2026/10/19 ~ 上午11:00
+ *  @author  Leon
+ *
+ *  @note    Opening, revalidating and evicting cached files
+ *
+ */
+
+#include <webserver/file_cache.h>
+#include <fmt/format.h>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ws {
+
+namespace {
+
+// request paths are absolute and may not climb out of the root
+bool is_safe_path(std::string_view path) {
+  if (path.empty() || path.front() != '/' || path.find('\0') != std::string_view::npos) {
+    return false;
+  }
+  std::size_t start{1};
+  while (start <= path.size()) {
+    auto slash = path.find('/', start);
+    auto segment = path.substr(start, slash == std::string_view::npos ? std::string_view::npos : slash - start);
+    if (segment == "..") {
+      return false;
+    }
+    if (slash == std::string_view::npos) {
+      break;
+    }
+    start = slash + 1;
+  }
+  return true;
+}
+
+bool same_file(const open_file& f, const struct stat& st) {
+  return f.inode == st.st_ino && f.size == st.st_size && f.mtime.tv_sec == st.st_mtim.tv_sec &&
+         f.mtime.tv_nsec == st.st_mtim.tv_nsec;
+}
+
+}  // namespace
+
+
+open_file::~open_file() {
+  if (fd >= 0) {
+    ::close(fd);
+  }
+}
+
+bool read_all(const open_file& file, std::string& out) {
+  out.resize(static_cast<std::size_t>(file.size));
+  std::size_t done{0};
+  while (done < out.size()) {
+    auto n = ::pread(file.fd, out.data() + done, out.size() - done, static_cast<off_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    done += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+std::string_view mime_type(std::string_view path) {
+  auto dot = path.rfind('.');
+  if (dot == std::string_view::npos || path.find('/', dot) != std::string_view::npos) {
+    return "application/octet-stream";
+  }
+  auto ext = path.substr(dot + 1);
+  static const std::pair<std::string_view, std::string_view> types[] = {
+      {"html", "text/html; charset=utf-8"},
+      {"htm", "text/html; charset=utf-8"},
+      {"css", "text/css; charset=utf-8"},
+      {"js", "text/javascript; charset=utf-8"},
+      {"json", "application/json"},
+      {"txt", "text/plain; charset=utf-8"},
+      {"xml", "application/xml"},
+      {"svg", "image/svg+xml"},
+      {"png", "image/png"},
+      {"jpg", "image/jpeg"},
+      {"jpeg", "image/jpeg"},
+      {"gif", "image/gif"},
+      {"webp", "image/webp"},
+      {"ico", "image/x-icon"},
+      {"woff2", "font/woff2"},
+      {"wasm", "application/wasm"},
+      {"pdf", "application/pdf"},
+      {"mp4", "video/mp4"},
+      {"webm", "video/webm"},
+  };
+  for (const auto& [e, type] : types) {
+    if (ext == e) {
+      return type;
+    }
+  }
+  return "application/octet-stream";
+}
+
+file_cache::file_cache(file_cache_config cfg) : config(std::move(cfg)) {
+  if (config.num_shards == 0) {
+    config.num_shards = 1;
+  }
+  max_per_shard = std::max<std::size_t>(1, config.max_fds / config.num_shards);
+  for (std::size_t i = 0; i < config.num_shards; ++i) {
+    shards.push_back(std::make_unique<shard>());
+  }
+}
+
+file_cache::shard& file_cache::shard_of(std::string_view path) {
+  return *shards[std::hash<std::string_view>{}(path) % shards.size()];
+}
+
+std::shared_ptr<const open_file> file_cache::lookup(std::string_view path) {
+  if (!is_safe_path(path)) {
+    return nullptr;
+  }
+  std::string with_index{};
+  auto key = path;  // a hit allocates nothing
+  if (key.back() == '/') {
+    with_index = std::string{path} + "index.html";
+    key = with_index;
+  }
+  auto& s = shard_of(key);
+  auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lck{s.mtx};
+    if (auto it = s.index.find(key); it != s.index.end()) {
+      auto node = it->second;
+      bool fresh = now - node->validated_at < config.revalidate_after;
+      // stale: one stat() tells whether the file on disk is still the one we hold open
+      struct stat st {};
+      if (fresh || (::stat((config.root + std::string{key}).c_str(), &st) == 0 && same_file(*node->file, st))) {
+        node->validated_at = now;
+        s.lru.splice(s.lru.begin(), s.lru, node);
+        return node->file;
+      }
+      s.index.erase(it);
+      s.lru.erase(node);
+    }
+  }
+
+  // miss: open without holding the shard lock
+  auto file = open(config.root + std::string{key});
+  if (file == nullptr) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lck{s.mtx};
+  if (auto it = s.index.find(key); it != s.index.end()) {  // another reactor opened it meanwhile
+    return it->second->file;
+  }
+  s.lru.push_front({std::string{key}, file, now});
+  s.index.emplace(s.lru.front().path, s.lru.begin());
+  while (s.lru.size() > max_per_shard) {
+    s.index.erase(s.lru.back().path);
+    s.lru.pop_back();
+  }
+  return file;
+}
+
+std::shared_ptr<const open_file> file_cache::open(const std::string& full_path) const {
+  int fd = ::open(full_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  auto file = std::make_shared<open_file>();
+  file->fd = fd;
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    return nullptr;  // closes fd
+  }
+  file->size = st.st_size;
+  file->mtime = st.st_mtim;
+  file->inode = st.st_ino;
+  file->content_type = std::string{mime_type(full_path)};
+
+  std::tm tm{};
+  ::gmtime_r(&st.st_mtim.tv_sec, &tm);
+  char date[64];
+  auto len = std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  file->last_modified = std::string{date, len};
+  file->etag = fmt::format("\"{:x}.{:x}-{:x}\"", st.st_mtim.tv_sec, st.st_mtim.tv_nsec, st.st_size);
+  file->headers = fmt::format("Content-Type: {}\r\nLast-Modified: {}\r\nAccept-Ranges: bytes\r\n", file->content_type,
+                              file->last_modified);
+  return file;
+}
+
+void file_cache::clear() {
+  for (auto& s : shards) {
+    std::lock_guard<std::mutex> lck{s->mtx};
+    s->index.clear();
+    s->lru.clear();
+  }
+}
+
+std::size_t file_cache::get_num_open() const {
+  std::size_t n{0};
+  for (const auto& s : shards) {
+    std::lock_guard<std::mutex> lck{s->mtx};
+    n += s->lru.size();
+  }
+  return n;
+}
+
+}  // namespace ws
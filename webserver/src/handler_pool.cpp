@@ -0,0 +1,66 @@
+/** @file    handler_pool.cpp
+ *  @time    2026/10/21 ~ 下午10:00
+ *  @author  Leon
+ *
+ *  @note    Deferred handlers, content coding and rendering on the workers
+ *
+ */
+
+#include <webserver/handler_pool.h>
+#include <webserver/header_builder.h>
+#include <string>
+
+namespace ws {
+
+handler_pool::handler_pool(std::size_t num_threads, compressor* c)
+    : workers(std::max<std::size_t>(1, num_threads)), compression(c) {}
+
+void handler_pool::run(io_loop& loop, const request& req, response&& resp, std::function<void(response&)> done) {
+  run_then(
+      workers, loop,
+      [this, copy = copy_request(req), resp = std::move(resp)]() mutable {
+        finish(*copy, resp, compression);
+        return std::move(resp);
+      },
+      [done = std::move(done)](response&& r) { done(r); });
+}
+
+void handler_pool::finish(const request& req, response& resp, compressor* c) {
+  auto job = std::move(resp.deferred);
+  resp.deferred = nullptr;
+  try {
+    job(req, resp);
+  } catch (...) {  // whatever it throws: it runs on a worker or a loop callback, where nothing catches
+    bool keep_alive = resp.keep_alive;
+    resp = response{};
+    resp.status = 500;
+    resp.keep_alive = keep_alive;
+    resp.body = std::string{status_reason(500)};
+  }
+  resp.deferred = nullptr;  // a deferred part does not defer again
+  if (c != nullptr && req.method != "HEAD") {
+    if (auto e = c->prepare(req, resp); e != encoding::identity) {
+      c->encode_body(resp, e);
+    }
+  }
+  if (resp.prepared != nullptr || resp.file != nullptr) {
+    return;  // already a shared buffer, or sent from the file
+  }
+
+  // the head without the Connection line, which the loop adds, then the body: one run of bytes
+  constexpr std::string_view keep_alive_line = "Connection: keep-alive\r\n\r\n";
+  bool keep_alive = resp.keep_alive;
+  resp.keep_alive = true;
+  fmt::memory_buffer head{};
+  render_head(head, resp, {});
+  resp.keep_alive = keep_alive;
+  std::string_view body = resp.shared_body != nullptr ? std::string_view{*resp.shared_body} : resp.body;
+  auto prepared = std::make_shared<prepared_response>();
+  prepared->assign(std::string{head.data(), head.size() - keep_alive_line.size()},
+                   req.method == "HEAD" ? std::string_view{} : body);
+  resp.prepared = std::move(prepared);
+  resp.body.clear();
+  resp.shared_body.reset();
+}
+
+}  // namespace ws
@@ -0,0 +1,106 @@
+/** @file    header_builder.cpp
+ *  @time    2026/10/20 ~ 下午8:00
+ *  @author  Leon
+ *
+ *  @note    Status line table, head rendering and the IMF-fixdate Date line
+ *
+ */
+
+#include <webserver/header_builder.h>
+#include <webserver/file_cache.h>
+#include <webserver/byte_ranges.h>
+#include <fmt/compile.h>
+#include <string>
+
+namespace ws {
+
+namespace {
+
+constexpr int MIN_STATUS{100};
+constexpr int MAX_STATUS{599};
+
+struct status_lines {
+  std::array<std::string, MAX_STATUS - MIN_STATUS + 1> lines{};
+
+  status_lines() {
+    for (int status = MIN_STATUS; status <= MAX_STATUS; ++status) {
+      if (auto reason = status_reason(status); reason != "Unknown") {
+        lines[status - MIN_STATUS] = fmt::format(FMT_COMPILE("HTTP/1.1 {} {}\r\n"), status, reason);
+      }
+    }
+  }
+};
+
+const status_lines STATUS_LINES{};
+
+void append(fmt::memory_buffer& out, std::string_view s) { out.append(s.data(), s.data() + s.size()); }
+
+}  // namespace
+
+
+std::string_view status_line(int status) {
+  return status < MIN_STATUS || status > MAX_STATUS ? std::string_view{} : STATUS_LINES.lines[status - MIN_STATUS];
+}
+
+void render_head(fmt::memory_buffer& out, const response& resp, std::string_view date) {
+  if (auto line = status_line(resp.status); !line.empty()) {
+    append(out, line);
+  } else {
+    fmt::format_to(std::back_inserter(out), FMT_COMPILE("HTTP/1.1 {} {}\r\n"), resp.status, status_reason(resp.status));
+  }
+  std::size_t length;
+  if (resp.file != nullptr && !resp.ranges.empty()) {
+    const auto& file = *resp.file;
+    if (resp.ranges.size() == 1) {
+      append(out, file.headers);
+      fmt::format_to(std::back_inserter(out), FMT_COMPILE("Content-Range: bytes {}-{}/{}\r\n"), resp.ranges[0].first,
+                     resp.ranges[0].last, file.size);
+    } else {  // each part has the file's type, the whole its own
+      append(out, "Content-Type: ");
+      append(out, multipart_type());
+      append(out, "\r\n");
+      append(out, std::string_view{file.headers}.substr(file.headers.find("\r\n") + 2));
+    }
+    length = static_cast<std::size_t>(ranges_length(file, resp.ranges));
+  } else if (resp.file != nullptr) {  // the entity headers were rendered when the file was opened
+    append(out, resp.file->headers);
+    length = resp.shared_body != nullptr ? resp.shared_body->size() : static_cast<std::size_t>(resp.file->size);
+  } else {
+    append(out, "Content-Type: ");
+    append(out, resp.content_type);
+    append(out, "\r\n");
+    length = resp.shared_body != nullptr ? resp.shared_body->size() : resp.body.size();
+  }
+  if (resp.file != nullptr) {  // weak for an encoded copy (a shared body), whose bytes differ from the file's
+    append(out, resp.shared_body != nullptr ? "ETag: W/" : "ETag: ");
+    append(out, resp.file->etag);
+    append(out, "\r\n");
+  }
+  fmt::format_to(std::back_inserter(out), FMT_COMPILE("Content-Length: {}\r\n"), length);
+  for (const auto& [name, value] : resp.headers) {
+    append(out, name);
+    append(out, ": ");
+    append(out, value);
+    append(out, "\r\n");
+  }
+  append(out, date);
+  append(out, resp.keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+}
+
+void header_builder::update_date(std::time_t now) {
+  if (now == date_time) {
+    return;
+  }
+  static constexpr std::string_view days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+  static constexpr std::string_view months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                                "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+  std::tm t{};
+  ::gmtime_r(&now, &t);
+  auto result = fmt::format_to_n(date.data(), date.size(), FMT_COMPILE("Date: {}, {:02} {} {} {:02}:{:02}:{:02} GMT\r\n"),
+                                 days[t.tm_wday], t.tm_mday, months[t.tm_mon], t.tm_year + 1900, t.tm_hour, t.tm_min,
+                                 t.tm_sec);
+  date_size = result.size;
+  date_time = now;
+}
+
+}  // namespace ws
@@ -0,0 +1,120 @@
+/** @file    http.cpp
+ *  @time    2026/10/18 ~ 下午10:20
+ *  @author  Leon
+ *
+ *  @note    Request helpers and response serialization
+ *
+ */
+
+#include <webserver/http.h>
+#include <webserver/header_builder.h>
+
+namespace ws {
+
+bool iequals(std::string_view lhs, std::string_view rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    if ((lhs[i] | 0x20) != (rhs[i] | 0x20)) {  // only used on header names / tokens, where this is exact
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string_view request::get_header(std::string_view name) const {
+  for (const auto& h : headers) {
+    if (iequals(h.name, name)) {
+      return h.value;
+    }
+  }
+  return {};
+}
+
+std::shared_ptr<const request> copy_request(const request& req) {
+  struct owned {
+    std::string bytes{};
+    request req{};
+  };
+  auto size = req.method.size() + req.target.size() + req.path.size() + req.query.size() + req.body.size();
+  for (const auto& h : req.headers) {
+    size += h.name.size() + h.value.size();
+  }
+  auto o = std::make_shared<owned>();
+  o->bytes.reserve(size);  // reserved once: the views below stay valid as it fills up
+  auto keep = [&bytes = o->bytes](std::string_view v) {
+    auto at = bytes.size();
+    bytes.append(v);
+    return std::string_view{bytes.data() + at, v.size()};
+  };
+  auto& copy = o->req;
+  copy.method = keep(req.method);
+  copy.target = keep(req.target);
+  copy.path = keep(req.path);
+  copy.query = keep(req.query);
+  copy.body = keep(req.body);
+  copy.version_minor = req.version_minor;
+  copy.keep_alive = req.keep_alive;
+  copy.headers.reserve(req.headers.size());
+  for (const auto& h : req.headers) {
+    auto name = keep(h.name);
+    copy.headers.push_back({name, keep(h.value)});
+  }
+  return std::shared_ptr<const request>{std::move(o), &copy};
+}
+
+std::string_view status_reason(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 411: return "Length Required";
+    case 412: return "Precondition Failed";
+    case 413: return "Payload Too Large";
+    case 414: return "URI Too Long";
+    case 416: return "Range Not Satisfiable";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+  }
+}
+
+void prepared_response::assign(std::string head, std::string_view body) {
+  constexpr std::string_view keep_alive = "Connection: keep-alive\r\n\r\n";
+  head_size = head.size();
+  bytes = std::move(head);
+  bytes.reserve(head_size + keep_alive.size() + body.size());
+  bytes += keep_alive;
+  body_offset = bytes.size();
+  bytes += body;
+}
+
+void response::serialize_head(std::string& out) const {
+  fmt::memory_buffer buf{};
+  render_head(buf, *this, {});
+  out.append(buf.data(), buf.size());
+}
+
+void response::serialize(std::string& out, bool head_only) const {
+  serialize_head(out);
+  if (!head_only && shared_body != nullptr) {
+    out += *shared_body;
+  } else if (!head_only && file == nullptr) {
+    out += body;
+  }
+}
+
+}  // namespace ws
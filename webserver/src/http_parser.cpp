@@ -0,0 +1,244 @@
+/** @file    http_parser.cpp
+ *  @time    2026/10/19 ~ 上午9:30
+ *  @author  Leon
+ *
+ *  @note    State machine of http_parser; the delimiter search is ws::scan::find_either
+ *
+ */
+
+#include <webserver/http_parser.h>
+#include <webserver/scan.h>
+#include <array>
+#include <charconv>
+
+namespace ws {
+
+namespace {
+
+bool is_space(char c) { return c == ' ' || c == '\t'; }
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && is_space(s.front())) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && is_space(s.back())) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+// RFC 9110 tchar, as a lookup table
+constexpr std::array<bool, 256> make_token_table() {
+  std::array<bool, 256> table{};
+  for (int c = 0; c < 256; ++c) {
+    table[c] = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+  }
+  for (char c : std::string_view{"!#$%&'*+-.^_`|~"}) {
+    table[static_cast<unsigned char>(c)] = true;
+  }
+  return table;
+}
+
+constexpr auto token_table = make_token_table();
+
+bool is_token(std::string_view s) {
+  if (s.empty()) {
+    return false;
+  }
+  for (unsigned char c : s) {
+    if (!token_table[c]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// does the comma-separated list `value` contain `token`?
+bool has_token(std::string_view value, std::string_view token) {
+  while (!value.empty()) {
+    auto comma = value.find(',');
+    if (iequals(trim(value.substr(0, comma)), token)) {
+      return true;
+    }
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    value.remove_prefix(comma + 1);
+  }
+  return false;
+}
+
+}  // namespace
+
+
+void http_parser::reset() {
+  st = state::request_line;
+  pos = line_start = name_end = 0;
+  method_off = method_len = target_off = target_len = 0;
+  version_minor = 1;
+  fields.clear();
+  header_size = content_length = 0;
+  has_content_length = has_transfer_encoding = connection_close = connection_keep_alive = false;
+  error_status = 0;
+}
+
+void http_parser::release() {
+  reset();
+  fields = std::pmr::vector<field>{fields.get_allocator()};
+}
+
+parse_status http_parser::fail(int status) {
+  st = state::error;
+  error_status = status;
+  return parse_status::error;
+}
+
+parse_status http_parser::parse(std::string_view buf, request& req) {
+  if (st == state::error) {
+    return parse_status::error;
+  }
+  const char* base = buf.data();
+  const char* end = base + buf.size();
+
+  while (st == state::request_line || st == state::headers) {
+    if (st == state::request_line) {
+      const char* nl = scan::find_either(base + pos, end, '\n', '\n');
+      if (nl == end) {
+        pos = buf.size();
+        return pos - line_start > limits.max_request_line ? fail(414) : parse_status::incomplete;
+      }
+      std::size_t eol = nl - base;
+      std::size_t line_end = eol > line_start && base[eol - 1] == '\r' ? eol - 1 : eol;
+      if (line_end == line_start) {  // empty lines before a request are ignored (RFC 9112 2.2)
+        line_start = pos = eol + 1;
+        continue;
+      }
+      if (line_end - line_start > limits.max_request_line) {
+        return fail(414);
+      }
+      if (!parse_request_line(buf, line_start, line_end)) {
+        return fail(400);
+      }
+      st = state::headers;
+      line_start = pos = eol + 1;
+      name_end = 0;
+      continue;
+    }
+
+    // headers: find the ':' of the line first, then its end
+    const char* p = scan::find_either(base + pos, end, name_end == 0 ? ':' : '\n', '\n');
+    if (p == end) {
+      pos = buf.size();
+      return pos > limits.max_header_bytes ? fail(431) : parse_status::incomplete;
+    }
+    std::size_t off = p - base;
+    if (*p == ':') {
+      name_end = off;
+      pos = off + 1;
+      continue;
+    }
+    if (off + 1 > limits.max_header_bytes) {
+      return fail(431);
+    }
+    std::size_t line_end = off > line_start && base[off - 1] == '\r' ? off - 1 : off;
+    if (line_end == line_start) {  // the empty line: end of the header section
+      header_size = off + 1;
+      st = state::body;
+      break;
+    }
+    if (name_end == 0 || !add_field(buf, line_start, name_end, line_end)) {
+      return fail(400);
+    }
+    if (fields.size() > limits.max_headers) {
+      return fail(431);
+    }
+    line_start = pos = off + 1;
+    name_end = 0;
+  }
+
+  if (st == state::body) {
+    if (has_transfer_encoding) {
+      return fail(501);  // chunked request bodies are not supported
+    }
+    if (content_length > limits.max_body) {
+      return fail(413);
+    }
+    if (buf.size() < header_size + content_length) {
+      return parse_status::incomplete;
+    }
+    st = state::done;
+  }
+  build(buf, req);
+  return parse_status::complete;
+}
+
+bool http_parser::parse_request_line(std::string_view buf, std::size_t start, std::size_t end) {
+  auto line = buf.substr(start, end - start);
+  auto sp1 = line.find(' ');
+  if (sp1 == std::string_view::npos) {
+    return false;
+  }
+  auto sp2 = line.find(' ', sp1 + 1);
+  if (sp2 == std::string_view::npos || sp2 == sp1 + 1) {
+    return false;
+  }
+  auto method = line.substr(0, sp1);
+  auto version = line.substr(sp2 + 1);
+  if (!is_token(method) || version.size() != 8 || version.substr(0, 7) != "HTTP/1." || version[7] < '0' ||
+      version[7] > '9') {
+    return false;
+  }
+  method_off = static_cast<std::uint32_t>(start);
+  method_len = static_cast<std::uint32_t>(sp1);
+  target_off = static_cast<std::uint32_t>(start + sp1 + 1);
+  target_len = static_cast<std::uint32_t>(sp2 - sp1 - 1);
+  version_minor = version[7] - '0';
+  return true;
+}
+
+bool http_parser::add_field(std::string_view buf, std::size_t start, std::size_t colon, std::size_t end) {
+  auto name = buf.substr(start, colon - start);
+  if (!is_token(name)) {  // also rejects whitespace before the colon and obsolete line folding
+    return false;
+  }
+  auto raw_value = buf.substr(colon + 1, end - colon - 1);
+  auto value = trim(raw_value);
+  auto value_off = static_cast<std::size_t>(value.data() - buf.data());
+
+  // the headers that decide framing and persistence
+  if (iequals(name, "Content-Length")) {
+    std::size_t length{0};
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), length);
+    if (ec != std::errc{} || ptr != value.data() + value.size() || (has_content_length && length != content_length)) {
+      return false;
+    }
+    has_content_length = true;
+    content_length = length;
+  } else if (iequals(name, "Transfer-Encoding")) {
+    has_transfer_encoding = true;
+  } else if (iequals(name, "Connection")) {
+    connection_close = connection_close || has_token(value, "close");
+    connection_keep_alive = connection_keep_alive || has_token(value, "keep-alive");
+  }
+
+  fields.push_back({static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(name.size()),
+                    static_cast<std::uint32_t>(value_off), static_cast<std::uint32_t>(value.size())});
+  return true;
+}
+
+void http_parser::build(std::string_view buf, request& req) const {
+  req.method = buf.substr(method_off, method_len);
+  req.target = buf.substr(target_off, target_len);
+  auto q = req.target.find('?');
+  req.path = req.target.substr(0, q);
+  req.query = q == std::string_view::npos ? std::string_view{} : req.target.substr(q + 1);
+  req.version_minor = version_minor;
+  req.headers.clear();
+  for (const auto& f : fields) {
+    req.headers.push_back({buf.substr(f.name_off, f.name_len), buf.substr(f.value_off, f.value_len)});
+  }
+  req.body = buf.substr(header_size, content_length);
+  req.keep_alive = version_minor >= 1 ? !connection_close : connection_keep_alive;
+}
+
+}  // namespace ws
@@ -0,0 +1,59 @@
+/** @file    inbox.cpp
+ *  @time    2026/10/21 ~ 下午7:00
+ *  @author  Leon
+ *
+ *  @note    The inbox stack and its doorbell
+ *
+ */
+
+#include <webserver/inbox.h>
+#include <system_error>
+#include <cerrno>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace ws {
+
+inbox::inbox() : bell(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+  if (bell < 0) {
+    throw std::system_error{errno, std::generic_category(), "inbox eventfd"};
+  }
+}
+
+inbox::~inbox() {
+  for (message* m = top.exchange(nullptr, std::memory_order_acquire); m != nullptr;) {
+    auto* next = m->next;
+    if (m->fd >= 0) {
+      ::close(m->fd);
+    }
+    delete m;
+    m = next;
+  }
+  ::close(bell);
+}
+
+void inbox::push(message* m) {
+  auto* old = top.load(std::memory_order_relaxed);
+  do {
+    m->next = old;
+  } while (!top.compare_exchange_weak(old, m, std::memory_order_release, std::memory_order_relaxed));
+  if (old == nullptr) {  // otherwise the bell rang for an earlier message, which the loop has not taken yet
+    std::uint64_t one{1};
+    [[maybe_unused]] auto n = ::write(bell, &one, sizeof(one));
+    num_rings.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+inbox::message* inbox::take() {
+  message* m = top.exchange(nullptr, std::memory_order_acquire);
+  message* ordered{nullptr};
+  while (m != nullptr) {
+    auto* next = m->next;
+    m->next = ordered;
+    ordered = m;
+    m = next;
+  }
+  return ordered;
+}
+
+}  // namespace ws
@@ -1,21 +1,57 @@
-#include <event2/event.h>
 #include <fmt/core.h>
-#include <iostream>
-#include <tbb/parallel_for.h>
-#include <utils/show_type.h>
-#include <vector>
+#include <webserver/server.h>
+#include <webserver/static_files.h>
+#include <webserver/response_cache.h>
+#include <webserver/access_log.h>
+#include <utils/logger.h>
+#include <csignal>
+#include <cstdlib>
+#include <string_view>
+#include <pthread.h>
 
-int main() {
-  std::vector<int> vec(5);
-  std::cout << "Hello, World!" << std::endl;
-
-  fmt::print("Hello, {}!\n", "World");
-
-  fmt::print("WITH_TBB: {}\n", WITH_TBB);
-  SHOW_TYPE(std::vector<int>);
-  auto bbb =3;
+// Usage: webserver [port] [num_reactors] [static_root|-] [libevent|io_uring] [access_log_path]
+int main(int argc, char* argv[]) {
+  ws::server_config config{};
+  if (argc > 1) {
+    config.port = static_cast<std::uint16_t>(std::atoi(argv[1]));
+  }
+  if (argc > 2) {
+    config.num_reactors = static_cast<std::size_t>(std::atoi(argv[2]));
+  }
+  bool serve_files = argc > 3 && std::string_view{argv[3]} != "-";
+  if (argc > 4 && std::string_view{argv[4]} == "io_uring") {
+    config.backend = ws::backend::io_uring;
+  }
 
+  // block the signals before any thread starts, so only sigwait below receives them
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
 
+  ws::file_cache files{{serve_files ? argv[3] : "."}};
+  ws::response_cache responses{};
+  ws::handler on_request = [](const ws::request&, ws::response& resp) { resp.body = "Hello, World!"; };
+  if (serve_files) {
+    on_request = ws::caching_handler{responses, ws::static_files{files}};
+  }
+  config.compression.enabled = serve_files;  // static text goes out gzip/br once a worker has encoded it
+  if (argc > 5) {
+    if (!utils::logger::start({argv[5]})) {
+      fmt::print("cannot open {}\n", argv[5]);
+      return 1;
+    }
+    on_request = ws::access_log{on_request};
+  }
+  ws::server srv{config, on_request};
+  srv.start();
+  fmt::print("listening on {}:{} with {} reactors\n", config.host, srv.get_port(), srv.get_num_reactors());
 
+  int sig{0};
+  sigwait(&signals, &sig);
+  fmt::print("signal {}: stopping after {} requests\n", sig, srv.get_num_requests());
+  srv.stop();
+  utils::logger::stop();
   return 0;
 }
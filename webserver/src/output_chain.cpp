@@ -0,0 +1,261 @@
+/** @file    output_chain.cpp
+ *  @time    2026/10/19 ~ 下午2:00
+ *  @author  Leon
+ *
+ *  @note    Gathered writes and partial-write bookkeeping
+ *
+ */
+
+#include <webserver/output_chain.h>
+#include <webserver/byte_ranges.h>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace ws {
+
+namespace {
+
+constexpr std::size_t MAX_IOVECS = 64;
+constexpr std::size_t WRITE_BLOCK = 16 * 1024;  // pooled buffer size for copied output
+constexpr std::size_t INLINE_BODY = 4 * 1024;  // smaller bodies are copied next to their headers
+
+// the rendered head up to the Connection header, the Date line, then the rest from the Connection header on (or a
+// "Connection: close" and the body)
+void append_prepared(output_chain& out, std::shared_ptr<const prepared_response> prepared, std::string_view date,
+                     bool keep_alive, bool head_only) {
+  const auto& p = *prepared;
+  auto end = head_only ? p.body_offset : p.bytes.size();
+  auto rest = keep_alive ? p.head_size : p.body_offset;
+  out.write(std::string_view{p.bytes}.substr(0, p.head_size));
+  out.write(date);
+  if (!keep_alive) {
+    out.write("Connection: close\r\n\r\n");
+  }
+  if (end - rest <= INLINE_BODY) {
+    out.write(std::string_view{p.bytes}.substr(rest, end - rest));
+  } else {
+    const char* bytes = p.bytes.data();
+    out.append(std::shared_ptr<const char>{std::move(prepared), bytes + rest}, end - rest);
+  }
+}
+
+}  // namespace
+
+
+void output_chain::write(std::string_view data) {
+  while (!data.empty()) {
+    if (empty() || !segments.back().buf || segments.back().size == segments.back().buf.capacity) {
+      segment s{};
+      s.buf = cache->acquire(std::max(WRITE_BLOCK, std::min(data.size(), buffer_pool::class_size(buffer_pool::NUM_CLASSES - 1))));
+      segments.push_back(std::move(s));
+    }
+    auto& tail = segments.back();
+    auto n = std::min(data.size(), tail.buf.capacity - tail.size);
+    std::memcpy(tail.buf.data + tail.size, data.data(), n);
+    tail.size += n;
+    data.remove_prefix(n);
+  }
+}
+
+void output_chain::append(std::string&& data) {
+  if (data.empty()) {
+    return;
+  }
+  segment s{};
+  s.size = data.size();
+  s.owned = std::move(data);
+  segments.push_back(std::move(s));
+}
+
+void output_chain::append(std::shared_ptr<const char> data, std::size_t size) {
+  if (size == 0) {
+    return;
+  }
+  segment s{};
+  s.size = size;
+  s.shared = std::move(data);
+  segments.push_back(std::move(s));
+}
+
+void output_chain::append_file(std::shared_ptr<const open_file> file, off_t offset, off_t length) {
+  if (length <= 0) {
+    return;
+  }
+  segment s{};
+  s.file = std::move(file);
+  s.offset = offset;
+  s.end = offset + length;
+  segments.push_back(std::move(s));
+}
+
+void output_chain::pop_front() {
+  auto& s = segments[head++];
+  cache->release(s.buf);
+  s.owned = std::string{};
+  s.shared.reset();
+  s.file.reset();
+  if (head == segments.size()) {  // drained: reuse the list from the start
+    segments.clear();
+    head = 0;
+  }
+}
+
+void output_chain::pop_finished() {
+  while (!empty() && segments[head].file != nullptr && segments[head].offset == segments[head].end) {
+    pop_front();
+  }
+}
+
+std::size_t output_chain::gather(iovec* iov, std::size_t max) const {
+  std::size_t count{0};
+  for (auto i = head; i < segments.size() && segments[i].file == nullptr && count < max; ++i) {
+    const auto& s = segments[i];
+    iov[count].iov_base = const_cast<char*>(s.data()) + s.sent;
+    iov[count].iov_len = s.size - s.sent;
+    ++count;
+  }
+  return count;
+}
+
+void output_chain::consume(std::size_t n) {
+  while (n > 0 && !empty() && segments[head].file == nullptr) {
+    auto& s = segments[head];
+    auto rest = s.size - s.sent;
+    if (n < rest) {
+      s.sent += n;
+      return;
+    }
+    n -= rest;
+    pop_front();
+  }
+  pop_finished();  // a file segment sent while the memory before it was still being accounted
+}
+
+bool output_chain::peek_file(file_range& range) const {
+  for (auto i = head; i < segments.size(); ++i) {
+    const auto& s = segments[i];
+    if (s.file != nullptr) {
+      range = {s.file->fd, s.offset, s.end - s.offset};
+      return s.offset < s.end;
+    }
+  }
+  return false;
+}
+
+void output_chain::advance_file(std::size_t n) {
+  for (auto i = head; i < segments.size(); ++i) {
+    auto& s = segments[i];
+    if (s.file != nullptr) {
+      s.offset += static_cast<off_t>(n);
+      break;
+    }
+  }
+  pop_finished();
+}
+
+void output_chain::clear() {
+  while (!empty()) {
+    pop_front();
+  }
+  segments = std::pmr::vector<segment>{segments.get_allocator()};
+}
+
+std::size_t output_chain::get_pending() const {
+  std::size_t n{0};
+  for (auto i = head; i < segments.size(); ++i) {
+    const auto& s = segments[i];
+    n += s.file != nullptr ? static_cast<std::size_t>(s.end - s.offset) : s.size - s.sent;
+  }
+  return n;
+}
+
+void output_chain::set_cork(int fd, bool on) {
+  if (corked != on) {
+    int value = on ? 1 : 0;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+    corked = on;
+  }
+}
+
+output_chain::flush_result output_chain::flush(int fd) {
+  bool has_file{false};
+  for (auto i = head; i < segments.size(); ++i) {
+    has_file = has_file || segments[i].file != nullptr;
+  }
+  if (has_file && segments.size() - head > 1) {
+    set_cork(fd, true);  // uncorked when drained: with TCP_NODELAY that pushes the last partial frame at once
+  }
+
+  while (!empty()) {
+    auto& front = segments[head];
+    if (front.file != nullptr) {
+      auto n = ::sendfile(fd, front.file->fd, &front.offset, static_cast<std::size_t>(front.end - front.offset));
+      if (n > 0) {
+        if (front.offset == front.end) {
+          pop_front();
+        }
+        continue;
+      }
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return flush_result::blocked;
+      }
+      return flush_result::error;  // n == 0: the file shrank under us and the framing is broken
+    }
+
+    iovec iov[MAX_IOVECS];
+    auto count = gather(iov, MAX_IOVECS);
+    auto n = ::writev(fd, iov, static_cast<int>(count));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK ? flush_result::blocked : flush_result::error;
+    }
+    consume(static_cast<std::size_t>(n));
+  }
+  set_cork(fd, false);
+  return flush_result::done;
+}
+
+void append_response(output_chain& out, response& resp, bool head_only, header_builder& headers) {
+  if (resp.prepared != nullptr) {
+    append_prepared(out, std::move(resp.prepared), headers.get_date(), resp.keep_alive, head_only);
+    return;
+  }
+  out.write(headers.build(resp));
+  if (head_only) {
+    return;
+  }
+  if (resp.shared_body != nullptr) {
+    const auto& body = *resp.shared_body;
+    if (body.size() <= INLINE_BODY) {
+      out.write(body);
+    } else {
+      out.append(std::shared_ptr<const char>{std::move(resp.shared_body), body.data()}, body.size());
+    }
+  } else if (resp.file != nullptr && resp.ranges.size() > 1) {
+    for (const auto& r : resp.ranges) {
+      out.write(part_head(*resp.file, r));
+      out.append_file(resp.file, r.first, r.length());
+    }
+    out.write(multipart_tail());
+  } else if (resp.file != nullptr) {
+    auto range = resp.ranges.empty() ? byte_range{0, resp.file->size - 1} : resp.ranges.front();
+    out.append_file(std::move(resp.file), range.first, range.length());
+  } else if (resp.body.size() <= INLINE_BODY) {
+    out.write(resp.body);  // cheaper to copy than to spend an iovec on
+  } else {
+    out.append(std::move(resp.body));
+  }
+}
+
+}  // namespace ws
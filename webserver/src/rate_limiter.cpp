@@ -0,0 +1,190 @@
+/** @file    rate_limiter.cpp
+ *  @time    2026/10/22 ~ 下午3:00
+ *  @author  Leon
+ *
+ *  @note    Token buckets: lookup, lazy refill, sweeping
+ *
+ */
+
+#include <webserver/rate_limiter.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <mutex>
+#include <time.h>
+
+namespace ws {
+
+namespace {
+
+std::uint64_t mix(std::uint64_t x) {  // the splitmix64 finalizer
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+std::uint64_t hash_ip(const net::ip_address& ip) {
+  std::uint64_t lo;
+  std::uint64_t hi;
+  std::memcpy(&hi, ip.data(), 8);
+  std::memcpy(&lo, ip.data() + 8, 8);
+  return mix(lo ^ mix(hi));
+}
+
+std::size_t round_up_pow2(std::size_t n) {
+  std::size_t p{1};
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+
+}  // namespace
+
+
+rate_limiter::rate_limiter(rate_limit_config cfg) : config(std::move(cfg)) {
+  auto num_shards = round_up_pow2(std::max<std::size_t>(1, config.num_shards));
+  max_per_shard = std::max<std::size_t>(1, config.max_buckets / num_shards);
+  auto capacity = round_up_pow2(2 * max_per_shard);  // at most half full: probes stay short
+  mask = capacity - 1;
+  for (std::size_t i = 0; i < num_shards; ++i) {
+    shards.push_back(std::make_unique<shard>());
+    shards.back()->slots.assign(capacity, bucket{{}, EMPTY, 0, 0});
+  }
+}
+
+std::uint64_t rate_limiter::now_ms() {
+  timespec ts{};
+  ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+  return static_cast<std::uint64_t>(ts.tv_sec) * 1000 + static_cast<std::uint64_t>(ts.tv_nsec) / 1000000;
+}
+
+const rate_limit& rate_limiter::limit_of(std::uint32_t limit) const {
+  return limit == 0 ? config.per_client : config.routes[limit - 1].limit;
+}
+
+std::size_t rate_limiter::home(const net::ip_address& ip, std::uint32_t limit) const {
+  return mix(hash_ip(ip) + limit) & mask;
+}
+
+void rate_limiter::refill(bucket& b, std::uint64_t now) const {
+  if (now <= b.stamp) {
+    return;
+  }
+  const auto& l = limit_of(b.limit);
+  b.tokens = static_cast<float>(std::min(l.burst, b.tokens + static_cast<double>(now - b.stamp) * l.rate / 1000));
+  b.stamp = now;
+}
+
+rate_limiter::bucket* rate_limiter::find(shard& s, const net::ip_address& ip, std::uint32_t limit,
+                                         std::uint64_t now) {
+  for (auto pos = home(ip, limit);; pos = (pos + 1) & mask) {
+    auto& b = s.slots[pos];
+    if (b.limit == EMPTY) {
+      if (s.size >= max_per_shard) {
+        return nullptr;
+      }
+      ++s.size;
+      b = bucket{ip, limit, static_cast<float>(limit_of(limit).burst), now};
+      return &b;
+    }
+    if (b.limit == limit && b.ip == ip) {
+      refill(b, now);
+      return &b;
+    }
+  }
+}
+
+std::uint32_t rate_limiter::admit(const net::ip_address& ip, std::string_view path) {
+  std::uint32_t route{0};
+  for (std::size_t i = 0; i < config.routes.size(); ++i) {
+    if (path.substr(0, config.routes[i].prefix.size()) == config.routes[i].prefix) {
+      route = static_cast<std::uint32_t>(i + 1);
+      break;
+    }
+  }
+  bool per_client = config.per_client.rate > 0;
+  bool per_route = route != 0 && config.routes[route - 1].limit.rate > 0;
+  if (!per_client && !per_route) {
+    return 0;
+  }
+
+  auto now = now_ms();
+  auto& s = *shards[(hash_ip(ip) >> 32) & (shards.size() - 1)];  // the high bits: the low ones pick the slot
+  std::lock_guard<tp::atomic_spinlock> lck{s.lock};
+  bucket* client = per_client ? find(s, ip, 0, now) : nullptr;
+  bucket* on_route = per_route ? find(s, ip, route, now) : nullptr;  // no rehash: `client` stays where it is
+  double wait{0};
+  for (auto* b : {client, on_route}) {
+    if (b != nullptr && b->tokens < 1) {
+      wait = std::max(wait, (1 - b->tokens) / limit_of(b->limit).rate);
+    }
+  }
+  if (wait > 0) {
+    num_limited.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<std::uint32_t>(std::ceil(wait));
+  }
+  for (auto* b : {client, on_route}) {
+    if (b != nullptr) {
+      b->tokens -= 1;
+    }
+  }
+  return 0;
+}
+
+void rate_limiter::erase(shard& s, std::size_t pos) const {
+  // shift back the entries behind the hole that may live there, so lookups need no tombstones
+  auto hole = pos;
+  for (auto next = (pos + 1) & mask; s.slots[next].limit != EMPTY; next = (next + 1) & mask) {
+    auto want = home(s.slots[next].ip, s.slots[next].limit);
+    if (((next - want) & mask) >= ((next - hole) & mask)) {  // its home is not between the hole and it
+      s.slots[hole] = s.slots[next];
+      hole = next;
+    }
+  }
+  s.slots[hole].limit = EMPTY;
+  --s.size;
+}
+
+std::size_t rate_limiter::sweep() {
+  auto& s = *shards[next_sweep.fetch_add(1, std::memory_order_relaxed) & (shards.size() - 1)];
+  auto now = now_ms();
+  std::size_t dropped{0};
+  std::lock_guard<tp::atomic_spinlock> lck{s.lock};
+  for (std::size_t pos = 0; pos <= mask && s.size > 0;) {
+    auto& b = s.slots[pos];
+    if (b.limit != EMPTY) {
+      refill(b, now);
+      if (b.tokens >= static_cast<float>(limit_of(b.limit).burst)) {
+        erase(s, pos);  // something may have moved into `pos`: look again
+        ++dropped;
+        continue;
+      }
+    }
+    ++pos;
+  }
+  return dropped;
+}
+
+std::size_t rate_limiter::get_num_buckets() const {
+  std::size_t n{0};
+  for (const auto& s : shards) {
+    std::lock_guard<tp::atomic_spinlock> lck{s->lock};
+    n += s->size;
+  }
+  return n;
+}
+
+response too_many_requests(std::uint32_t retry_after) {
+  response resp{};
+  resp.status = 429;
+  resp.keep_alive = false;
+  resp.headers.emplace_back("Retry-After", std::to_string(retry_after));
+  resp.body = std::string{status_reason(429)};
+  return resp;
+}
+
+}  // namespace ws
@@ -0,0 +1,179 @@
+/** @file    reactor.cpp
+ *  @time    2026/10/18 ~ 下午10:50
+ *  @author  Leon
+ *
+ *  @note    Event loop thread: accepts, dispatches connection events, stops on its eventfd
+ *
+ */
+
+#include <webserver/reactor.h>
+#include <webserver/socket.h>
+#include <system_error>
+#include <ctime>
+#include <cerrno>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ws {
+
+namespace {
+
+constexpr int MAX_ACCEPTS_PER_WAKEUP = 64;  // leave room for the established connections under a connect storm
+constexpr std::chrono::milliseconds WHEEL_TICK{100};  // timeout resolution
+constexpr std::size_t WHEEL_SLOTS = 512;
+
+}  // namespace
+
+
+reactor::reactor(std::size_t idx, int lfd, const handler& h, buffer_pool& pool, const connection_timeouts& t,
+                 compressor* c, handler_pool* w, rate_limiter* l)
+    : index(idx),
+      on_request(h),
+      listen_fd(lfd),
+      compression(c),
+      workers(w),
+      limiter(l),
+      timeouts(t),
+      wheel(WHEEL_TICK, WHEEL_SLOTS),
+      cache(pool) {
+  // the loop is only ever touched by its own thread: no locking inside libevent
+  auto* cfg = ::event_config_new();
+  ::event_config_set_flag(cfg, EVENT_BASE_FLAG_NOLOCK);
+  base = ::event_base_new_with_config(cfg);
+  ::event_config_free(cfg);
+  wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (base == nullptr || wake_fd < 0) {
+    auto err = errno;
+    if (base != nullptr) {
+      ::event_base_free(base);
+    }
+    if (wake_fd >= 0) {
+      ::close(wake_fd);
+    }
+    if (listen_fd >= 0) {
+      ::close(listen_fd);
+    }
+    errno = err;
+    throw std::system_error{errno, std::generic_category(), "reactor init"};
+  }
+  if (listen_fd >= 0) {
+    accept_ev = ::event_new(base, listen_fd, EV_READ | EV_PERSIST, &reactor::on_accept, this);
+    ::event_add(accept_ev, nullptr);
+  }
+  wake_ev = ::event_new(base, wake_fd, EV_READ | EV_PERSIST, &reactor::on_wake, this);
+  tick_ev = ::event_new(base, -1, EV_PERSIST, &reactor::on_tick, this);
+  inbox_ev = ::event_new(base, mailbox.get_fd(), EV_READ | EV_PERSIST, &reactor::on_inbox, this);
+  ::event_add(wake_ev, nullptr);
+  ::event_add(inbox_ev, nullptr);
+  timeval tv{0, static_cast<suseconds_t>(std::chrono::microseconds(WHEEL_TICK).count())};
+  ::event_add(tick_ev, &tv);
+}
+
+reactor::~reactor() {
+  stop();
+  join();
+  connections.clear();
+  if (accept_ev != nullptr) {
+    ::event_free(accept_ev);
+    ::close(listen_fd);
+  }
+  ::event_free(wake_ev);
+  ::event_free(tick_ev);
+  ::event_free(inbox_ev);
+  ::event_base_free(base);
+  ::close(wake_fd);
+}
+
+void reactor::start() {
+  thread = std::thread{[this]() { ::event_base_dispatch(base); }};
+}
+
+void reactor::stop() {
+  std::uint64_t one{1};
+  [[maybe_unused]] auto n = ::write(wake_fd, &one, sizeof(one));
+}
+
+void reactor::join() {
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void reactor::post(std::function<void()> fn) { mailbox.post(std::move(fn)); }
+
+void reactor::adopt(int fd) { mailbox.post_fd(fd); }
+
+bool reactor::offload(connection& c, const request& req, response& resp) {
+  auto resume = [this, fd = c.get_fd(), id = c.get_id()](response& r) {
+    if (auto it = connections.find(fd); it != connections.end() && it->second->get_id() == id) {
+      it->second->resume(r);  // unless the connection closed meanwhile
+    }
+  };
+  if (resp.deferred) {
+    if (workers != nullptr) {
+      workers->run(*this, req, std::move(resp), resume);
+      return false;
+    }
+    handler_pool::finish(req, resp, compression);
+    return true;
+  }
+  auto e = compression == nullptr ? encoding::identity : compression->prepare(req, resp);
+  if (e == encoding::identity) {
+    return true;
+  }
+  compression->encode_async(std::move(resp), e, [this, resume](response&& r) {
+    post([resume, r = std::move(r)]() mutable { resume(r); });
+  });
+  return false;
+}
+
+void reactor::close_connection(int fd) {
+  if (connections.erase(fd) != 0) {
+    num_connections.store(connections.size(), std::memory_order_relaxed);
+  }
+}
+
+void reactor::add_connection(int fd) {
+  auto peer = limiter != nullptr ? net::peer_address(fd) : net::ip_address{};
+  auto [it, inserted] = connections.emplace(fd, std::make_unique<connection>(*this, fd, next_connection_id++, peer));
+  it->second->start();
+}
+
+void reactor::on_accept(evutil_socket_t, short, void* arg) {
+  auto* self = static_cast<reactor*>(arg);
+  for (int i = 0; i < MAX_ACCEPTS_PER_WAKEUP; ++i) {
+    int fd = ::accept4(self->listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      break;  // EAGAIN, or a transient error (EMFILE, ECONNABORTED ...): the listener stays armed
+    }
+    net::set_nodelay(fd, true);
+    self->add_connection(fd);
+  }
+  self->num_connections.store(self->connections.size(), std::memory_order_relaxed);
+}
+
+void reactor::on_wake(evutil_socket_t fd, short, void* arg) {
+  std::uint64_t value;
+  [[maybe_unused]] auto n = ::read(fd, &value, sizeof(value));
+  ::event_base_loopbreak(static_cast<reactor*>(arg)->base);
+}
+
+void reactor::on_tick(evutil_socket_t, short, void* arg) {
+  auto* self = static_cast<reactor*>(arg);
+  self->wheel.advance();
+  self->headers.update_date(std::time(nullptr));
+  if (self->limiter != nullptr) {
+    self->limiter->sweep();
+  }
+}
+
+void reactor::on_inbox(evutil_socket_t fd, short, void* arg) {
+  auto* self = static_cast<reactor*>(arg);
+  std::uint64_t value;
+  [[maybe_unused]] auto n = ::read(fd, &value, sizeof(value));  // first: a push after it rings again
+  self->mailbox.run([self](int sock) { self->add_connection(sock); });
+  self->num_connections.store(self->connections.size(), std::memory_order_relaxed);
+}
+
+}  // namespace ws
@@ -0,0 +1,269 @@
+/** @file    response_cache.cpp
+ *  @time    2026/10/19 ~ 下午10:30
+ *  @author  Leon
+ *
+ *  @note    Rendering, CLOCK eviction and conditional requests
+ *
+ */
+
+#include <webserver/response_cache.h>
+#include <webserver/file_cache.h>
+#include <webserver/compression.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+
+namespace ws {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+std::string_view opaque_tag(std::string_view etag) {
+  return etag.substr(0, 2) == "W/" ? etag.substr(2) : etag;
+}
+
+std::uint64_t fnv1a(std::string_view data) {
+  std::uint64_t h{14695981039346656037ULL};
+  for (auto c : data) {
+    h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+  }
+  return h;
+}
+
+const std::string* find_header(const response& resp, std::string_view name) {
+  for (const auto& [n, value] : resp.headers) {
+    if (iequals(n, name)) {
+      return &value;
+    }
+  }
+  return nullptr;
+}
+
+bool is_cacheable(const response& resp) {
+  if (resp.status != 200 || resp.prepared != nullptr || resp.deferred != nullptr ||
+      find_header(resp, "Set-Cookie") != nullptr) {
+    return false;
+  }
+  const auto* control = find_header(resp, "Cache-Control");
+  return control == nullptr || (control->find("no-store") == std::string::npos && control->find("private") == std::string::npos);
+}
+
+}  // namespace
+
+
+response_cache::response_cache(response_cache_config cfg) : config(cfg) {
+  if (config.num_shards == 0) {
+    config.num_shards = 1;
+  }
+  max_per_shard = std::max<std::size_t>(1, config.max_bytes / config.num_shards);
+  for (std::size_t i = 0; i < config.num_shards; ++i) {
+    shards.push_back(std::make_unique<shard>());
+  }
+}
+
+response_cache::shard& response_cache::shard_of(std::string_view key) {
+  return *shards[std::hash<std::string_view>{}(key) % shards.size()];
+}
+
+std::shared_ptr<const cached_response> response_cache::lookup(std::string_view key) {
+  auto& s = shard_of(key);
+  std::shared_lock<tp::brw_spinlock<16>> lck{s.lock};
+  auto it = s.index.find(key);
+  if (it == s.index.end()) {
+    return nullptr;
+  }
+  auto& e = *s.ring[it->second];
+  if (std::chrono::steady_clock::now() >= e.expires_at) {
+    return nullptr;  // replaced by the insert that follows the miss
+  }
+  if (!e.referenced.load(std::memory_order_relaxed)) {  // read first: hot entries keep their cache line clean
+    e.referenced.store(true, std::memory_order_relaxed);
+  }
+  return e.value;
+}
+
+std::shared_ptr<const cached_response> response_cache::insert(std::string_view key, const response& resp) {
+  auto body_size = resp.file != nullptr ? static_cast<std::size_t>(resp.file->size) : resp.body.size();
+  if (!is_cacheable(resp) || body_size > config.max_entry) {
+    return nullptr;
+  }
+  std::string file_body{};
+  if (resp.file != nullptr && !read_all(*resp.file, file_body)) {
+    return nullptr;
+  }
+  std::string_view body = resp.file != nullptr ? std::string_view{file_body} : std::string_view{resp.body};
+
+  auto value = std::make_shared<cached_response>();
+  std::string head{};
+  resp.serialize_head(head);
+  head.erase(head.rfind("Connection: "));  // the connection adds its own
+  if (const auto* etag = find_header(resp, "ETag"); etag != nullptr) {
+    value->etag = *etag;
+  } else if (resp.file != nullptr) {
+    value->etag = resp.file->etag;  // rendered with the file's headers
+  } else {
+    value->etag = fmt::format("\"{:016x}\"", fnv1a(body));
+    fmt::format_to(std::back_inserter(head), "ETag: {}\r\n", value->etag);
+  }
+  auto content_type = resp.file != nullptr ? std::string_view{resp.file->content_type} : std::string_view{resp.content_type};
+  value->full.compressible = is_compressible(content_type) && find_header(resp, "Content-Encoding") == nullptr;
+  if (value->full.compressible && find_header(resp, "Vary") == nullptr) {
+    head += "Vary: Accept-Encoding\r\n";  // a compressor may answer the same URL with an encoded variant
+  }
+  value->full.assign(std::move(head), body);
+
+  auto not_modified = fmt::format("HTTP/1.1 304 Not Modified\r\nETag: {}\r\n", value->etag);
+  for (const auto& [name, v] : resp.headers) {  // the validators and caching headers a 200 would carry
+    if (iequals(name, "Cache-Control") || iequals(name, "Expires") || iequals(name, "Vary") ||
+        iequals(name, "Content-Location")) {
+      fmt::format_to(std::back_inserter(not_modified), "{}: {}\r\n", name, v);
+    }
+  }
+  if (value->full.compressible && find_header(resp, "Vary") == nullptr) {
+    not_modified += "Vary: Accept-Encoding\r\n";
+  }
+  value->not_modified.assign(std::move(not_modified), {});
+
+  auto e = std::make_unique<entry>();
+  e->key = std::string{key};
+  e->value = value;
+  e->expires_at = std::chrono::steady_clock::now() + config.max_age;
+  e->charge = sizeof(entry) + sizeof(cached_response) + e->key.size() + value->etag.size() + value->full.bytes.size() +
+              value->not_modified.bytes.size();
+  if (e->charge > max_per_shard) {
+    return value;  // served this once, never stored
+  }
+
+  auto& s = shard_of(key);
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<tp::brw_spinlock<16>> lck{s.lock};
+  if (auto it = s.index.find(key); it != s.index.end()) {
+    remove_at(s, it->second);
+  }
+  while (s.bytes + e->charge > max_per_shard) {
+    if (s.hand >= s.ring.size()) {
+      s.hand = 0;
+    }
+    auto& victim = *s.ring[s.hand];
+    if (victim.expires_at > now && victim.referenced.exchange(false, std::memory_order_relaxed)) {
+      ++s.hand;  // a second chance
+      continue;
+    }
+    remove_at(s, s.hand);  // the last entry moves here and is looked at next
+  }
+  s.bytes += e->charge;
+  s.ring.push_back(std::move(e));
+  s.index.emplace(s.ring.back()->key, s.ring.size() - 1);
+  return value;
+}
+
+void response_cache::remove_at(shard& s, std::size_t pos) {
+  s.bytes -= s.ring[pos]->charge;
+  s.index.erase(s.ring[pos]->key);
+  if (pos + 1 != s.ring.size()) {
+    s.ring[pos] = std::move(s.ring.back());
+    s.index.find(s.ring[pos]->key)->second = pos;
+  }
+  s.ring.pop_back();
+}
+
+void response_cache::erase(std::string_view key) {
+  auto& s = shard_of(key);
+  std::lock_guard<tp::brw_spinlock<16>> lck{s.lock};
+  if (auto it = s.index.find(key); it != s.index.end()) {
+    remove_at(s, it->second);
+  }
+}
+
+void response_cache::clear() {
+  for (auto& s : shards) {
+    std::lock_guard<tp::brw_spinlock<16>> lck{s->lock};
+    s->index.clear();
+    s->ring.clear();
+    s->hand = 0;
+    s->bytes = 0;
+  }
+}
+
+std::size_t response_cache::get_num_entries() const {
+  std::size_t n{0};
+  for (const auto& s : shards) {
+    std::shared_lock<tp::brw_spinlock<16>> lck{s->lock};
+    n += s->ring.size();
+  }
+  return n;
+}
+
+std::size_t response_cache::get_bytes() const {
+  std::size_t n{0};
+  for (const auto& s : shards) {
+    std::shared_lock<tp::brw_spinlock<16>> lck{s->lock};
+    n += s->bytes;
+  }
+  return n;
+}
+
+void caching_handler::operator()(const request& req, response& resp) const {
+  if ((req.method != "GET" && req.method != "HEAD") || !req.get_header("Authorization").empty() ||
+      !req.get_header("Range").empty()) {
+    inner(req, resp);
+    return;
+  }
+  auto hit = cache->lookup(req.target);
+  if (hit == nullptr) {
+    inner(req, resp);
+    if (resp.deferred != nullptr) {  // the body is made on a worker: cached once it is
+      resp.deferred = [c = cache, job = std::move(resp.deferred)](const request& copy, response& out) {
+        job(copy, out);
+        insert_and_answer(*c, copy, out);
+      };
+      return;
+    }
+    insert_and_answer(*cache, req, resp);
+    return;
+  }
+  answer(req, resp, hit);
+}
+
+void caching_handler::insert_and_answer(response_cache& c, const request& req, response& resp) {
+  if (auto hit = c.insert(req.target, resp); hit != nullptr) {
+    resp.body = std::string{};
+    resp.file.reset();
+    answer(req, resp, hit);
+  }
+}
+
+void caching_handler::answer(const request& req, response& resp, const std::shared_ptr<const cached_response>& hit) {
+  auto condition = req.get_header("If-None-Match");
+  bool not_modified = !condition.empty() && etag_matches(condition, hit->etag);
+  resp.status = not_modified ? 304 : 200;
+  resp.prepared = std::shared_ptr<const prepared_response>{hit, not_modified ? &hit->not_modified : &hit->full};
+}
+
+bool etag_matches(std::string_view list, std::string_view etag) {
+  if (trim(list) == "*") {
+    return true;
+  }
+  etag = opaque_tag(etag);
+  while (!list.empty()) {
+    auto comma = list.find(',');
+    auto tag = trim(list.substr(0, comma));
+    if (opaque_tag(tag) == etag) {
+      return true;
+    }
+    list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+  }
+  return false;
+}
+
+}  // namespace ws
@@ -0,0 +1,231 @@
+/** @file    router.cpp
+ *  @time    2026/10/20 ~ 下午3:00
+ *  @author  Leon
+ *
+ *  @note    Radix tree insertion (with node splits) and backtracking lookup
+ *
+ */
+
+#include <webserver/router.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ws {
+
+std::string_view route_params::get(std::string_view name) const {
+  for (std::size_t i = 0; i < count; ++i) {
+    if ((*names)[i] == name) {
+      return values[i];
+    }
+  }
+  return {};
+}
+
+void router::add(std::string_view method, std::string_view pattern, route_handler h, run_on where) {
+  auto invalid = [&](std::string_view why) {
+    return std::invalid_argument{fmt::format("route {} {}: {}", method, pattern, why)};
+  };
+  if (pattern.empty() || pattern[0] != '/') {
+    throw invalid("the pattern must start with '/'");
+  }
+  route r{std::string{method}, std::string{pattern}, {}, std::move(h), where};
+  std::uint32_t n{0};
+  std::size_t pos{0};
+  while (pos < pattern.size()) {
+    // static text up to the next segment starting with ':' or '*'
+    auto end = pos;
+    while (end < pattern.size() && !((pattern[end] == ':' || pattern[end] == '*') && pattern[end - 1] == '/')) {
+      ++end;
+    }
+    if (end > pos) {
+      n = insert_static(n, pattern.substr(pos, end - pos));
+      pos = end;
+      continue;
+    }
+    bool wildcard = pattern[pos] == '*';
+    auto name = pattern.substr(pos + 1, pattern.find('/', pos) - pos - 1);
+    pos += 1 + name.size();
+    if (name.empty() || name.find_first_of(":*") != std::string_view::npos) {
+      throw invalid("a capture needs a plain name");
+    }
+    if (wildcard && pos < pattern.size()) {
+      throw invalid("a wildcard must be the last segment");
+    }
+    if (std::find(r.names.begin(), r.names.end(), name) != r.names.end()) {
+      throw invalid("a capture name is repeated");
+    }
+    if (r.names.size() == route_params::MAX_PARAMS) {
+      throw invalid("too many captures");
+    }
+    r.names.emplace_back(name);
+    auto& child = wildcard ? nodes[n].wildcard : nodes[n].param;
+    if (child == NONE) {
+      child = static_cast<std::uint32_t>(nodes.size());
+      nodes.emplace_back();  // `child` is not used past this point: the emplace may move it
+    }
+    n = wildcard ? nodes[n].wildcard : nodes[n].param;
+  }
+  for (const auto& [m, i] : nodes[n].endpoints) {
+    if (m == r.method) {
+      throw invalid(fmt::format("already routed as {}", routes[i].pattern));
+    }
+  }
+  nodes[n].endpoints.emplace_back(r.method, static_cast<std::uint32_t>(routes.size()));
+  routes.push_back(std::move(r));
+}
+
+std::uint32_t router::insert_static(std::uint32_t n, std::string_view text) {
+  while (!text.empty()) {
+    auto i = nodes[n].indices.find(text[0]);
+    if (i == std::string::npos) {
+      auto leaf = static_cast<std::uint32_t>(nodes.size());
+      nodes.emplace_back().prefix = std::string{text};
+      nodes[n].indices += text[0];
+      nodes[n].children.push_back(leaf);
+      return leaf;
+    }
+    auto c = nodes[n].children[i];
+    const auto& prefix = nodes[c].prefix;
+    std::size_t common{0};
+    while (common < prefix.size() && common < text.size() && prefix[common] == text[common]) {
+      ++common;
+    }
+    if (common < prefix.size()) {  // split: a new node holds the shared part, the old one keeps its tail
+      auto mid = static_cast<std::uint32_t>(nodes.size());
+      nodes.emplace_back().prefix = nodes[c].prefix.substr(0, common);
+      nodes[c].prefix.erase(0, common);
+      nodes[mid].indices = std::string(1, nodes[c].prefix[0]);
+      nodes[mid].children = {c};
+      nodes[n].children[i] = mid;
+      c = mid;
+    }
+    text.remove_prefix(common);
+    n = c;
+  }
+  return n;
+}
+
+std::uint32_t router::find(std::uint32_t n, std::string_view method, std::string_view path,
+                           route_params& params) const {
+  // through nodes without captures there is nothing to come back to: descend in a loop
+  while (!path.empty() && nodes[n].param == NONE && nodes[n].wildcard == NONE) {
+    const auto& nd = nodes[n];
+    const auto* at = static_cast<const char*>(std::memchr(nd.indices.data(), path[0], nd.indices.size()));
+    if (at == nullptr) {
+      return NONE;
+    }
+    auto c = nd.children[static_cast<std::size_t>(at - nd.indices.data())];
+    const auto& prefix = nodes[c].prefix;
+    if (path.size() < prefix.size() || std::memcmp(path.data(), prefix.data(), prefix.size()) != 0) {
+      return NONE;
+    }
+    path.remove_prefix(prefix.size());
+    n = c;
+  }
+  const auto& nd = nodes[n];
+  if (path.empty() && route_of(nd, method) != nullptr) {  // else another method's: a capture below may still have this one
+    return n;
+  }
+  if (!path.empty()) {
+    if (auto i = nd.indices.find(path[0]); i != std::string::npos) {
+      auto c = nd.children[i];
+      const auto& prefix = nodes[c].prefix;
+      if (path.size() >= prefix.size() && path.compare(0, prefix.size(), prefix) == 0) {
+        if (auto found = find(c, method, path.substr(prefix.size()), params); found != NONE) {
+          return found;
+        }
+      }
+    }
+    if (nd.param != NONE && path[0] != '/') {
+      auto segment = path.substr(0, path.find('/'));
+      params.values[params.count++] = segment;
+      if (auto found = find(nd.param, method, path.substr(segment.size()), params); found != NONE) {
+        return found;
+      }
+      --params.count;  // backtrack
+    }
+  }
+  if (nd.wildcard != NONE && route_of(nodes[nd.wildcard], method) != nullptr) {
+    params.values[params.count++] = path;
+    return nd.wildcard;
+  }
+  return NONE;
+}
+
+const router::route* router::route_of(const node& nd, std::string_view method) const {
+  const route* get{nullptr};
+  for (const auto& [m, r] : nd.endpoints) {
+    if (m == method) {
+      return &routes[r];
+    }
+    if (m == "GET") {
+      get = &routes[r];
+    }
+  }
+  return method == "HEAD" ? get : nullptr;
+}
+
+const router::route* router::match_route(std::string_view method, std::string_view path, route_params& params) const {
+  params.count = 0;
+  auto n = find(0, method, path, params);
+  const route* r = n == NONE ? nullptr : route_of(nodes[n], method);
+  if (r != nullptr) {
+    params.names = &r->names;
+  }
+  return r;
+}
+
+const route_handler* router::match(std::string_view method, std::string_view path, route_params& params) const {
+  const auto* r = match_route(method, path, params);
+  return r == nullptr ? nullptr : &r->handler;
+}
+
+void router::operator()(const request& req, response& resp) const {
+  route_params params{};
+  if (const auto* r = match_route(req.method, req.path, params); r != nullptr) {
+    if (r->where == run_on::reactor) {
+      r->handler(req, params, resp);
+      return;
+    }
+    // the captures view this request's buffer, which a worker outlives: it matches again on its copy
+    resp.deferred = [this](const request& copy, response& out) {
+      route_params p{};
+      if (const auto* h = match(copy.method, copy.path, p); h != nullptr) {
+        (*h)(copy, p, out);
+      }
+    };
+    return;
+  }
+  // Allow lists every method some pattern takes the path with: they may be on different nodes ("/files/index" for
+  // GET beside "/files/:name" for DELETE)
+  std::vector<std::string_view> tried{};
+  std::string allow{};
+  bool has_get{false};
+  bool has_head{false};
+  for (const auto& rt : routes) {
+    if (std::find(tried.begin(), tried.end(), rt.method) != tried.end()) {
+      continue;
+    }
+    tried.emplace_back(rt.method);
+    params.count = 0;
+    if (find(0, rt.method, req.path, params) != NONE) {
+      fmt::format_to(std::back_inserter(allow), "{}{}", allow.empty() ? "" : ", ", rt.method);
+      has_get = has_get || rt.method == "GET";
+      has_head = has_head || rt.method == "HEAD";
+    }
+  }
+  if (allow.empty()) {
+    resp.status = 404;
+  } else {
+    if (has_get && !has_head) {
+      allow += ", HEAD";
+    }
+    resp.status = 405;
+    resp.headers.emplace_back("Allow", std::move(allow));
+  }
+  resp.body = std::string{status_reason(resp.status)};
+}
+
+}  // namespace ws
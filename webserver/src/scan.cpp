@@ -0,0 +1,121 @@
+/** @file    scan.cpp
+ *  @time    2026/10/19 ~ 上午9:10
+ *  @author  Leon
+ *
+ *  @note    The SIMD kernels are compiled with target attributes, so the binary still runs on CPUs without them
+ *
+ */
+
+#include <webserver/scan.h>
+#include <initializer_list>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WS_SCAN_X86 1
+#endif
+
+namespace ws::scan {
+
+namespace {
+
+using find_fn = const char* (*)(const char*, const char*, char, char);
+
+const char* find_scalar(const char* p, const char* end, char a, char b) {
+  for (; p < end; ++p) {
+    if (*p == a || *p == b) {
+      return p;
+    }
+  }
+  return end;
+}
+
+#ifdef WS_SCAN_X86
+__attribute__((target("sse4.2"))) const char* find_sse42(const char* p, const char* end, char a, char b) {
+  const __m128i needles = _mm_setr_epi8(a, b, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  for (; end - p >= 16; p += 16) {
+    auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    int idx = _mm_cmpestri(needles, 2, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+    if (idx != 16) {
+      return p + idx;
+    }
+  }
+  return find_scalar(p, end, a, b);
+}
+
+__attribute__((target("avx2"))) const char* find_avx2(const char* p, const char* end, char a, char b) {
+  const __m256i va = _mm256_set1_epi8(a);
+  const __m256i vb = _mm256_set1_epi8(b);
+  for (; end - p >= 32; p += 32) {
+    auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    auto hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb));
+    auto mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  return find_sse42(p, end, a, b);  // AVX2 CPUs all have SSE4.2
+}
+#endif
+
+bool supported(isa level) {
+#ifdef WS_SCAN_X86
+  switch (level) {
+    case isa::avx2: return __builtin_cpu_supports("avx2");
+    case isa::sse42: return __builtin_cpu_supports("sse4.2");
+    default: return true;
+  }
+#else
+  return level == isa::scalar;
+#endif
+}
+
+find_fn implementation(isa level) {
+  switch (level) {
+#ifdef WS_SCAN_X86
+    case isa::avx2: return &find_avx2;
+    case isa::sse42: return &find_sse42;
+#endif
+    default: return &find_scalar;
+  }
+}
+
+struct dispatch {
+  isa level{best_isa()};
+  find_fn find{implementation(level)};
+};
+
+dispatch& get_dispatch() {
+  static dispatch d;
+  return d;
+}
+
+}  // namespace
+
+
+isa best_isa() {
+  for (auto level : {isa::avx2, isa::sse42}) {
+    if (supported(level)) {
+      return level;
+    }
+  }
+  return isa::scalar;
+}
+
+void use_isa(isa level) {
+  auto& d = get_dispatch();
+  d.level = supported(level) ? level : best_isa();
+  d.find = implementation(d.level);
+}
+
+isa current_isa() { return get_dispatch().level; }
+
+const char* isa_name(isa level) {
+  switch (level) {
+    case isa::avx2: return "avx2";
+    case isa::sse42: return "sse4.2";
+    default: return "scalar";
+  }
+}
+
+const char* find_either(const char* p, const char* end, char a, char b) { return get_dispatch().find(p, end, a, b); }
+
+}  // namespace ws::scan
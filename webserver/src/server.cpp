@@ -0,0 +1,129 @@
+/** @file    server.cpp
+ *  @time    2026/10/18 ~ 下午11:00
+ *  @author  Leon
+ *
+ *  @note    Starting and stopping the reactors
+ *
+ */
+
+#include <webserver/server.h>
+#include <webserver/socket.h>
+#ifdef WITH_IO_URING
+#include <webserver/uring_reactor.h>
+#endif
+#include <system_error>
+#include <cerrno>
+#include <unistd.h>
+
+namespace ws {
+
+server::server(server_config cfg, handler h) : config(std::move(cfg)), on_request(std::move(h)) {
+  if (config.num_reactors == 0) {
+    config.num_reactors = 1;
+  }
+}
+
+server::~server() { stop(); }
+
+void server::start() {
+  if (config.compression.enabled && encoder == nullptr) {
+    encoder = std::make_unique<compressor>(config.compression);
+  }
+  if (config.handler_threads > 0 && workers == nullptr) {
+    workers = std::make_unique<handler_pool>(config.handler_threads, encoder.get());
+  }
+  const auto& limits = config.rate_limits;
+  if ((limits.per_client.rate > 0 || !limits.routes.empty()) && limiter == nullptr) {
+    limiter = std::make_unique<rate_limiter>(limits);
+  }
+  port = config.port;
+  int shared_fd{-1};
+  if (config.single_acceptor) {
+    shared_fd = net::listen_tcp(config.host, port, config.backlog, false);
+    port = net::local_port(shared_fd);
+    std::vector<io_loop*> loops{};
+    try {
+      for (std::size_t i = 0; i < config.num_reactors; ++i) {
+        reactors.push_back(make_reactor(i, -1));
+        loops.push_back(reactors.back().get());
+      }
+    } catch (...) {
+      ::close(shared_fd);
+      reactors.clear();
+      throw;
+    }
+    accept_loop = std::make_unique<acceptor>(shared_fd, std::move(loops));
+    for (auto& r : reactors) {
+      r->start();
+    }
+    accept_loop->start();
+    return;
+  }
+  for (std::size_t i = 0; i < config.num_reactors; ++i) {
+    int fd = net::listen_tcp(config.host, port, config.backlog, true);
+    port = net::local_port(fd);  // with port 0 the first listener picks it, the others join its group
+    reactors.push_back(make_reactor(i, fd));
+  }
+  for (auto& r : reactors) {
+    r->start();
+  }
+}
+
+std::unique_ptr<io_loop> server::make_reactor(std::size_t index, int listen_fd) {
+  if (config.backend == backend::io_uring) {
+#ifdef WITH_IO_URING
+    return std::make_unique<uring_reactor>(index, listen_fd, on_request, pool, config.timeouts, encoder.get(),
+                                           workers.get(), limiter.get());
+#else
+    if (listen_fd >= 0) {
+      ::close(listen_fd);
+    }
+    throw std::system_error{ENOTSUP, std::generic_category(), "built without io_uring"};
+#endif
+  }
+  return std::make_unique<reactor>(index, listen_fd, on_request, pool, config.timeouts, encoder.get(), workers.get(),
+                                   limiter.get());
+}
+
+void server::stop() {
+  accept_loop.reset();  // nothing is handed to a stopped reactor (what was is closed with it)
+  for (auto& r : reactors) {
+    r->stop();
+  }
+  for (auto& r : reactors) {
+    r->join();
+  }
+  if (workers != nullptr) {
+    workers->wait();  // what is still running posts into the (stopped) reactors, which must outlive it
+  }
+  if (encoder != nullptr) {
+    encoder->wait();  // the same for encodings, some of which the handler workers started
+  }
+  reactors.clear();  // closes the connections
+}
+
+std::size_t server::get_num_requests() const {
+  std::size_t n{0};
+  for (const auto& r : reactors) {
+    n += r->get_num_requests();
+  }
+  return n;
+}
+
+std::size_t server::get_num_connections() const {
+  std::size_t n{0};
+  for (const auto& r : reactors) {
+    n += r->get_num_connections();
+  }
+  return n;
+}
+
+std::size_t server::get_buffer_bytes_in_use() const {
+  std::size_t n{0};
+  for (const auto& r : reactors) {
+    n += r->get_buffer_bytes_in_use();
+  }
+  return n;
+}
+
+}  // namespace ws
@@ -0,0 +1,78 @@
+/** @file    socket.cpp
+ *  @time    2026/10/18 ~ 下午10:30
+ *  @author  Leon
+ *
+ *  @note    Socket helpers
+ *
+ */
+
+#include <webserver/socket.h>
+#include <system_error>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ws::net {
+
+int listen_tcp(const std::string& host, std::uint16_t port, int backlog, bool reuse_port) {
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+    throw std::system_error{EINVAL, std::generic_category(), "invalid listen address " + host};
+  }
+
+  int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    throw std::system_error{errno, std::generic_category(), "socket"};
+  }
+  int one{1};
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  if (reuse_port && ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::system_error{err, std::generic_category(), "SO_REUSEPORT"};
+  }
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, backlog) != 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::system_error{err, std::generic_category(), "bind/listen on port " + std::to_string(port)};
+  }
+  return fd;
+}
+
+std::uint16_t local_port(int fd) {
+  sockaddr_in addr{};
+  socklen_t len = sizeof(addr);
+  if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    throw std::system_error{errno, std::generic_category(), "getsockname"};
+  }
+  return ntohs(addr.sin_port);
+}
+
+void set_nodelay(int fd, bool on) {
+  int value = on ? 1 : 0;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
+
+ip_address peer_address(int fd) {
+  ip_address ip{};
+  sockaddr_storage addr{};
+  socklen_t len = sizeof(addr);
+  if (::getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    return ip;
+  }
+  if (addr.ss_family == AF_INET) {
+    ip[10] = ip[11] = 0xff;
+    std::memcpy(ip.data() + 12, &reinterpret_cast<const sockaddr_in&>(addr).sin_addr, 4);
+  } else if (addr.ss_family == AF_INET6) {
+    std::memcpy(ip.data(), &reinterpret_cast<const sockaddr_in6&>(addr).sin6_addr, 16);
+  }
+  return ip;
+}
+
+}  // namespace ws::net
@@ -0,0 +1,53 @@
+/** @file    static_files.cpp
+ *  @time    2026/10/19 ~ 上午11:40
+ *  @author  Leon
+ *
+ *  @note    Static file handler
+ *
+ */
+
+#include <webserver/static_files.h>
+#include <webserver/byte_ranges.h>
+#include <fmt/format.h>
+
+namespace ws {
+
+bool static_files::serve(const request& req, response& resp) const {
+  if (req.method != "GET" && req.method != "HEAD") {
+    return false;
+  }
+  auto file = cache->lookup(req.path);
+  if (file == nullptr) {
+    return false;
+  }
+  resp.status = 200;
+  auto range = req.get_header("Range");
+  auto condition = req.get_header("If-Range");
+  if (req.method == "GET" && !range.empty() && (condition.empty() || if_range_matches(condition, *file)) &&
+      parse_ranges(range, file->size, resp.ranges)) {
+    if (resp.ranges.empty()) {
+      resp.status = 416;
+      resp.headers.emplace_back("Content-Range", fmt::format("bytes */{}", file->size));
+      resp.body = std::string{status_reason(416)};
+      return true;
+    }
+    resp.status = 206;
+  }
+  resp.file = std::move(file);
+  return true;
+}
+
+void static_files::operator()(const request& req, response& resp) const {
+  if (serve(req, resp)) {
+    return;
+  }
+  if (req.method != "GET" && req.method != "HEAD") {
+    resp.status = 405;
+    resp.headers.emplace_back("Allow", "GET, HEAD");
+  } else {
+    resp.status = 404;
+  }
+  resp.body = std::string{status_reason(resp.status)};
+}
+
+}  // namespace ws
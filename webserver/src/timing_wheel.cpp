@@ -0,0 +1,100 @@
+/** @file    timing_wheel.cpp
+ *  @time    2026/10/19 ~ 下午5:10
+ *  @author  Leon
+ *
+ *  @note    Slot lists and expiry of the timing wheel
+ *
+ */
+
+#include <webserver/timing_wheel.h>
+
+namespace ws {
+
+timing_wheel::timing_wheel(std::chrono::milliseconds tick_length, std::size_t num_slots, clock::time_point start)
+    : tick(tick_length.count() > 0 ? tick_length : std::chrono::milliseconds(1)),
+      slots(num_slots > 0 ? num_slots : 1),
+      origin(start) {
+  for (auto& head : slots) {
+    head.prev = head.next = &head;
+  }
+}
+
+timing_wheel::~timing_wheel() {
+  for (auto& head : slots) {
+    while (head.next != &head) {
+      unlink(*head.next);
+    }
+  }
+}
+
+void timing_wheel::link(wheel_timer& head, wheel_timer& t) {
+  t.prev = head.prev;
+  t.next = &head;
+  head.prev->next = &t;
+  head.prev = &t;
+}
+
+void timing_wheel::unlink(wheel_timer& t) {
+  t.prev->next = t.next;
+  t.next->prev = t.prev;
+  t.prev = t.next = nullptr;
+}
+
+void timing_wheel::schedule(wheel_timer& t, std::chrono::milliseconds timeout) {
+  auto ticks = timeout.count() > 0 ? static_cast<std::uint64_t>((timeout.count() + tick.count() - 1) / tick.count()) : 1;
+  auto deadline = current + ticks;
+  if (t.is_armed()) {
+    if (deadline >= t.deadline) {
+      t.deadline = deadline;  // later: found on the way, in its old slot
+      return;
+    }
+    unlink(t);  // earlier: the old slot would come round too late
+    --num_armed;
+  }
+  t.deadline = deadline;
+  link(slots[deadline % slots.size()], t);
+  ++num_armed;
+}
+
+void timing_wheel::cancel(wheel_timer& t) {
+  if (t.is_armed()) {
+    unlink(t);
+    --num_armed;
+  }
+}
+
+std::size_t timing_wheel::advance(clock::time_point now) {
+  if (now < origin) {
+    return 0;
+  }
+  auto target = static_cast<std::uint64_t>((now - origin) / tick);
+  std::size_t fired{0};
+  while (current < target) {
+    ++current;
+    auto& head = slots[current % slots.size()];
+    if (head.next == &head) {
+      continue;
+    }
+    // detach the slot, so timers re-linked into it (a deadline one revolution later) wait for the next round
+    wheel_timer due{};
+    due.next = head.next;
+    due.prev = head.prev;
+    due.next->prev = due.prev->next = &due;
+    head.prev = head.next = &head;
+
+    while (due.next != &due) {
+      auto& t = *due.next;
+      unlink(t);
+      if (t.deadline > current) {
+        link(slots[t.deadline % slots.size()], t);  // pushed back, or a later revolution
+        continue;
+      }
+      --num_armed;
+      ++fired;
+      t.fn(t.arg);  // may destroy the owner of `t`, or cancel timers still in `due`
+    }
+  }
+  return fired;
+}
+
+}  // namespace ws
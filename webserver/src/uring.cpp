@@ -0,0 +1,223 @@
+/** @file    uring.cpp
+ *  @time    2026/10/19 ~ 下午7:10
+ *  @author  Leon
+ *
+ *  @note    Ring setup, submission and registration with io_uring_setup/enter/register(2)
+ *
+ */
+
+#include <webserver/uring.h>
+#include <algorithm>
+#include <system_error>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ws {
+
+namespace {
+
+int sys_setup(unsigned entries, io_uring_params* p) { return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p)); }
+
+int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+}  // namespace
+
+
+uring::uring(unsigned entries, unsigned cq_entries) {
+  io_uring_params p{};
+  p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER |
+            IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_R_DISABLED;
+  p.cq_entries = cq_entries != 0 ? cq_entries : 4 * entries;
+  ring_fd = sys_setup(entries, &p);
+  disabled = ring_fd >= 0;
+  if (ring_fd < 0 && errno == EINVAL) {  // an older kernel: only the flags every version since 5.5 knows
+    auto cq = p.cq_entries;
+    p = io_uring_params{};
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = cq;
+    ring_fd = sys_setup(entries, &p);
+  }
+  if (ring_fd < 0) {
+    throw std::system_error{errno, std::generic_category(), "io_uring_setup"};
+  }
+
+  sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+  }
+  sq_map = ::mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_map == MAP_FAILED) {
+    auto err = errno;
+    ::close(ring_fd);
+    throw std::system_error{err, std::generic_category(), "io_uring mmap"};
+  }
+  cq_map = sq_map;
+  if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+    cq_map = ::mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+  }
+  sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+  auto* sqe_map = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (cq_map == MAP_FAILED || sqe_map == MAP_FAILED) {
+    auto err = errno;
+    ::munmap(sq_map, sq_map_size);
+    if (cq_map != MAP_FAILED && cq_map != sq_map) {
+      ::munmap(cq_map, cq_map_size);
+    }
+    if (sqe_map != MAP_FAILED) {
+      ::munmap(sqe_map, sqes_size);
+    }
+    ::close(ring_fd);
+    throw std::system_error{err, std::generic_category(), "io_uring mmap"};
+  }
+
+  auto* sq = static_cast<char*>(sq_map);
+  sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+  sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+  sq_mask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+  sq_entries = p.sq_entries;
+  sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+  sqes = static_cast<io_uring_sqe*>(sqe_map);
+  for (unsigned i = 0; i < sq_entries; ++i) {
+    sq_array[i] = i;  // SQE slots are used in ring order, so the indirection is the identity
+  }
+  sq_local_tail = *sq_tail;
+
+  auto* cq = static_cast<char*>(cq_map);
+  cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+  cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+  cq_mask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+  cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+}
+
+uring::~uring() {
+  ::munmap(sqes, sqes_size);
+  if (cq_map != sq_map) {
+    ::munmap(cq_map, cq_map_size);
+  }
+  ::munmap(sq_map, sq_map_size);
+  ::close(ring_fd);
+}
+
+unsigned uring::flush_sq() {
+  auto pending = sq_local_tail - *sq_tail;
+  __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+  return pending;
+}
+
+io_uring_sqe* uring::get_sqe() {
+  if (sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == sq_entries) {
+    submit_and_wait(0);
+  }
+  auto* sqe = &sqes[sq_local_tail & sq_mask];
+  ++sq_local_tail;
+  std::memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+unsigned uring::submit_and_wait(unsigned wait_nr) {
+  auto to_submit = flush_sq();
+  if (to_submit == 0 && wait_nr == 0) {
+    return 0;
+  }
+  while (true) {
+    ++num_enters;
+    auto n = sys_enter(ring_fd, to_submit, wait_nr, wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0);
+    if (n >= 0) {
+      return static_cast<unsigned>(n);
+    }
+    if (errno == EINTR) {
+      to_submit = 0;  // consumed before the wait was interrupted
+      continue;
+    }
+    if (errno == EBUSY || errno == EAGAIN) {
+      return 0;  // completions must be reaped first; the SQEs stay queued
+    }
+    throw std::system_error{errno, std::generic_category(), "io_uring_enter"};
+  }
+}
+
+void uring::register_files_sparse(unsigned n) {
+  io_uring_rsrc_register reg{};
+  reg.nr = n;
+  reg.flags = IORING_RSRC_REGISTER_SPARSE;
+  if (sys_register(ring_fd, IORING_REGISTER_FILES2, &reg, sizeof(reg)) < 0) {
+    throw std::system_error{errno, std::generic_category(), "io_uring register files"};
+  }
+}
+
+void uring::register_buf_ring(io_uring_buf_ring* ring, unsigned entries, std::uint16_t group) {
+  io_uring_buf_reg reg{};
+  reg.ring_addr = reinterpret_cast<std::uint64_t>(ring);
+  reg.ring_entries = entries;
+  reg.bgid = group;
+  if (sys_register(ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    throw std::system_error{errno, std::generic_category(), "io_uring register buffer ring"};
+  }
+}
+
+void uring::unregister_buf_ring(std::uint16_t group) {
+  io_uring_buf_reg reg{};
+  reg.bgid = group;
+  sys_register(ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+}
+
+void uring::enable() {
+  if (disabled && sys_register(ring_fd, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) < 0) {
+    throw std::system_error{errno, std::generic_category(), "io_uring enable"};
+  }
+  disabled = false;
+}
+
+provided_buffers::provided_buffers(uring& r, std::uint16_t group_id, unsigned n, std::size_t buffer_size)
+    : owner(r), count(n), size(buffer_size), group(group_id) {
+  ring_size = count * sizeof(io_uring_buf);
+  auto* mem = ::mmap(nullptr, ring_size + count * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    throw std::system_error{errno, std::generic_category(), "provided buffers mmap"};
+  }
+  ring = static_cast<io_uring_buf_ring*>(mem);  // page aligned, as the kernel requires
+  base = static_cast<char*>(mem) + ring_size;
+  try {
+    owner.register_buf_ring(ring, count, group);
+  } catch (...) {
+    ::munmap(mem, ring_size + count * size);
+    throw;
+  }
+  for (unsigned id = 0; id < count; ++id) {
+    give_back(id);
+  }
+  publish();
+}
+
+provided_buffers::~provided_buffers() {
+  owner.unregister_buf_ring(group);
+  ::munmap(ring, ring_size + count * size);
+}
+
+void provided_buffers::give_back(unsigned id) {
+  // not ring->bufs: compiled as C++, the header's flexible array member does not start at offset 0 as the kernel's does
+  auto& buf = reinterpret_cast<io_uring_buf*>(ring)[tail & (count - 1)];
+  buf.addr = reinterpret_cast<std::uint64_t>(get(id));
+  buf.len = static_cast<std::uint32_t>(size);
+  buf.bid = static_cast<std::uint16_t>(id);
+  ++tail;
+}
+
+void provided_buffers::publish() {
+  if (published != tail) {
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    published = tail;
+  }
+}
+
+}  // namespace ws
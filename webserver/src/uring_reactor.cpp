@@ -0,0 +1,788 @@
+/** @file    uring_reactor.cpp
+ *  @time    2026/10/19 ~ 下午7:40
+ *  @author  Leon
+ *
+ *  @note    Completion loop of the io_uring backend: accept, receive, parse, answer, send, close
+ *
+ */
+
+#include <webserver/uring_reactor.h>
+#include <webserver/arena.h>
+#include <webserver/http_parser.h>
+#include <webserver/output_chain.h>
+#include <algorithm>
+#include <system_error>
+#include <ctime>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ws {
+
+namespace {
+
+constexpr unsigned RING_ENTRIES = 1024;
+constexpr unsigned NUM_RECV_BUFFERS = 512;  // shared by all connections of the loop
+constexpr std::size_t RECV_BUFFER_SIZE = 16 * 1024;
+constexpr std::uint16_t RECV_GROUP = 0;
+constexpr unsigned MAX_FILES = 65536;  // registered file slots, capped by RLIMIT_NOFILE
+constexpr std::size_t MAX_IOVECS = 64;
+constexpr int PIPE_SIZE = 1024 * 1024;  // asked for; the pipe may end up smaller
+constexpr std::size_t MAX_BUFFERED = 256 * 1024;  // input held while a send is in flight; receiving pauses beyond
+constexpr std::size_t READ_CHUNK = 16 * 1024;
+// output queued beyond which no more pipelined requests are answered, until it drained below the low mark
+constexpr std::size_t HIGH_WATERMARK = 256 * 1024;
+constexpr std::size_t LOW_WATERMARK = 64 * 1024;
+constexpr std::chrono::milliseconds WHEEL_TICK{100};
+constexpr std::size_t WHEEL_SLOTS = 512;
+
+// what a completion is for: the low bits of its user_data, next to the connection pointer (or null)
+enum op : std::uint64_t {
+  op_accept, op_tick, op_wake, op_inbox, op_adopt, op_recv, op_send, op_fill, op_drain, op_cancel, op_close
+};
+constexpr std::uint64_t OP_MASK = 15;
+
+constexpr std::uint64_t NO_OFFSET = ~std::uint64_t{0};
+
+std::uint64_t tag(const void* p, op o) { return reinterpret_cast<std::uint64_t>(p) | o; }
+
+unsigned file_table_size() {
+  rlimit lim{};
+  if (::getrlimit(RLIMIT_NOFILE, &lim) != 0 || lim.rlim_cur == RLIM_INFINITY) {
+    return MAX_FILES;
+  }
+  return static_cast<unsigned>(std::min<rlim_t>(lim.rlim_cur, MAX_FILES));
+}
+
+}  // namespace
+
+
+struct alignas(OP_MASK + 1) uring_reactor::conn {
+  enum class wait : std::uint8_t { idle, header, write };
+
+  uring_reactor& owner;
+  unsigned slot;  // registered file index of the socket
+  std::uint64_t id;  // tells it from a later connection in the same slot
+  net::ip_address peer;
+  arena mem;
+  pooled_buffer in{};  // a partial request (and what arrived behind it while sending)
+  std::size_t in_len{0};
+  output_chain out;
+  http_parser parser;
+  request req;
+  wheel_timer timer;
+  wait waiting{wait::idle};
+  unsigned ops{0};    // SQEs in flight naming this connection
+  unsigned sends{0};  // of which: the send chain
+  bool recv_armed{false};
+  bool recv_paused{false};
+  bool closing{false};  // close once the output is sent
+  bool offloaded{false};  // a worker is finishing the next response: answering paused
+  bool admitted{false};  // the request in front passed the rate limiter
+  bool dying{false};    // cancelling what is in flight, then closing the slot
+  bool cancel_pending{false};
+  bool close_sent{false};
+  int pipe_r{-1};
+  int pipe_w{-1};
+  std::size_t pipe_chunk{0};
+  std::int64_t in_pipe{0};  // file bytes spliced into the pipe, not yet out of it
+  msghdr msg{};
+  iovec iov[MAX_IOVECS]{};
+
+  conn(uring_reactor& r, unsigned s, std::uint64_t i, const net::ip_address& p)
+      : owner(r),
+        slot(s),
+        id(i),
+        peer(p),
+        mem(r.cache),
+        out(r.cache, &mem),
+        parser(parser_limits{}, &mem),
+        req(&mem),
+        timer(&uring_reactor::on_timeout, this) {}
+
+  ~conn() {
+    owner.wheel.cancel(timer);
+    owner.cache.release(in);
+    if (pipe_r >= 0) {
+      ::close(pipe_r);
+      ::close(pipe_w);
+    }
+  }
+};
+
+
+uring_reactor::uring_reactor(std::size_t idx, int lfd, const handler& h, buffer_pool& pool, const connection_timeouts& t,
+                             compressor* c, handler_pool* w, rate_limiter* l)
+try : index(idx),
+      on_request(h),
+      listen_fd(lfd),
+      compression(c),
+      workers(w),
+      limiter(l),
+      timeouts(t),
+      ring(RING_ENTRIES),
+      buffers(ring, RECV_GROUP, NUM_RECV_BUFFERS, RECV_BUFFER_SIZE),
+      wheel(WHEEL_TICK, WHEEL_SLOTS),
+      cache(pool) {
+  ring.register_files_sparse(file_table_size());
+  wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd < 0) {
+    throw std::system_error{errno, std::generic_category(), "uring_reactor init"};
+  }
+  tick.tv_nsec = std::chrono::nanoseconds(WHEEL_TICK).count();
+} catch (...) {
+  if (lfd >= 0) {
+    ::close(lfd);  // the members are gone already; rethrown implicitly
+  }
+}
+
+uring_reactor::~uring_reactor() {
+  stop();
+  join();
+  connections.clear();
+  for (const auto& p : to_adopt) {
+    ::close(p.fd);
+  }
+  if (listen_fd >= 0) {
+    ::close(listen_fd);
+  }
+  ::close(wake_fd);
+}
+
+void uring_reactor::start() {
+  thread = std::thread{[this]() { run(); }};
+}
+
+void uring_reactor::stop() {
+  std::uint64_t one{1};
+  [[maybe_unused]] auto n = ::write(wake_fd, &one, sizeof(one));
+}
+
+void uring_reactor::join() {
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void uring_reactor::post(std::function<void()> fn) { mailbox.post(std::move(fn)); }
+
+void uring_reactor::adopt(int fd) { mailbox.post_fd(fd); }
+
+void uring_reactor::run() {
+  ring.enable();
+  if (listen_fd >= 0) {
+    arm_accept();
+  }
+  arm_tick();
+  arm_wake();
+  arm_inbox();
+  // after a stop: until every connection is closed and nothing of ours is left in the kernel
+  while (running || !connections.empty() || accepting || tick_armed || inbox_armed || adopt_armed) {
+    ring.submit_and_wait(1);
+    ring.for_each_cqe([this](const io_uring_cqe& cqe) { on_cqe(cqe); });
+    buffers.publish();
+    num_enters.store(ring.get_num_enters(), std::memory_order_relaxed);
+  }
+}
+
+void uring_reactor::on_cqe(const io_uring_cqe& cqe) {
+  auto o = cqe.user_data & OP_MASK;
+  auto* c = reinterpret_cast<conn*>(cqe.user_data & ~OP_MASK);
+  if (c == nullptr) {
+    switch (o) {
+      case op_accept:
+        on_accept(cqe);
+        break;
+      case op_tick:
+        tick_armed = false;
+        wheel.advance();
+        headers.update_date(std::time(nullptr));
+        if (limiter != nullptr) {
+          limiter->sweep();
+        }
+        if (running) {
+          arm_tick();
+          if (!accepting && listen_fd >= 0) {
+            arm_accept();  // the listener failed (EMFILE, full file table ...): retry once per tick
+          }
+        }
+        break;
+      case op_inbox:
+        inbox_armed = false;
+        run_inbox();
+        if (running) {
+          arm_inbox();
+        }
+        break;
+      case op_adopt:
+        on_adopt(cqe);
+        break;
+      case op_wake:
+        running = false;
+        cancel(tag(nullptr, op_accept));
+        cancel(tag(nullptr, op_inbox));
+        for (auto& [slot, con] : connections) {
+          kill(*con);  // completions arrive later: nothing is erased here
+        }
+        break;
+      default:
+        break;
+    }
+    return;
+  }
+
+  if (!(cqe.flags & IORING_CQE_F_MORE)) {
+    --c->ops;  // a multishot receive stays in flight until a completion without F_MORE
+  }
+  switch (o) {
+    case op_recv:
+      on_recv(*c, cqe);
+      break;
+    case op_send:
+    case op_fill:
+    case op_drain:
+      on_sent(*c, o, cqe.res);
+      break;
+    case op_cancel:
+      c->cancel_pending = false;
+      break;
+    default:
+      break;
+  }
+  if (c->dying) {
+    reap(*c);
+  } else {
+    arm_timer(*c);
+  }
+}
+
+void uring_reactor::arm_accept() {
+  auto* sqe = ring.get_sqe();
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = listen_fd;
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  if (limiter == nullptr) {
+    sqe->file_index = IORING_FILE_INDEX_ALLOC;  // straight into the registered table
+  } else {
+    sqe->accept_flags = SOCK_CLOEXEC;  // a plain fd, for getpeername; installed through arm_adopt
+  }
+  sqe->user_data = tag(nullptr, op_accept);
+  accepting = true;
+}
+
+void uring_reactor::arm_tick() {
+  auto* sqe = ring.get_sqe();
+  sqe->opcode = IORING_OP_TIMEOUT;
+  sqe->addr = reinterpret_cast<std::uint64_t>(&tick);
+  sqe->len = 1;
+  sqe->user_data = tag(nullptr, op_tick);
+  tick_armed = true;
+}
+
+void uring_reactor::arm_wake() {
+  auto* sqe = ring.get_sqe();
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = wake_fd;
+  sqe->addr = reinterpret_cast<std::uint64_t>(&wake_value);
+  sqe->len = sizeof(wake_value);
+  sqe->off = NO_OFFSET;
+  sqe->user_data = tag(nullptr, op_wake);
+}
+
+void uring_reactor::arm_inbox() {
+  auto* sqe = ring.get_sqe();
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = mailbox.get_fd();
+  sqe->addr = reinterpret_cast<std::uint64_t>(&inbox_value);
+  sqe->len = sizeof(inbox_value);
+  sqe->off = NO_OFFSET;
+  sqe->user_data = tag(nullptr, op_inbox);
+  inbox_armed = true;
+}
+
+void uring_reactor::run_inbox() {
+  mailbox.run([this](int fd) {
+    to_adopt.push_back({fd, limiter != nullptr ? net::peer_address(fd) : net::ip_address{}});
+  });
+  if (!to_adopt.empty() && !adopt_armed) {
+    arm_adopt();
+  }
+}
+
+void uring_reactor::arm_adopt() {
+  adopting.swap(to_adopt);
+  to_adopt.clear();
+  adopt_slots.clear();
+  for (const auto& p : adopting) {
+    adopt_slots.push_back(p.fd);
+  }
+  auto* sqe = ring.get_sqe();
+  sqe->opcode = IORING_OP_FILES_UPDATE;
+  sqe->fd = -1;
+  sqe->addr = reinterpret_cast<std::uint64_t>(adopt_slots.data());
+  sqe->len = static_cast<std::uint32_t>(adopt_slots.size());
+  sqe->off = IORING_FILE_INDEX_ALLOC;  // free slots, written back over the fds
+  sqe->user_data = tag(nullptr, op_adopt);
+  adopt_armed = true;
+}
+
+void uring_reactor::on_adopt(const io_uring_cqe& cqe) {
+  adopt_armed = false;
+  auto installed = static_cast<std::size_t>(std::max(cqe.res, 0));  // the first `installed` got a slot
+  for (std::size_t i = 0; i < adopting.size(); ++i) {
+    ::close(adopting[i].fd);  // the table holds its own reference
+    if (i < installed) {
+      add_connection(static_cast<unsigned>(adopt_slots[i]), adopting[i].peer);
+    }
+  }
+  adopting.clear();
+  if (!to_adopt.empty()) {
+    if (running) {
+      arm_adopt();
+    } else {
+      for (const auto& p : to_adopt) {
+        ::close(p.fd);
+      }
+      to_adopt.clear();
+    }
+  }
+}
+
+void uring_reactor::cancel(std::uint64_t user_data) {
+  auto* sqe = ring.get_sqe();
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->addr = user_data;
+  sqe->user_data = tag(reinterpret_cast<const void*>(user_data & ~OP_MASK), op_cancel);
+}
+
+void uring_reactor::on_accept(const io_uring_cqe& cqe) {
+  if (!(cqe.flags & IORING_CQE_F_MORE)) {
+    accepting = false;
+    if (running && cqe.res >= 0) {
+      arm_accept();
+    }
+  }
+  if (cqe.res < 0) {
+    return;
+  }
+  if (limiter == nullptr) {
+    add_connection(static_cast<unsigned>(cqe.res), {});
+    return;
+  }
+  to_adopt.push_back({cqe.res, net::peer_address(cqe.res)});
+  if (!adopt_armed) {
+    arm_adopt();
+  }
+}
+
+void uring_reactor::add_connection(unsigned slot, const net::ip_address& peer) {
+  auto [it, inserted] = connections.emplace(slot, std::make_unique<conn>(*this, slot, next_connection_id++, peer));
+  auto& c = *it->second;
+  num_connections.store(connections.size(), std::memory_order_relaxed);
+  if (!running) {
+    kill(c);
+    return;
+  }
+  arm_recv(c);
+  arm_timer(c);
+}
+
+void uring_reactor::arm_recv(conn& c) {
+  auto* sqe = ring.get_sqe();
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = static_cast<int>(c.slot);
+  sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->buf_group = buffers.get_group();
+  sqe->user_data = tag(&c, op_recv);
+  ++c.ops;
+  c.recv_armed = true;
+}
+
+void uring_reactor::on_recv(conn& c, const io_uring_cqe& cqe) {
+  if (!(cqe.flags & IORING_CQE_F_MORE)) {
+    c.recv_armed = false;
+  }
+  if (cqe.flags & IORING_CQE_F_BUFFER) {
+    auto id = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+    if (cqe.res > 0 && !c.dying) {
+      receive(c, std::string_view{buffers.get(id), static_cast<std::size_t>(cqe.res)});
+    }
+    buffers.give_back(id);  // everything needed was copied or answered
+  }
+  if (c.dying) {
+    return;
+  }
+  if (cqe.res == 0 || (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -ECANCELED)) {
+    kill(c);  // EOF or error
+    return;
+  }
+  if (c.in_len > MAX_BUFFERED && (c.sends > 0 || c.offloaded) && !c.recv_paused) {
+    c.recv_paused = true;  // the client sends faster than it reads: stop taking more until the output drains
+    if (c.recv_armed) {
+      cancel(tag(&c, op_recv));
+      ++c.ops;
+    }
+  }
+  if (!c.recv_armed && !c.recv_paused && !c.closing) {
+    arm_recv(c);  // out of provided buffers, or the kernel ended the multishot
+  }
+}
+
+void uring_reactor::receive(conn& c, std::string_view data) {
+  if (c.closing) {
+    return;
+  }
+  if (c.in_len == 0 && c.sends == 0 && !c.offloaded) {
+    data.remove_prefix(answer(c, data));  // in place: whole requests are never copied
+    if (!c.closing) {
+      stash(c, data);
+    }
+  } else {
+    stash(c, data);
+    if (c.sends == 0 && !c.offloaded) {
+      answer_buffered(c);
+    }
+  }
+  if (c.sends == 0) {
+    after_send(c);
+  }
+}
+
+std::size_t uring_reactor::answer(conn& c, std::string_view buf) {
+  std::size_t offset{0};
+  while (!c.closing && !c.offloaded) {
+    auto status = c.parser.parse(buf.substr(offset), c.req);
+    if (status != parse_status::error && !admit(c, buf.substr(offset))) {
+      return buf.size();  // the body, if any, is not waited for
+    }
+    if (status == parse_status::incomplete) {
+      break;
+    }
+    if (status == parse_status::error) {
+      response resp{};
+      resp.status = c.parser.get_error_status();
+      resp.keep_alive = false;
+      resp.body = std::string{status_reason(resp.status)};
+      c.closing = true;
+      append_response(c.out, resp, false, headers);
+      return buf.size();
+    }
+
+    response resp{};
+    resp.keep_alive = c.req.keep_alive;
+    on_request(c.req, resp);
+    num_requests.store(num_requests.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (!offload(c, resp)) {
+      c.offloaded = true;  // the requests behind it wait for its response
+      offset += c.parser.get_consumed();
+      c.parser.reset();
+      c.admitted = false;
+      break;
+    }
+    c.closing = !resp.keep_alive;
+    append_response(c.out, resp, c.req.method == "HEAD", headers);
+    offset += c.parser.get_consumed();
+    c.parser.reset();
+    c.admitted = false;
+    if (c.out.get_pending() >= HIGH_WATERMARK) {
+      break;  // the rest once it drains
+    }
+  }
+  return offset;
+}
+
+bool uring_reactor::admit(conn& c, std::string_view buf) {
+  if (c.admitted || limiter == nullptr || !c.parser.has_head()) {
+    return true;
+  }
+  c.admitted = true;
+  auto target = c.parser.get_target(buf);
+  auto wait = limiter->admit(c.peer, target.substr(0, target.find('?')));
+  if (wait == 0) {
+    return true;
+  }
+  auto resp = too_many_requests(wait);
+  c.closing = true;
+  append_response(c.out, resp, false, headers);
+  return false;
+}
+
+bool uring_reactor::offload(conn& c, response& resp) {
+  auto back = [this, slot = c.slot, id = c.id](response& r) {
+    if (auto it = connections.find(slot); it != connections.end() && it->second->id == id && !it->second->dying) {
+      resume(*it->second, r);
+    }
+  };
+  if (resp.deferred) {
+    if (workers != nullptr) {
+      workers->run(*this, c.req, std::move(resp), back);
+      return false;
+    }
+    handler_pool::finish(c.req, resp, compression);
+    return true;
+  }
+  auto e = compression == nullptr ? encoding::identity : compression->prepare(c.req, resp);
+  if (e == encoding::identity) {
+    return true;
+  }
+  compression->encode_async(std::move(resp), e, [this, back](response&& r) {
+    post([back, r = std::move(r)]() mutable { back(r); });
+  });
+  return false;
+}
+
+void uring_reactor::resume(conn& c, response& resp) {
+  c.offloaded = false;
+  c.closing = !resp.keep_alive;
+  append_response(c.out, resp, false, headers);  // a worker leaves no body in a reply to HEAD
+  if (c.sends == 0) {
+    after_send(c);
+  }
+  if (!c.dying) {
+    arm_timer(c);
+  }
+}
+
+void uring_reactor::answer_buffered(conn& c) {
+  auto used = answer(c, std::string_view{c.in.data, c.in_len});
+  if (used != 0) {
+    std::memmove(c.in.data, c.in.data + used, c.in_len - used);
+    c.in_len -= used;
+  }
+}
+
+void uring_reactor::stash(conn& c, std::string_view data) {
+  if (data.empty()) {
+    return;
+  }
+  if (c.in.capacity - c.in_len < data.size()) {
+    auto bigger = cache.acquire(std::max(READ_CHUNK, 2 * (c.in_len + data.size())));
+    if (c.in_len != 0) {
+      std::memcpy(bigger.data, c.in.data, c.in_len);
+    }
+    cache.release(c.in);
+    c.in = bigger;
+  }
+  std::memcpy(c.in.data + c.in_len, data.data(), data.size());
+  c.in_len += data.size();
+}
+
+void uring_reactor::send_output(conn& c) {
+  std::size_t count{0};
+  output_chain::file_range file{};
+  bool with_file{false};
+  if (c.in_pipe == 0) {
+    count = c.out.gather(c.iov, MAX_IOVECS);
+    with_file = count < MAX_IOVECS && c.out.peek_file(file);
+  }
+  if (count > 0) {
+    c.msg = msghdr{};
+    c.msg.msg_iov = c.iov;
+    c.msg.msg_iovlen = count;
+    auto* sqe = ring.get_sqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = static_cast<int>(c.slot);
+    sqe->flags = IOSQE_FIXED_FILE | (with_file ? IOSQE_IO_LINK : 0);
+    sqe->addr = reinterpret_cast<std::uint64_t>(&c.msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = tag(&c, op_send);
+    ++c.sends;
+    ++c.ops;
+  }
+  if (with_file && c.pipe_r < 0) {
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC | O_NONBLOCK) != 0) {
+      kill(c);
+      return;
+    }
+    c.pipe_r = fds[0];
+    c.pipe_w = fds[1];
+    auto size = ::fcntl(c.pipe_w, F_SETPIPE_SZ, PIPE_SIZE);
+    c.pipe_chunk = size > 0 ? static_cast<std::size_t>(size) : 64 * 1024;
+  }
+  std::size_t chunk{0};
+  if (with_file) {
+    // file -> pipe, linked to pipe -> socket: the pair moves the bytes without a copy to user space
+    chunk = std::min(static_cast<std::size_t>(file.length), c.pipe_chunk);
+    auto* fill = ring.get_sqe();
+    fill->opcode = IORING_OP_SPLICE;
+    fill->fd = c.pipe_w;
+    fill->splice_fd_in = file.fd;
+    fill->splice_off_in = static_cast<std::uint64_t>(file.offset);
+    fill->off = NO_OFFSET;
+    fill->len = static_cast<std::uint32_t>(chunk);
+    fill->flags = IOSQE_IO_LINK;
+    fill->user_data = tag(&c, op_fill);
+    ++c.sends;
+    ++c.ops;
+  } else if (c.in_pipe > 0) {
+    chunk = static_cast<std::size_t>(c.in_pipe);  // what a short send left behind
+  }
+  if (chunk > 0) {
+    auto* drain = ring.get_sqe();
+    drain->opcode = IORING_OP_SPLICE;
+    drain->fd = static_cast<int>(c.slot);
+    drain->flags = IOSQE_FIXED_FILE;
+    drain->splice_fd_in = c.pipe_r;
+    drain->splice_off_in = NO_OFFSET;
+    drain->off = NO_OFFSET;
+    drain->len = static_cast<std::uint32_t>(chunk);
+    drain->user_data = tag(&c, op_drain);
+    ++c.sends;
+    ++c.ops;
+  }
+}
+
+void uring_reactor::on_sent(conn& c, std::uint64_t o, int res) {
+  --c.sends;
+  if (res < 0 && res != -ECANCELED) {
+    kill(c);  // the peer is gone; a link broken by a short transfer shows up as ECANCELED and is resent below
+    return;
+  }
+  if (res > 0) {
+    if (o == op_send) {
+      c.out.consume(static_cast<std::size_t>(res));
+    } else if (o == op_fill) {
+      c.out.advance_file(static_cast<std::size_t>(res));
+      c.in_pipe += res;
+    } else {
+      c.in_pipe -= res;
+    }
+  } else if (res == 0 && o == op_fill) {
+    kill(c);  // the file shrank under us: the framing is broken
+    return;
+  }
+  if (c.sends == 0 && !c.dying) {
+    after_send(c);
+  }
+}
+
+void uring_reactor::after_send(conn& c) {
+  if (!c.out.empty() || c.in_pipe > 0) {
+    if (c.in_len > 0 && !c.closing && !c.offloaded && c.out.get_pending() < LOW_WATERMARK) {
+      answer_buffered(c);  // queued behind what is still going out
+    }
+    send_output(c);
+    return;
+  }
+  if (c.closing) {
+    kill(c);
+    return;
+  }
+  if (c.offloaded) {
+    return;  // nothing more to answer until that response is back
+  }
+  if (c.in_len > 0) {
+    answer_buffered(c);  // arrived while sending
+    if (!c.out.empty()) {
+      send_output(c);
+      return;
+    }
+    if (c.closing) {
+      kill(c);
+      return;
+    }
+    if (c.offloaded) {
+      return;
+    }
+  }
+  release_idle(c);
+  if (c.recv_paused) {
+    c.recv_paused = false;
+    if (!c.recv_armed) {
+      arm_recv(c);
+    }
+  }
+}
+
+void uring_reactor::release_idle(conn& c) {
+  if (c.in_len == 0) {
+    cache.release(c.in);
+  }
+  if (c.in_len == 0 && c.out.empty() && c.sends == 0) {
+    c.out.clear();
+    c.parser.release();
+    c.req.headers = std::pmr::vector<header>{c.req.headers.get_allocator()};
+    c.mem.reset();
+  }
+}
+
+void uring_reactor::arm_timer(conn& c) {
+  if (c.sends > 0 || c.offloaded) {
+    c.waiting = conn::wait::write;
+    wheel.schedule(c.timer, timeouts.write);
+  } else if (c.in_len > 0) {
+    if (c.waiting != conn::wait::header || !c.timer.is_armed()) {
+      c.waiting = conn::wait::header;
+      wheel.schedule(c.timer, timeouts.read_header);
+    }
+  } else {
+    c.waiting = conn::wait::idle;
+    wheel.schedule(c.timer, timeouts.idle);
+  }
+}
+
+void uring_reactor::on_timeout(void* arg) {
+  auto& c = *static_cast<conn*>(arg);
+  auto& self = c.owner;
+  if (c.waiting == conn::wait::header && !c.closing && c.sends == 0) {
+    response resp{};
+    resp.status = 408;
+    resp.keep_alive = false;
+    resp.body = std::string{status_reason(408)};
+    c.closing = true;
+    append_response(c.out, resp, false, self.headers);
+    self.send_output(c);
+    if (!c.dying) {
+      self.arm_timer(c);
+    }
+    return;
+  }
+  self.kill(c);
+}
+
+void uring_reactor::kill(conn& c) {
+  if (c.dying) {
+    return;
+  }
+  c.dying = true;
+  wheel.cancel(c.timer);
+  reap(c);
+}
+
+void uring_reactor::reap(conn& c) {
+  if (c.ops > 0 && !c.cancel_pending && !c.close_sent) {
+    // everything still in flight on the socket; asked again after each completion, since a linked request is only
+    // issued once the one before it completed
+    auto* sqe = ring.get_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = static_cast<int>(c.slot);
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_FD_FIXED | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = tag(&c, op_cancel);
+    ++c.ops;
+    c.cancel_pending = true;
+    return;
+  }
+  if (c.ops > 0) {
+    return;
+  }
+  if (!c.close_sent) {
+    auto* sqe = ring.get_sqe();
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->file_index = c.slot + 1;  // frees the registered slot
+    sqe->user_data = tag(&c, op_close);
+    ++c.ops;
+    c.close_sent = true;
+    return;
+  }
+  connections.erase(c.slot);
+  num_connections.store(connections.size(), std::memory_order_relaxed);
+}
+
+}  // namespace ws